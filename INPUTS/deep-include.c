@@ -0,0 +1,22 @@
+// This pounds on #include handling: the file includes itself until it is
+// DEPTH levels deep, declaring a few entities at every level.
+
+#ifndef DEPTH
+#define DEPTH 180
+#endif
+
+#if __INCLUDE_LEVEL__ < DEPTH
+#include __FILE__
+#endif
+
+#define CAT2(a, b) a##b
+#define CAT(a, b) CAT2(a, b)
+
+struct CAT(level, __INCLUDE_LEVEL__) {
+  int CAT(field, __INCLUDE_LEVEL__);
+};
+
+static inline int CAT(get, __INCLUDE_LEVEL__)(
+    struct CAT(level, __INCLUDE_LEVEL__) *p) {
+  return p->CAT(field, __INCLUDE_LEVEL__);
+}
@@ -0,0 +1,23 @@
+// clang-perf-pch: all-std-headers.cpp
+//
+// Measures loading a precompiled header of the standard library and using a
+// handful of declarations from it.
+
+std::vector<std::string> split(const std::string &s, char sep) {
+  std::vector<std::string> result;
+  std::stringstream stream(s);
+  std::string item;
+  while (std::getline(stream, item, sep))
+    result.push_back(item);
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+std::map<std::string, int> count(const std::vector<std::string> &words) {
+  std::map<std::string, int> result;
+  for (std::vector<std::string>::const_iterator I = words.begin(),
+                                                E = words.end();
+       I != E; ++I)
+    ++result[*I];
+  return result;
+}
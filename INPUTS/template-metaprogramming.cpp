@@ -0,0 +1,65 @@
+// clang-perf-args: -std=c++11
+//
+// This pounds on template instantiation: recursive class templates, variadic
+// packs, SFINAE-based overload resolution and constexpr evaluation.
+
+template <unsigned N> struct Fib {
+  static constexpr unsigned long long value =
+      Fib<N - 1>::value + Fib<N - 2>::value;
+};
+template <> struct Fib<0> { static constexpr unsigned long long value = 0; };
+template <> struct Fib<1> { static constexpr unsigned long long value = 1; };
+
+template <typename... Ts> struct TypeList {};
+
+template <unsigned N, typename... Ts> struct MakeList {
+  typedef typename MakeList<N - 1, int[N], Ts...>::type type;
+};
+template <typename... Ts> struct MakeList<0, Ts...> {
+  typedef TypeList<Ts...> type;
+};
+
+template <typename List> struct Length;
+template <typename... Ts> struct Length<TypeList<Ts...> > {
+  static const unsigned value = sizeof...(Ts);
+};
+
+template <bool B, typename T = void> struct EnableIf {};
+template <typename T> struct EnableIf<true, T> { typedef T type; };
+
+template <unsigned N>
+typename EnableIf<N % 2 == 0, unsigned>::type classify(Fib<N>) { return 0; }
+template <unsigned N>
+typename EnableIf<N % 2 == 1, unsigned>::type classify(Fib<N>) { return 1; }
+
+constexpr unsigned long long slowSum(unsigned long long N) {
+  return N == 0 ? 0 : N + slowSum(N - 1);
+}
+
+template <unsigned... Is> struct Indices {};
+template <unsigned N, unsigned... Is>
+struct BuildIndices : BuildIndices<N - 1, N - 1, Is...> {};
+template <unsigned... Is> struct BuildIndices<0, Is...> {
+  typedef Indices<Is...> type;
+};
+
+template <unsigned... Is>
+constexpr unsigned long long sumFibs(Indices<Is...>) {
+  return slowSum(sizeof...(Is)) + Fib<sizeof...(Is)>::value;
+}
+
+#define INSTANTIATE(N)                                                         \
+  static_assert(Length<MakeList<N>::type>::value == N, "");                    \
+  unsigned classify##N() { return classify(Fib<N>()); }                        \
+  unsigned long long sum##N() {                                                \
+    return sumFibs(BuildIndices<N>::type());                                   \
+  }
+
+#define INSTANTIATE10(N)                                                       \
+  INSTANTIATE(N##0) INSTANTIATE(N##1) INSTANTIATE(N##2) INSTANTIATE(N##3)      \
+  INSTANTIATE(N##4) INSTANTIATE(N##5) INSTANTIATE(N##6) INSTANTIATE(N##7)      \
+  INSTANTIATE(N##8) INSTANTIATE(N##9)
+
+INSTANTIATE10(1) INSTANTIATE10(2) INSTANTIATE10(3) INSTANTIATE10(4)
+INSTANTIATE10(5) INSTANTIATE10(6) INSTANTIATE10(7) INSTANTIATE10(8)
+INSTANTIATE10(9)
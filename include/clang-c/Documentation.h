@@ -46,6 +46,18 @@ typedef struct {
  */
 CINDEX_LINKAGE CXComment clang_Cursor_getParsedComment(CXCursor C);
 
+/**
+ * \brief Find the documentation comments of all the declarations of the
+ * given translation unit at once.
+ *
+ * Clients that request the comments of most declarations, such as
+ * documentation generators, can call this once after parsing or reparsing
+ * the translation unit, so that the following comment queries do not have to
+ * search for the comment of each declaration separately. The results are the
+ * same either way. The declarations of an AST file are not affected.
+ */
+CINDEX_LINKAGE void clang_attachCommentsToDecls(CXTranslationUnit TU);
+
 /**
  * \brief Describes the type of the comment AST node (\c CXComment).  A comment
  * node can be considered block content (e. g., paragraph), inline content
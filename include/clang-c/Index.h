@@ -32,7 +32,7 @@
  * compatible, thus CINDEX_VERSION_MAJOR is expected to remain stable.
  */
 #define CINDEX_VERSION_MAJOR 0
-#define CINDEX_VERSION_MINOR 30
+#define CINDEX_VERSION_MINOR 32
 
 #define CINDEX_VERSION_ENCODE(major, minor) ( \
       ((major) * 10000)                       \
@@ -4205,6 +4205,89 @@ CINDEX_LINKAGE void clang_annotateTokens(CXTranslationUnit TU,
 CINDEX_LINKAGE void clang_disposeTokens(CXTranslationUnit TU,
                                         CXToken *Tokens, unsigned NumTokens);
 
+/**
+ * \brief Describes a semantic token.
+ */
+enum CXSemanticTokenFlags {
+  /**
+   * \brief The token names the entity in its declaration, rather than
+   * referring to it.
+   */
+  CXSemanticToken_Declaration = 0x1
+};
+
+/**
+ * \brief A token that names a declared entity or macro, as returned by
+ * clang_getSemanticTokens().
+ */
+typedef struct {
+  /**
+   * \brief The offset of the token in its file.
+   */
+  unsigned offset;
+
+  /**
+   * \brief The length of the token.
+   */
+  unsigned length;
+
+  /**
+   * \brief The kind of the entity named by the token, e.g.,
+   * \c CXCursor_FunctionDecl, \c CXCursor_FieldDecl or
+   * \c CXCursor_MacroDefinition.
+   */
+  enum CXCursorKind kind;
+
+  /**
+   * \brief A bitmask of \c CXSemanticTokenFlags.
+   */
+  unsigned flags;
+} CXSemanticToken;
+
+/**
+ * \brief Retrieve the tokens of the given file range that name declared
+ * entities, with the kind of those entities, for semantic highlighting.
+ *
+ * This provides the information that clients usually compute with
+ * clang_tokenize() and clang_annotateTokens(), for the tokens that matter to
+ * highlighting, much more cheaply. The first call after the translation unit
+ * is parsed or reparsed walks its declarations once to build a sorted index
+ * of these tokens for all of its files; each query then only looks up the
+ * requested range in that index.
+ *
+ * The index covers the code parsed with the translation unit, including the
+ * headers it includes, but not the headers in its precompiled preamble.
+ * Tokens that are written in the body of a macro definition are not
+ * included, since they have no single meaning.
+ *
+ * \param TU the translation unit.
+ *
+ * \param File the file whose tokens are requested.
+ *
+ * \param BeginOffset the offset in \p File of the first character of the
+ * range.
+ *
+ * \param EndOffset the offset in \p File just past the last character of
+ * the range.
+ *
+ * \param Tokens will be set to an array of the tokens that start in the
+ * range, sorted by offset, which must be freed with
+ * clang_disposeSemanticTokens().
+ *
+ * \param NumTokens will be set to the number of tokens in \c *Tokens.
+ *
+ * \returns Zero on success, otherwise returns an error code.
+ */
+CINDEX_LINKAGE enum CXErrorCode
+clang_getSemanticTokens(CXTranslationUnit TU, CXFile File,
+                        unsigned BeginOffset, unsigned EndOffset,
+                        CXSemanticToken **Tokens, unsigned *NumTokens);
+
+/**
+ * \brief Free the tokens returned by clang_getSemanticTokens().
+ */
+CINDEX_LINKAGE void clang_disposeSemanticTokens(CXSemanticToken *Tokens);
+
 /**
  * @}
  */
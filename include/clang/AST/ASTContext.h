@@ -443,6 +443,11 @@ public:
   IntrusiveRefCntPtr<ExternalASTSource> ExternalSource;
   ASTMutationListener *Listener;
 
+  /// \brief Incremented whenever a declaration is added to, removed from, or
+  /// made visible in a DeclContext, so that clients caching the results of
+  /// name lookup can cheaply detect that they may be stale.
+  unsigned DeclContextGeneration;
+
   /// \brief Contains parents of a node.
   typedef llvm::SmallVector<ast_type_traits::DynTypedNode, 2> ParentVector;
 
@@ -613,6 +618,9 @@ public:
   /// redeclaration.
   mutable llvm::DenseMap<const Decl *, comments::FullComment *> ParsedComments;
 
+  /// \brief Load the comments of the external AST source, if not done yet.
+  void loadComments() const;
+
   /// \brief Return the documentation comment attached to a given declaration,
   /// without looking into cache.
   RawComment *getRawCommentForDeclNoCache(const Decl *D) const;
@@ -637,6 +645,14 @@ public:
   getRawCommentForAnyRedecl(const Decl *D,
                             const Decl **OriginalDecl = nullptr) const;
 
+  /// \brief Find the documentation comments attached to the given
+  /// declarations, in a single pass over the comments of each of their files,
+  /// and cache them for getRawCommentForAnyRedecl() and getCommentForDecl().
+  ///
+  /// This is much faster than looking the comments up one declaration at a
+  /// time when most of the declarations of a translation unit are queried.
+  void attachCommentsToDecls(ArrayRef<const Decl *> Decls) const;
+
   /// Return parsed documentation comment attached to a given declaration.
   /// Returns NULL if no comment is attached.
   ///
@@ -2377,6 +2393,18 @@ public:
   /// \brief The number of implicitly-declared destructors for which 
   /// declarations were built.
   static unsigned NumImplicitDestructorsDeclared;
+
+  /// \brief The number of times the lookup table of a declaration context
+  /// was built by walking all of its declarations.
+  static unsigned NumLookupTableBuilds;
+
+  /// \brief The number of times the lookup table of a declaration context
+  /// was updated with only the declarations loaded from an external source.
+  static unsigned NumLookupTableUpdates;
+
+  /// \brief The number of declarations walked while building or updating
+  /// lookup tables.
+  static unsigned NumLookupTableDeclsWalked;
   
 private:
   ASTContext(const ASTContext &) = delete;
@@ -3094,6 +3094,10 @@ private:
   /// Whether this function has a trailing return type.
   unsigned HasTrailingReturn : 1;
 
+  /// The hash of the profile of this type, set by ASTContext when the type is
+  /// uniqued.
+  unsigned ProfileHash;
+
   // ParamInfo - There is an variable size array after the class in memory that
   // holds the parameter types.
 
@@ -3295,6 +3299,10 @@ public:
   static void Profile(llvm::FoldingSetNodeID &ID, QualType Result,
                       param_type_iterator ArgTys, unsigned NumArgs,
                       const ExtProtoInfo &EPI, const ASTContext &Context);
+
+  /// \brief Retrieve the hash of the profile of this type, which is only
+  /// valid once the type has been uniqued.
+  unsigned getProfileHash() const { return ProfileHash; }
 };
 
 /// \brief Represents the dependent type named by a dependently-scoped
@@ -3956,6 +3964,10 @@ class LLVM_ALIGNAS(/*alignof(uint64_t)*/ 8) TemplateSpecializationType
   /// Whether this template specialization type is a substituted type alias.
   bool TypeAlias : 1;
 
+  /// The hash of the profile of this type, set by ASTContext when the type is
+  /// uniqued.
+  unsigned ProfileHash;
+
   TemplateSpecializationType(TemplateName T,
                              const TemplateArgument *Args,
                              unsigned NumArgs, QualType Canon,
@@ -4055,6 +4067,10 @@ public:
                       unsigned NumArgs,
                       const ASTContext &Context);
 
+  /// \brief Retrieve the hash of the profile of this type, which is only
+  /// valid once the type has been uniqued.
+  unsigned getProfileHash() const { return ProfileHash; }
+
   static bool classof(const Type *T) {
     return T->getTypeClass() == TemplateSpecialization;
   }
@@ -5590,4 +5606,40 @@ inline const ArrayType *Type::castAsArrayTypeUnsafe() const {
 
 }  // end namespace clang
 
+namespace llvm {
+
+/// \brief Uniquing traits for types whose profiles are expensive to compute.
+///
+/// These types cache the hash of their profile, so that looking one of them
+/// up only profiles the types in the bucket whose hash matches, and growing
+/// the table does not profile any of them.
+template <typename T> struct CachedHashContextualFoldingSetTrait {
+  static void Profile(T &X, FoldingSetNodeID &ID, clang::ASTContext &Context) {
+    X.Profile(ID, Context);
+  }
+  static bool Equals(T &X, const FoldingSetNodeID &ID, unsigned IDHash,
+                     FoldingSetNodeID &TempID, clang::ASTContext &Context) {
+    if (X.getProfileHash() != IDHash)
+      return false;
+    X.Profile(TempID, Context);
+    return TempID == ID;
+  }
+  static unsigned ComputeHash(T &X, FoldingSetNodeID &TempID,
+                              clang::ASTContext &Context) {
+    return X.getProfileHash();
+  }
+};
+
+template <>
+struct ContextualFoldingSetTrait<clang::FunctionProtoType, clang::ASTContext &>
+    : CachedHashContextualFoldingSetTrait<clang::FunctionProtoType> {};
+
+template <>
+struct ContextualFoldingSetTrait<clang::TemplateSpecializationType,
+                                 clang::ASTContext &>
+    : CachedHashContextualFoldingSetTrait<clang::TemplateSpecializationType> {
+};
+
+}  // end namespace llvm
+
 #endif
@@ -22,6 +22,7 @@
 #include "llvm/ADT/StringRef.h"
 #include <cassert>
 #include <string>
+#include <vector>
 
 namespace llvm {
   template <typename T> struct DenseMapInfo;
@@ -419,6 +420,10 @@ class IdentifierTable {
 
   IdentifierInfoLookup* ExternalLookup;
 
+  /// \brief If non-null, the identifiers created by this table are appended
+  /// to this list, so that clients can index them incrementally.
+  std::vector<IdentifierInfo *> *CreatedIdentifiers;
+
 public:
   /// \brief Create the identifier table, populating it with info about the
   /// language keywords for the language specified by \p LangOpts.
@@ -434,6 +439,12 @@ public:
   IdentifierInfoLookup *getExternalIdentifierLookup() const {
     return ExternalLookup;
   }
+
+  /// \brief Set the list to which the identifiers created from now on are
+  /// appended, or null to stop recording them.
+  void setCreatedIdentifiersList(std::vector<IdentifierInfo *> *List) {
+    CreatedIdentifiers = List;
+  }
   
   llvm::BumpPtrAllocator& getAllocator() {
     return HashTable.getAllocator();
@@ -462,6 +473,9 @@ public:
     // contents.
     II->Entry = &Entry;
 
+    if (CreatedIdentifiers)
+      CreatedIdentifiers->push_back(II);
+
     return *II;
   }
 
@@ -497,6 +511,9 @@ public:
     if (Name.equals("import"))
       II->setModulesImport(true);
 
+    if (CreatedIdentifiers)
+      CreatedIdentifiers->push_back(II);
+
     return *II;
   }
 
@@ -0,0 +1,148 @@
+//===--- CompilationCache.h - Cache of compilation outputs ------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_FRONTEND_COMPILATIONCACHE_H
+#define LLVM_CLANG_FRONTEND_COMPILATIONCACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace llvm {
+class MD5;
+class raw_string_ostream;
+}
+
+namespace clang {
+
+class CompilerInstance;
+
+/// \brief A local, content-addressed cache of compilation outputs.
+///
+/// A compilation is identified by the compiler version, its -cc1 arguments
+/// (excluding the paths of its outputs and other paths that do not affect
+/// them), the names and contents of the files the preprocessor enters, in
+/// order, the results of the __has_include probes, and the contents of the
+/// profiles, bitcode files and sanitizer blacklists it reads. The cache
+/// stores the main output, the dependency file, the serialized diagnostics
+/// file and the rendered diagnostics of a successful compilation, and
+/// replaying an entry writes them back without parsing the input or running
+/// the backend. The diagnostics are stored and replayed without colors.
+/// Compilations that expand __DATE__, __TIME__ or __TIMESTAMP__ are not
+/// cached.
+///
+/// Computing the key requires preprocessing the input. To avoid that on a
+/// hit, the cache also keeps a manifest per set of arguments (which include
+/// the main file). Each manifest records, for the most recent compilations
+/// with those arguments, the files their preprocessed input depended on with
+/// the hashes of their contents, the paths at which __has_include found no
+/// file, and the key of their entry. If all the files of one of the records
+/// still have the same contents and none of the missing files exists, its
+/// key is used directly. Like other direct-mode caches, this assumes that
+/// adding a file to the include path does not shadow a header the
+/// compilation used.
+///
+/// Entries and manifests live in 256 subdirectories of the cache directory,
+/// named after the first byte of their key. Each subdirectory holds at most
+/// its share of the size limit; when storing an entry pushes it over, the
+/// least recently used files of that subdirectory are removed.
+class CompilationCache {
+public:
+  /// \brief The kinds of data stored in a cache entry.
+  enum OutputKind {
+    OK_MainOutput,
+    OK_DependencyFile,
+    OK_SerializedDiagnostics,
+    OK_DiagnosticText
+  };
+
+private:
+  CompilerInstance &Clang;
+
+  /// \brief A file the preprocessed input depends on.
+  struct Dependency {
+    std::string Path;
+    uint64_t Size;
+    uint8_t Digest[16];
+  };
+
+  /// \brief A record of a manifest: the dependencies of a compilation, and
+  /// the key of the entry holding its outputs.
+  struct ManifestRecord {
+    SmallString<32> Key;
+    std::vector<Dependency> Dependencies;
+  };
+
+  /// \brief The hash of the compiler version and the arguments, which names
+  /// the manifest of the compilation.
+  SmallString<32> ArgsKey;
+
+  /// \brief The key of the cache entry for this compilation.
+  SmallString<32> EntryKey;
+
+  /// \brief The path of the cache entry for this compilation.
+  SmallString<128> EntryPath;
+
+  /// \brief The dependencies to record in the manifest once the outputs are
+  /// stored, if the key was computed by preprocessing.
+  std::vector<Dependency> Dependencies;
+
+  /// \brief Whether the key was found in the manifest.
+  bool FoundInManifest;
+
+  /// \brief The diagnostics of the compilation, as rendered to the terminal.
+  std::string DiagnosticText;
+
+  /// \brief The stream capturing the diagnostics into DiagnosticText, owned
+  /// by the diagnostic consumer writing to it.
+  llvm::raw_string_ostream *DiagnosticStream;
+
+  CompilationCache(CompilerInstance &Clang)
+      : Clang(Clang), FoundInManifest(false), DiagnosticStream(nullptr) {}
+
+  void getCachePath(StringRef Key, StringRef Extension,
+                    SmallVectorImpl<char> &Path);
+  void hashArguments(ArrayRef<const char *> Argv);
+  bool computeKey();
+  bool hashInputFiles(llvm::MD5 &Hash);
+  void getReadFiles(std::vector<std::string> &Files);
+  bool lookupManifest();
+  void updateManifest();
+  void pruneDirectory(StringRef Dir);
+
+public:
+  /// \brief Set up caching for the compilation configured in \p Clang, whose
+  /// -cc1 arguments are \p Argv.
+  ///
+  /// \returns null if the compilation cannot be cached, for example because
+  /// it does not produce an object file, reads its input from stdin, or
+  /// uses modules or a precompiled header.
+  static std::unique_ptr<CompilationCache>
+  create(CompilerInstance &Clang, ArrayRef<const char *> Argv);
+
+  /// \brief If the cache has an entry for this compilation, write its
+  /// outputs and diagnostics and return true.
+  ///
+  /// Otherwise, start capturing the diagnostics of the compilation so that
+  /// its outputs can be stored once it finishes, and return false.
+  bool replay();
+
+  /// \brief Store the outputs of the compilation, which must have finished
+  /// successfully.
+  void store();
+};
+
+} // end namespace clang
+
+#endif
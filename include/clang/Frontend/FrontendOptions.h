@@ -147,6 +147,10 @@ public:
                                            ///< dumps in AST dumps.
   unsigned ASTDumpLookups : 1;             ///< Whether we include lookup table
                                            ///< dumps in AST dumps.
+  unsigned CompilationCacheDirect : 1;     ///< Whether the compilation cache
+                                           ///< may find entries through
+                                           ///< manifests without
+                                           ///< preprocessing.
 
   CodeCompleteOptions CodeCompleteOpts;
 
@@ -251,6 +255,17 @@ public:
   /// \brief File name of the file that will provide record layouts
   /// (in the format produced by -fdump-record-layouts).
   std::string OverrideRecordLayoutsFile;
+
+  /// \brief The directory used to cache the outputs of compilations, or
+  /// empty if they are not cached.
+  std::string CompilationCachePath;
+
+  /// \brief The size limit of the compilation cache, in megabytes.
+  unsigned CompilationCacheSize;
+
+  /// \brief The number of missing implicit modules that may be built
+  /// concurrently.
+  unsigned ModuleBuildJobs;
   
 public:
   FrontendOptions() :
@@ -260,8 +275,10 @@ public:
     FixToTemporaries(false), ARCMTMigrateEmitARCErrors(false),
     SkipFunctionBodies(false), UseGlobalModuleIndex(true),
     GenerateGlobalModuleIndex(true), ASTDumpDecls(false), ASTDumpLookups(false),
+    CompilationCacheDirect(true),
     ARCMTAction(ARCMT_None), ObjCMTAction(ObjCMT_None),
-    ProgramAction(frontend::ParseSyntaxOnly)
+    ProgramAction(frontend::ParseSyntaxOnly), CompilationCacheSize(5120),
+    ModuleBuildJobs(1)
   {}
 
   /// getInputKindForExtension - Return the appropriate input kind for a file
@@ -32,6 +32,7 @@ class FileEntry;
 class FileManager;
 class HeaderSearchOptions;
 class IdentifierInfo;
+class ModuleMapIndex;
 class Preprocessor;
 
 /// \brief The preprocessor keeps track of this information for each
@@ -238,6 +239,10 @@ class HeaderSearch {
   /// whether they were valid or not.
   llvm::DenseMap<const FileEntry *, bool> LoadedModuleMaps;
 
+  /// \brief The summaries of the module map files that are loaded lazily,
+  /// created on first use.
+  std::unique_ptr<ModuleMapIndex> ModMapIndex;
+
   /// \brief Uniqued set of framework names, which is used to track which 
   /// headers were included as framework headers.
   llvm::StringSet<llvm::BumpPtrAllocator> FrameworkNames;
@@ -555,6 +560,10 @@ public:
   /// \brief Load all known, top-level system modules.
   void loadTopLevelSystemModules();
 
+  /// \brief Store the summaries of the module map files that were loaded
+  /// lazily in the module cache, for use by later compilations.
+  void writeModuleMapIndex();
+
 private:
   /// \brief Retrieve a module with the given name, which may be part of the
   /// given framework.
@@ -575,6 +584,10 @@ private:
   /// of the given search directory.
   void loadSubdirectoryModuleMaps(DirectoryLookup &SearchDir);
 
+  /// \brief Retrieve the module map index, loading it from the module cache
+  /// if needed.
+  ModuleMapIndex &getModuleMapIndex();
+
   /// \brief Return the HeaderFileInfo structure for the specified FileEntry.
   const HeaderFileInfo &getFileInfo(const FileEntry *FE) const {
     return const_cast<HeaderSearch*>(this)->getFileInfo(FE);
@@ -639,9 +652,14 @@ private:
     LMM_InvalidModuleMap
   };
 
+  /// \brief Load the given module map file and its private module map file.
+  ///
+  /// \param Lazy Whether the module map file may be summarized instead of
+  /// parsed, as described in \c HeaderSearchOptions::LazyModuleMaps.
   LoadModuleMapResult loadModuleMapFileImpl(const FileEntry *File,
                                             bool IsSystem,
-                                            const DirectoryEntry *Dir);
+                                            const DirectoryEntry *Dir,
+                                            bool Lazy = false);
 
   /// \brief Try to load the module map file in the given directory.
   ///
@@ -25,6 +25,7 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include <string>
+#include <vector>
 
 namespace clang {
   
@@ -35,6 +36,7 @@ class DiagnosticConsumer;
 class DiagnosticsEngine;
 class HeaderSearch;
 class ModuleMapParser;
+struct ModuleMapSummary;
   
 class ModuleMap {
   SourceManager &SourceMgr;
@@ -177,6 +179,35 @@ private:
   /// map.
   llvm::DenseMap<const FileEntry *, bool> ParsedModuleMap;
 
+  /// \brief A module map file that is only parsed once one of the modules or
+  /// headers it describes is looked up.
+  struct LazyModuleMap {
+    const FileEntry *File;
+    const DirectoryEntry *HomeDir;
+    bool IsSystem;
+    bool Parsed;
+  };
+
+  /// \brief The module map files registered by \c addLazyModuleMapFile.
+  std::vector<LazyModuleMap> LazyModuleMaps;
+
+  /// \brief The number of lazy module map files that have not been parsed.
+  unsigned NumUnparsedLazyModuleMaps;
+
+  typedef llvm::StringMap<SmallVector<unsigned, 1> > LazyModuleMapIndexMap;
+
+  /// \brief Mapping from the names of top-level modules to the lazy module
+  /// map files that describe them.
+  LazyModuleMapIndexMap LazyModuleMapsByModule;
+
+  /// \brief Mapping from header file names (without directories) to the lazy
+  /// module map files that name them.
+  LazyModuleMapIndexMap LazyModuleMapsByHeader;
+
+  /// \brief Mapping from the (canonical) home directories of lazy module map
+  /// files with an umbrella header or umbrella directory to those files.
+  LazyModuleMapIndexMap LazyModuleMapsByDirectory;
+
   friend class ModuleMapParser;
   
   /// \brief Resolve the given export declaration into an actual export
@@ -234,6 +265,16 @@ private:
   Module *inferFrameworkModule(const DirectoryEntry *FrameworkDir,
                                Attributes Attrs, Module *Parent);
 
+  /// \brief Parse the lazy module map file with the given index, unless it
+  /// has already been parsed.
+  void loadLazyModuleMap(unsigned Idx);
+
+  /// \brief Parse the lazy module map files listed under \p Key in \p Map.
+  void loadLazyModuleMaps(const LazyModuleMapIndexMap &Map, StringRef Key);
+
+  /// \brief Parse the lazy module map files that might describe \p File.
+  void loadLazyModuleMapsForHeader(const FileEntry *File);
+
 public:
   /// \brief Construct a new module map.
   ///
@@ -459,6 +500,34 @@ public:
   bool parseModuleMapFile(const FileEntry *File, bool IsSystem,
                           const DirectoryEntry *HomeDir,
                           SourceLocation ExternModuleLoc = SourceLocation());
+
+  /// \brief Record a module map file whose parsing is deferred until one of
+  /// the modules or headers named in its summary is looked up.
+  ///
+  /// \param File The module map file.
+  ///
+  /// \param IsSystem Whether this module map file is in a system header
+  /// directory.
+  ///
+  /// \param HomeDir The directory in which relative paths within this module
+  ///        map file will be resolved.
+  ///
+  /// \param Summary The summary of the module map file.
+  void addLazyModuleMapFile(const FileEntry *File, bool IsSystem,
+                            const DirectoryEntry *HomeDir,
+                            const ModuleMapSummary &Summary);
+
+  /// \brief Parse all of the lazy module map files that have not been parsed
+  /// yet.
+  void loadAllLazyModuleMaps();
+
+  /// \brief The number of module map files recorded as lazy.
+  unsigned getNumLazyModuleMaps() const { return LazyModuleMaps.size(); }
+
+  /// \brief The number of lazy module map files that have been parsed.
+  unsigned getNumParsedLazyModuleMaps() const {
+    return LazyModuleMaps.size() - NumUnparsedLazyModuleMaps;
+  }
     
   /// \brief Dump the contents of the module map, for debugging purposes.
   void dump();
@@ -0,0 +1,132 @@
+//===--- ModuleMapIndex.h - Index of module map files -----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the ModuleMapIndex class, which summarizes module map
+// files so that they only need to be parsed once one of their modules or
+// headers is used.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_MODULEMAPINDEX_H
+#define LLVM_CLANG_LEX_MODULEMAPINDEX_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace llvm {
+class MemoryBuffer;
+}
+
+namespace clang {
+
+class FileEntry;
+class FileManager;
+
+/// \brief A summary of a module map file: the names under which the modules
+/// and headers it describes can be looked up.
+struct ModuleMapSummary {
+  ModuleMapSummary() : Size(0), ModTime(0), Eager(false),
+                       CoversDirectory(false) {}
+
+  /// \brief The size of the module map file that was summarized.
+  uint64_t Size;
+
+  /// \brief The modification time of the module map file that was summarized.
+  uint64_t ModTime;
+
+  /// \brief Whether the module map file must be parsed as soon as it is
+  /// found, because it refers to other module map files or infers
+  /// framework modules.
+  bool Eager;
+
+  /// \brief Whether the module map file has an umbrella header or umbrella
+  /// directory, and may therefore describe any header in its directory.
+  bool CoversDirectory;
+
+  /// \brief The names of the top-level modules described by the module map.
+  std::vector<std::string> ModuleNames;
+
+  /// \brief The file names (without directories) of the headers named in the
+  /// module map.
+  std::vector<std::string> HeaderNames;
+};
+
+/// \brief An index of module map summaries, which can be stored in the module
+/// cache to avoid lexing unchanged module map files in later compilations.
+///
+/// The index is an on-disk hash table keyed by the path of each module map
+/// file. An entry is only used while the module map file has the size and
+/// modification time that were recorded with it.
+class ModuleMapIndex {
+  /// \brief The buffer holding the index that was loaded, if any.
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+
+  /// \brief The on-disk hash table in \c Buffer.
+  void *Table;
+
+  /// \brief The summaries used by this compilation.
+  llvm::StringMap<ModuleMapSummary> Summaries;
+
+  /// \brief Whether some summary was computed by lexing a module map file,
+  /// so that the index should be written out.
+  bool Dirty;
+
+  /// \brief The number of summaries found in the loaded index.
+  unsigned NumIndexHits;
+
+  /// \brief The number of module map files that were lexed.
+  unsigned NumScans;
+
+  ModuleMapIndex(const ModuleMapIndex &) = delete;
+  void operator=(const ModuleMapIndex &) = delete;
+
+  bool lookupInTable(StringRef Path, ModuleMapSummary &Summary) const;
+
+public:
+  ModuleMapIndex();
+  ~ModuleMapIndex();
+
+  /// \brief The name of the index file in the module cache.
+  static const char *const IndexFileName;
+
+  /// \brief Load the index stored in the given directory, if any.
+  void load(StringRef Directory);
+
+  /// \brief Retrieve the summary of the given module map file, lexing it if
+  /// the index has no up-to-date summary of it.
+  ///
+  /// \returns null if the file could not be read.
+  const ModuleMapSummary *getSummary(const FileEntry *File,
+                                     FileManager &FileMgr);
+
+  /// \brief Whether this index has summaries that are not stored on disk.
+  bool isDirty() const { return Dirty; }
+
+  /// \brief Write the index, including the summaries computed by this
+  /// compilation, to the given directory.
+  ///
+  /// \returns true if an error occurred, false otherwise.
+  bool write(StringRef Directory);
+
+  /// \brief Compute the summary of the given module map file contents.
+  static void summarize(const llvm::MemoryBuffer &Contents,
+                        ModuleMapSummary &Summary);
+
+  /// \brief Print statistics to stderr.
+  void printStats() const;
+};
+
+} // end namespace clang
+
+#endif
@@ -260,6 +260,13 @@ public:
   virtual void Defined(const Token &MacroNameTok, const MacroDefinition &MD,
                        SourceRange Range) {
   }
+
+  /// \brief Hook called whenever a '__has_include' or '__has_include_next'
+  /// expression is evaluated.
+  /// \param File The file that was found, or null if there is none.
+  virtual void HasInclude(SourceLocation Loc, StringRef FileName,
+                          bool IsAngled, const FileEntry *File) {
+  }
   
   /// \brief Hook called when a source range is skipped.
   /// \param Range The SourceRange that was skipped. The range begins at the
@@ -458,6 +465,12 @@ public:
     Second->Defined(MacroNameTok, MD, Range);
   }
 
+  void HasInclude(SourceLocation Loc, StringRef FileName, bool IsAngled,
+                  const FileEntry *File) override {
+    First->HasInclude(Loc, FileName, IsAngled, File);
+    Second->HasInclude(Loc, FileName, IsAngled, File);
+  }
+
   void SourceRangeSkipped(SourceRange Range) override {
     First->SourceRangeSkipped(Range);
     Second->SourceRangeSkipped(Range);
@@ -572,7 +572,7 @@ class Preprocessor : public RefCountedBase<Preprocessor> {
   unsigned NumEnteredSourceFiles, MaxIncludeStackDepth;
   unsigned NumMacroExpanded, NumFnMacroExpanded, NumBuiltinMacroExpanded;
   unsigned NumFastMacroExpanded, NumTokenPaste, NumFastTokenPaste;
-  unsigned NumSkipped;
+  unsigned NumSkipped, NumBacktrackedTokens;
 
   /// \brief The predefined macros that preprocessor should use from the
   /// command line etc.
@@ -1049,6 +1049,10 @@ public:
   /// caching of tokens is on.
   bool isBacktrackEnabled() const { return !BacktrackPositions.empty(); }
 
+  /// \brief The number of tokens that Backtrack() made the preprocessor lex
+  /// again.
+  unsigned getNumBacktrackedTokens() const { return NumBacktrackedTokens; }
+
   /// \brief Lex the next token for this preprocessor.
   void Lex(Token &Result);
 
@@ -22,6 +22,7 @@
 #include "clang/Sema/DeclSpec.h"
 #include "clang/Sema/LoopHint.h"
 #include "clang/Sema/Sema.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/PrettyStackTrace.h"
@@ -224,6 +225,22 @@ class Parser : public CodeCompletionHandler {
   /// \brief Identifiers which have been declared within a tentative parse.
   SmallVector<IdentifierInfo *, 8> TentativelyDeclaredIdentifiers;
 
+  /// \brief The results of isCXXFunctionDeclarator() in the current statement
+  /// or declaration, keyed by the location of the '(' and by the value of
+  /// GreaterThanIsOperator.
+  ///
+  /// The same '(' is often disambiguated more than once: while deciding
+  /// whether the statement is a declaration, and again while parsing it. The
+  /// tentative parse treats the names it has seen declared as non-types, as
+  /// the real parse would, so the answers agree; they are only reused within
+  /// a statement, before the parser has a chance to act on later tokens.
+  llvm::DenseMap<std::pair<unsigned, unsigned>, unsigned>
+      FunctionDeclaratorResults;
+
+  // Statistics about ambiguity resolution.
+  unsigned NumDisambiguations;
+  unsigned NumFunctionDeclaratorLookups, NumFunctionDeclaratorHits;
+
   IdentifierInfo *getSEHExceptKeyword();
 
   /// True if we are within an Objective-C container while parsing C-like decls.
@@ -245,6 +262,9 @@ public:
   Sema &getActions() const { return Actions; }
   AttributeFactory &getAttrFactory() { return AttrFactory; }
 
+  /// \brief Print some statistics about ambiguity resolution.
+  void PrintStats() const;
+
   const Token &getCurToken() const { return Tok; }
   Scope *getCurScope() const { return Actions.getCurScope(); }
   void incrementMSManglingNumber() const {
@@ -1165,6 +1185,7 @@ private:
 
   void LexTemplateFunctionForLateParsing(CachedTokens &Toks);
   void ParseLateTemplatedFuncDef(LateParsedTemplate &LPT);
+  bool isDelayableHeaderFunctionBody();
 
   static void LateTemplateParserCallback(void *P, LateParsedTemplate &LPT);
   static void LateTemplateParserCleanupCallback(void *P);
@@ -65,6 +65,11 @@ namespace html {
   void AddHeaderFooterInternalBuiltinCSS(Rewriter& R, FileID FID,
                                          const char *title = nullptr);
 
+  /// EmitHeaderInternalBuiltinCSS - Write the document header, including the
+  /// builtin stylesheet, that AddHeaderFooterInternalBuiltinCSS inserts.
+  void EmitHeaderInternalBuiltinCSS(raw_ostream &os,
+                                    const char *title = nullptr);
+
   /// SyntaxHighlight - Relex the specified FileID and annotate the HTML with
   /// information about keywords, comments, etc.
   void SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP);
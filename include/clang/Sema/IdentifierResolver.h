@@ -179,6 +179,10 @@ public:
   ///
   /// \returns true if the declaration was added, false otherwise.
   bool tryAddTopLevelDecl(NamedDecl *D, DeclarationName Name);
+
+  /// \brief Retrieve a counter that changes whenever a declaration is added
+  /// to or removed from any identifier's decl chain.
+  unsigned getGeneration() const { return Generation; }
   
   explicit IdentifierResolver(Preprocessor &PP);
   ~IdentifierResolver();
@@ -186,6 +190,7 @@ public:
 private:
   const LangOptions &LangOpt;
   Preprocessor &PP;
+  unsigned Generation;
   
   class IdDeclInfoMap;
   IdDeclInfoMap *IdDeclInfos;
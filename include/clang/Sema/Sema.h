@@ -170,6 +170,7 @@ namespace clang {
   class TypedefNameDecl;
   class TypeLoc;
   class TypoCorrectionConsumer;
+  class TypoCorrectionIndex;
   class UnqualifiedId;
   class UnresolvedLookupExpr;
   class UnresolvedMemberExpr;
@@ -2678,9 +2679,75 @@ public:
   typedef std::function<ExprResult(Sema &, TypoExpr *, TypoCorrection)>
       TypoRecoveryCallback;
 
+  /// \brief Statistics about the cost of name lookup, reported by
+  /// PrintStats().
+  struct LookupStatistics {
+    /// \brief The number of C++ unqualified name lookups performed.
+    unsigned NumUnqualifiedLookups;
+    /// \brief The number of unqualified lookups answered from the cache.
+    unsigned NumUnqualifiedCacheHits;
+    /// \brief The number of times the unqualified lookup cache was flushed.
+    unsigned NumUnqualifiedCacheFlushes;
+    /// \brief The number of direct lookups into each kind of DeclContext.
+    /// This and NumContextResults are only collected if CollectStats is set.
+    unsigned NumContextLookups[Decl::lastDecl + 1];
+    /// \brief The number of declarations found by direct lookups into each
+    /// kind of DeclContext.
+    unsigned NumContextResults[Decl::lastDecl + 1];
+    /// \brief The name of each DeclContext kind that has been searched.
+    const char *ContextKindNames[Decl::lastDecl + 1];
+
+    LookupStatistics();
+    void recordContextLookup(const DeclContext *DC, unsigned NumResults);
+    void print() const;
+  };
+
+  LookupStatistics LookupStats;
+
 private:
   bool CppLookupName(LookupResult &R, Scope *S);
 
+  /// \brief A memoized result of C++ unqualified name lookup from a given
+  /// scope, together with the lookup criteria it was computed for.
+  struct CachedUnqualifiedLookup {
+    unsigned LookupKind;
+    unsigned IDNS;
+    unsigned ScopeFlags;
+    bool Redecl;
+    bool AllowHidden;
+    bool Found;
+    bool Shadowed;
+    CXXRecordDecl *NamingClass;
+    SmallVector<std::pair<NamedDecl *, AccessSpecifier>, 2> Decls;
+  };
+
+  typedef llvm::DenseMap<std::pair<Scope *, void *>,
+                         SmallVector<CachedUnqualifiedLookup, 1> >
+      UnqualifiedLookupCacheMap;
+
+  /// \brief Results of unqualified name lookup within the current function
+  /// body, keyed by the scope the lookup started in and the name.
+  ///
+  /// Only used with -fcache-unqualified-lookup. The cache is flushed when a
+  /// scope is popped, and whenever the declaration generation of the
+  /// ASTContext, the identifier resolver or the external AST source changes.
+  UnqualifiedLookupCacheMap UnqualifiedLookupCache;
+  unsigned UnqualifiedLookupCacheDeclGeneration;
+  unsigned UnqualifiedLookupCacheResolverGeneration;
+  uint32_t UnqualifiedLookupCacheExternalGeneration;
+
+  bool canCacheUnqualifiedLookup(const LookupResult &R, Scope *S) const;
+  bool validateUnqualifiedLookupCache();
+  const CachedUnqualifiedLookup *
+  findCachedUnqualifiedLookup(const LookupResult &R, Scope *S);
+  void cacheUnqualifiedLookup(const LookupResult &R, Scope *S, bool Found);
+
+public:
+  /// \brief Discard all memoized unqualified lookup results.
+  void flushUnqualifiedLookupCache();
+
+private:
+
   struct TypoExprState {
     std::unique_ptr<TypoCorrectionConsumer> Consumer;
     TypoDiagnosticGenerator DiagHandler;
@@ -6814,6 +6881,14 @@ public:
   /// \brief The number of typos corrected by CorrectTypo.
   unsigned TyposCorrected;
 
+  /// \brief The number of edit distance computations performed by typo
+  /// correction in this translation unit.
+  unsigned TypoCorrectionWork;
+
+  /// \brief The index of known identifiers used to pre-filter typo correction
+  /// candidates, built on the first unqualified typo correction.
+  std::unique_ptr<TypoCorrectionIndex> TypoIndex;
+
   typedef llvm::SmallSet<SourceLocation, 2> SrcLocSet;
   typedef llvm::DenseMap<IdentifierInfo *, SrcLocSet> IdentifierSourceLocations;
 
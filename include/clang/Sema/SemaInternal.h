@@ -99,6 +99,80 @@ inline InheritableAttr *getDLLAttr(Decl *D) {
   return nullptr;
 }
 
+/// \brief A lazily built index over every identifier known to the translation
+/// unit, used to pre-filter candidate names for typo correction.
+///
+/// Names are bucketed by length and tagged with a 64-bit signature of the
+/// characters they contain. Each signature gives a cheap lower bound on the
+/// edit distance between two names, so only the few names that could possibly
+/// be within the typo's edit-distance bound reach the (expensive) edit distance
+/// computation in TypoCorrectionConsumer.
+///
+/// The index is shared by all typo corrections in a translation unit. The
+/// local part is rebuilt only when the identifier table has grown, and the
+/// external part only when the external AST source's generation changes.
+class TypoCorrectionIndex {
+  struct Entry {
+    StringRef Name;
+    uint64_t Signature;
+  };
+  typedef std::vector<std::vector<Entry> > BucketList;
+
+  ASTContext &Context;
+
+  /// \brief Names from the identifier table, bucketed by length.
+  BucketList LocalBuckets;
+
+  /// \brief Names from the external identifier source, bucketed by length.
+  BucketList ExternalBuckets;
+
+  /// \brief Storage for external names, whose lifetime is not guaranteed by
+  /// the external source.
+  llvm::BumpPtrAllocator ExternalNameAlloc;
+
+  /// \brief The identifiers created since LocalBuckets was last updated,
+  /// recorded by the identifier table.
+  std::vector<IdentifierInfo *> NewLocalIdents;
+
+  /// \brief The external source generation when ExternalBuckets was built.
+  uint32_t IndexedExternalGeneration;
+  bool HasExternalIndex;
+
+  // Statistics.
+  unsigned NumQueries;
+  unsigned NumLocalBuilds;
+  unsigned NumLocalUpdates;
+  unsigned NumExternalBuilds;
+  unsigned NumNamesScanned;
+  unsigned NumCandidatesReturned;
+
+  static void addName(BucketList &Buckets, StringRef Name);
+  void scanBuckets(const BucketList &Buckets, StringRef Typo,
+                   SmallVectorImpl<StringRef> &Candidates);
+  void updateLocal();
+  void updateExternal();
+
+public:
+  explicit TypoCorrectionIndex(ASTContext &Context)
+      : Context(Context), IndexedExternalGeneration(0),
+        HasExternalIndex(false), NumQueries(0), NumLocalBuilds(0),
+        NumLocalUpdates(0), NumExternalBuilds(0), NumNamesScanned(0),
+        NumCandidatesReturned(0) {}
+  ~TypoCorrectionIndex();
+
+  /// \brief Compute the signature of the characters in \p Name.
+  static uint64_t getSignature(StringRef Name);
+
+  /// \brief Collect every known identifier that might be within the edit
+  /// distance bound TypoCorrectionConsumer uses for \p Typo.
+  ///
+  /// The result is a superset of the names that would survive the consumer's
+  /// own edit distance check; it may contain duplicates.
+  void findCandidates(StringRef Typo, SmallVectorImpl<StringRef> &Candidates);
+
+  void PrintStats() const;
+};
+
 class TypoCorrectionConsumer : public VisibleDeclConsumer {
   typedef SmallVector<TypoCorrection, 1> TypoResultList;
   typedef llvm::StringMap<TypoResultList> TypoResultsMap;
@@ -868,6 +868,15 @@ private:
   /// pool within a specific module and found something.
   unsigned NumMethodPoolTableHits;
 
+  /// \brief The number of times we have looked up a selector in the method
+  /// pool and no module file was loaded since its previous lookup, so that
+  /// no module file had to be searched.
+  unsigned NumMethodPoolUpToDateLookups;
+
+  /// \brief The number of methods read from the method pools of module
+  /// files.
+  unsigned NumMethodPoolMethodsRead;
+
   /// \brief The total number of method pool entries in the selector table.
   unsigned TotalNumMethodPoolEntries;
 
@@ -877,6 +886,10 @@ private:
   /// Number of visible decl contexts read/total.
   unsigned NumVisibleDeclContextsRead, TotalVisibleDeclContexts;
 
+  /// \brief Number of times the most recent declaration of a redeclaration
+  /// chain was out of date and the chain was completed.
+  unsigned NumRedeclChainsCompleted;
+
   /// Total size of modules, in bits, currently loaded
   uint64_t TotalModulesSizeInBits;
 
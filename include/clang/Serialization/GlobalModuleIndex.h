@@ -36,6 +36,7 @@ class FileEntry;
 class FileManager;
 class IdentifierIterator;
 class PCHContainerOperations;
+class Selector;
 
 namespace serialization {
   class ModuleFile;
@@ -69,6 +70,13 @@ class GlobalModuleIndex {
   /// GlobalModuleIndex.
   void *IdentifierIndex;
 
+  /// \brief The hash table mapping the hash of each selector to the module
+  /// files whose method pool has an entry for it.
+  ///
+  /// This pointer actually points to a SelectorIndexTable object, but that
+  /// type is only accessible within the implementation of GlobalModuleIndex.
+  void *SelectorIndex;
+
   /// \brief Information about a given module file.
   struct ModuleInfo {
     ModuleInfo() : File(), Size(), ModTime() { }
@@ -114,6 +122,13 @@ class GlobalModuleIndex {
   /// \brief The number of identifier lookup hits, where we recognize the
   /// identifier.
   unsigned NumIdentifierLookupHits;
+
+  /// \brief The number of selector lookups we performed.
+  unsigned NumSelectorLookups;
+
+  /// \brief The number of selector lookup hits, where some module file has
+  /// methods with the selector.
+  unsigned NumSelectorLookupHits;
   
   /// \brief Internal constructor. Use \c readIndex() to read an index.
   explicit GlobalModuleIndex(std::unique_ptr<llvm::MemoryBuffer> Buffer,
@@ -178,6 +193,20 @@ public:
   /// \returns true if the identifier is known to the index, false otherwise.
   bool lookupIdentifier(StringRef Name, HitSet &Hits);
 
+  /// \brief Look for all of the module files whose global method pool may
+  /// have methods with the given selector.
+  ///
+  /// The index only records the hash of each selector, so \p Hits may include
+  /// module files that only have methods with other selectors.
+  ///
+  /// \param Sel The selector to look for.
+  ///
+  /// \param Hits Will be populated with the set of module files that may have
+  /// methods with this selector.
+  ///
+  /// \returns true if the index has selector information, false otherwise.
+  bool lookupSelector(Selector Sel, HitSet &Hits);
+
   /// \brief Note that the given module file has been loaded.
   ///
   /// \returns false if the global module index has information about this
@@ -247,6 +247,12 @@ private:
   /// \sa StableReportFilename
   Optional<bool> StableReportFilename;
 
+  /// \sa shouldShareHTMLSourcePages
+  Optional<bool> ShareHTMLSourcePages;
+
+  /// \sa getFunctionStatsDir
+  Optional<StringRef> FunctionStatsDir;
+
   /// \sa getGraphTrimInterval
   Optional<unsigned> GraphTrimInterval;
 
@@ -463,6 +469,21 @@ public:
   /// which accepts the values "true" and "false". Default = false
   bool shouldWriteStableReportFilename();
 
+  /// Returns whether HTML reports should link to a single highlighted copy
+  /// of each source file instead of embedding the annotated file.
+  ///
+  /// This is controlled by the 'html-shared-source' config option,
+  /// which accepts the values "true" and "false". Default = false
+  bool shouldShareHTMLSourcePages();
+
+  /// Returns where per-function performance statistics (steps taken, blocks
+  /// covered, time and memory for each analyzed function) are written as
+  /// JSON. An empty value disables them; "-" writes them to stderr.
+  ///
+  /// This is controlled by the 'function-stats-dir' config option.
+  /// Default = ""
+  StringRef getFunctionStatsDir();
+
   /// Returns whether irrelevant parts of a bug report path should be pruned
   /// out of the final output.
   ///
@@ -488,9 +488,18 @@ private:
 // FIXME: Get rid of GRBugReporter.  It's the wrong abstraction.
 class GRBugReporter : public BugReporter {
   ExprEngine& Eng;
+
+  class TrimmedGraph;
+
+  /// The trimmed graph built for the most recent equivalence class, shared by
+  /// every PathDiagnosticConsumer that flushes the same set of reports.
+  std::unique_ptr<TrimmedGraph> SharedTrimmedGraph;
+
+  /// The error nodes SharedTrimmedGraph was built for.
+  SmallVector<const ExplodedNode *, 32> SharedTrimmedGraphNodes;
+
 public:
-  GRBugReporter(BugReporterData& d, ExprEngine& eng)
-    : BugReporter(d, GRBugReporterKind), Eng(eng) {}
+  GRBugReporter(BugReporterData& d, ExprEngine& eng);
 
   ~GRBugReporter() override;
 
@@ -517,6 +526,10 @@ public:
   bool generatePathDiagnostic(PathDiagnostic &PD, PathDiagnosticConsumer &PC,
                               ArrayRef<BugReport*> &bugReports) override;
 
+  /// Release the trimmed graph shared by the consumers of the last
+  /// equivalence class.
+  void clearSharedTrimmedGraph();
+
   /// classof - Used by isa<>, cast<>, and dyn_cast<>.
   static bool classof(const BugReporter* R) {
     return R->getKind() == GRBugReporterKind;
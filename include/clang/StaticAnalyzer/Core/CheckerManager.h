@@ -26,6 +26,7 @@ namespace clang {
   class Decl;
   class Stmt;
   class CallExpr;
+  class DiagnosticsEngine;
 
 namespace ento {
   class CheckerBase;
@@ -97,13 +98,15 @@ public:
 class CheckerManager {
   const LangOptions LangOpts;
   AnalyzerOptionsRef AOptions;
+  DiagnosticsEngine *Diags;
   CheckName CurrentCheckName;
 
 public:
   CheckerManager(const LangOptions &langOpts,
-                 AnalyzerOptionsRef AOptions)
+                 AnalyzerOptionsRef AOptions,
+                 DiagnosticsEngine *Diags = nullptr)
     : LangOpts(langOpts),
-      AOptions(AOptions) {}
+      AOptions(AOptions), Diags(Diags) {}
 
   ~CheckerManager();
 
@@ -117,6 +120,10 @@ public:
   const LangOptions &getLangOpts() const { return LangOpts; }
   AnalyzerOptions &getAnalyzerOptions() { return *AOptions; }
 
+  /// \brief The diagnostics engine used to report problems with the checker
+  /// configuration, if any.
+  DiagnosticsEngine *getDiagnostics() const { return Diags; }
+
   typedef CheckerBase *CheckerRef;
   typedef const void *CheckerTag;
   typedef CheckerFn<void ()> CheckerDtor;
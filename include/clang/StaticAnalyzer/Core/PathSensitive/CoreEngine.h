@@ -84,6 +84,9 @@ private:
   /// (This data is owned by AnalysisConsumer.)
   FunctionSummariesTy *FunctionSummaries;
 
+  /// The number of work list items processed by this engine.
+  unsigned NumStepsTaken;
+
   void generateNode(const ProgramPoint &Loc,
                     ProgramStateRef State,
                     ExplodedNode *Pred);
@@ -112,7 +115,8 @@ public:
   /// Construct a CoreEngine object to analyze the provided CFG.
   CoreEngine(SubEngine &subengine, FunctionSummariesTy *FS)
       : SubEng(subengine), WList(WorkList::makeDFS()),
-        BCounterFactory(G.getAllocator()), FunctionSummaries(FS) {}
+        BCounterFactory(G.getAllocator()), FunctionSummaries(FS),
+        NumStepsTaken(0) {}
 
   /// getGraph - Returns the exploded graph.
   ExplodedGraph &getGraph() { return G; }
@@ -147,6 +151,9 @@ public:
   
   WorkList *getWorkList() const { return WList.get(); }
 
+  /// Returns the number of work list items processed so far.
+  unsigned getNumSteps() const { return NumStepsTaken; }
+
   BlocksExhausted::const_iterator blocks_exhausted_begin() const {
     return blocksExhausted.begin();
   }
@@ -270,6 +270,10 @@ protected:
 
   /// NumNodes - The number of nodes in the graph.
   unsigned NumNodes;
+
+  /// The number of nodes ever created in the graph, including the ones that
+  /// were later reclaimed.
+  unsigned NumCreatedNodes;
   
   /// A list of recently allocated nodes that can potentially be recycled.
   NodeVector ChangedNodes;
@@ -321,6 +325,9 @@ public:
   bool empty() const { return NumNodes == 0; }
   unsigned size() const { return NumNodes; }
 
+  /// Returns the number of nodes created so far, including reclaimed ones.
+  unsigned getNumCreatedNodes() const { return NumCreatedNodes; }
+
   // Iterators.
   typedef ExplodedNode                        NodeTy;
   typedef llvm::FoldingSet<ExplodedNode>      AllNodesTy;
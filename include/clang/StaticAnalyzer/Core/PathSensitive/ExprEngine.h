@@ -319,6 +319,9 @@ public:
 
   const CoreEngine &getCoreEngine() const { return Engine; }
 
+  /// Returns the number of work list items processed by the engine.
+  unsigned getNumSteps() const { return Engine.getNumSteps(); }
+
 public:
   /// Visit - Transfer function logic for all statements.  Dispatches to
   ///  other functions that handle specific kinds of statements.
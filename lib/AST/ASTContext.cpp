@@ -55,45 +55,55 @@ unsigned ASTContext::NumImplicitMoveAssignmentOperators;
 unsigned ASTContext::NumImplicitMoveAssignmentOperatorsDeclared;
 unsigned ASTContext::NumImplicitDestructors;
 unsigned ASTContext::NumImplicitDestructorsDeclared;
+unsigned ASTContext::NumLookupTableBuilds;
+unsigned ASTContext::NumLookupTableUpdates;
+unsigned ASTContext::NumLookupTableDeclsWalked;
 
 enum FloatingRank {
   HalfRank, FloatRank, DoubleRank, LongDoubleRank
 };
 
-RawComment *ASTContext::getRawCommentForDeclNoCache(const Decl *D) const {
-  if (!CommentsLoaded && ExternalSource) {
-    ExternalSource->ReadComments();
+void ASTContext::loadComments() const {
+  if (CommentsLoaded || !ExternalSource)
+    return;
+
+  ExternalSource->ReadComments();
 
 #ifndef NDEBUG
-    ArrayRef<RawComment *> RawComments = Comments.getComments();
-    assert(std::is_sorted(RawComments.begin(), RawComments.end(),
-                          BeforeThanCompare<RawComment>(SourceMgr)));
+  ArrayRef<RawComment *> RawComments = Comments.getComments();
+  assert(std::is_sorted(RawComments.begin(), RawComments.end(),
+                        BeforeThanCompare<RawComment>(SourceMgr)));
 #endif
 
-    CommentsLoaded = true;
-  }
+  CommentsLoaded = true;
+}
 
+/// \brief Return the location that is used to find the documentation comment
+/// of the given declaration, or an invalid location if the user can not
+/// attach documentation to it.
+static SourceLocation getDeclLocForCommentSearch(const Decl *D,
+                                                 SourceManager &SourceMgr) {
   assert(D);
 
   // User can not attach documentation to implicit declarations.
   if (D->isImplicit())
-    return nullptr;
+    return SourceLocation();
 
   // User can not attach documentation to implicit instantiations.
   if (const FunctionDecl *FD = dyn_cast<FunctionDecl>(D)) {
     if (FD->getTemplateSpecializationKind() == TSK_ImplicitInstantiation)
-      return nullptr;
+      return SourceLocation();
   }
 
   if (const VarDecl *VD = dyn_cast<VarDecl>(D)) {
     if (VD->isStaticDataMember() &&
         VD->getTemplateSpecializationKind() == TSK_ImplicitInstantiation)
-      return nullptr;
+      return SourceLocation();
   }
 
   if (const CXXRecordDecl *CRD = dyn_cast<CXXRecordDecl>(D)) {
     if (CRD->getTemplateSpecializationKind() == TSK_ImplicitInstantiation)
-      return nullptr;
+      return SourceLocation();
   }
 
   if (const ClassTemplateSpecializationDecl *CTSD =
@@ -101,35 +111,29 @@ RawComment *ASTContext::getRawCommentForDeclNoCache(const Decl *D) const {
     TemplateSpecializationKind TSK = CTSD->getSpecializationKind();
     if (TSK == TSK_ImplicitInstantiation ||
         TSK == TSK_Undeclared)
-      return nullptr;
+      return SourceLocation();
   }
 
   if (const EnumDecl *ED = dyn_cast<EnumDecl>(D)) {
     if (ED->getTemplateSpecializationKind() == TSK_ImplicitInstantiation)
-      return nullptr;
+      return SourceLocation();
   }
   if (const TagDecl *TD = dyn_cast<TagDecl>(D)) {
     // When tag declaration (but not definition!) is part of the
     // decl-specifier-seq of some other declaration, it doesn't get comment
     if (TD->isEmbeddedInDeclarator() && !TD->isCompleteDefinition())
-      return nullptr;
+      return SourceLocation();
   }
   // TODO: handle comments for function parameters properly.
   if (isa<ParmVarDecl>(D))
-    return nullptr;
+    return SourceLocation();
 
   // TODO: we could look up template parameter documentation in the template
   // documentation.
   if (isa<TemplateTypeParmDecl>(D) ||
       isa<NonTypeTemplateParmDecl>(D) ||
       isa<TemplateTemplateParmDecl>(D))
-    return nullptr;
-
-  ArrayRef<RawComment *> RawComments = Comments.getComments();
-
-  // If there are no comments anywhere, we won't find anything.
-  if (RawComments.empty())
-    return nullptr;
+    return SourceLocation();
 
   // Find declaration location.
   // For Objective-C declarations we generally don't expect to have multiple
@@ -167,36 +171,19 @@ RawComment *ASTContext::getRawCommentForDeclNoCache(const Decl *D) const {
   // If the declaration doesn't map directly to a location in a file, we
   // can't find the comment.
   if (DeclLoc.isInvalid() || !DeclLoc.isFileID())
-    return nullptr;
+    return SourceLocation();
 
-  // Find the comment that occurs just after this declaration.
-  ArrayRef<RawComment *>::iterator Comment;
-  {
-    // When searching for comments during parsing, the comment we are looking
-    // for is usually among the last two comments we parsed -- check them
-    // first.
-    RawComment CommentAtDeclLoc(
-        SourceMgr, SourceRange(DeclLoc), false,
-        LangOpts.CommentOpts.ParseAllComments);
-    BeforeThanCompare<RawComment> Compare(SourceMgr);
-    ArrayRef<RawComment *>::iterator MaybeBeforeDecl = RawComments.end() - 1;
-    bool Found = Compare(*MaybeBeforeDecl, &CommentAtDeclLoc);
-    if (!Found && RawComments.size() >= 2) {
-      MaybeBeforeDecl--;
-      Found = Compare(*MaybeBeforeDecl, &CommentAtDeclLoc);
-    }
-
-    if (Found) {
-      Comment = MaybeBeforeDecl + 1;
-      assert(Comment == std::lower_bound(RawComments.begin(), RawComments.end(),
-                                         &CommentAtDeclLoc, Compare));
-    } else {
-      // Slow path.
-      Comment = std::lower_bound(RawComments.begin(), RawComments.end(),
-                                 &CommentAtDeclLoc, Compare);
-    }
-  }
+  return DeclLoc;
+}
 
+/// \brief Return the documentation comment attached to the declaration at
+/// \p DeclLoc, given the first of \p RawComments that does not begin before
+/// the declaration.
+static RawComment *
+getCommentAroundDeclLoc(const Decl *D, SourceLocation DeclLoc,
+                        ArrayRef<RawComment *> RawComments,
+                        ArrayRef<RawComment *>::iterator Comment,
+                        SourceManager &SourceMgr) {
   // Decompose the location for the declaration and find the beginning of the
   // file buffer.
   std::pair<FileID, unsigned> DeclLocDecomp = SourceMgr.getDecomposedLoc(DeclLoc);
@@ -256,6 +243,137 @@ RawComment *ASTContext::getRawCommentForDeclNoCache(const Decl *D) const {
   return *Comment;
 }
 
+RawComment *ASTContext::getRawCommentForDeclNoCache(const Decl *D) const {
+  loadComments();
+
+  SourceLocation DeclLoc = getDeclLocForCommentSearch(D, SourceMgr);
+  if (DeclLoc.isInvalid())
+    return nullptr;
+
+  ArrayRef<RawComment *> RawComments = Comments.getComments();
+
+  // If there are no comments anywhere, we won't find anything.
+  if (RawComments.empty())
+    return nullptr;
+
+  // Find the comment that occurs just after this declaration.
+  ArrayRef<RawComment *>::iterator Comment;
+  {
+    // When searching for comments during parsing, the comment we are looking
+    // for is usually among the last two comments we parsed -- check them
+    // first.
+    RawComment CommentAtDeclLoc(
+        SourceMgr, SourceRange(DeclLoc), false,
+        LangOpts.CommentOpts.ParseAllComments);
+    BeforeThanCompare<RawComment> Compare(SourceMgr);
+    ArrayRef<RawComment *>::iterator MaybeBeforeDecl = RawComments.end() - 1;
+    bool Found = Compare(*MaybeBeforeDecl, &CommentAtDeclLoc);
+    if (!Found && RawComments.size() >= 2) {
+      MaybeBeforeDecl--;
+      Found = Compare(*MaybeBeforeDecl, &CommentAtDeclLoc);
+    }
+
+    if (Found) {
+      Comment = MaybeBeforeDecl + 1;
+      assert(Comment == std::lower_bound(RawComments.begin(), RawComments.end(),
+                                         &CommentAtDeclLoc, Compare));
+    } else {
+      // Slow path.
+      Comment = std::lower_bound(RawComments.begin(), RawComments.end(),
+                                 &CommentAtDeclLoc, Compare);
+    }
+  }
+
+  return getCommentAroundDeclLoc(D, DeclLoc, RawComments, Comment, SourceMgr);
+}
+
+namespace {
+/// \brief A declaration whose comment is searched by attachCommentsToDecls(),
+/// with the offset of its declaration location in its file.
+struct DeclToAttach {
+  unsigned Offset;
+  SourceLocation DeclLoc;
+  const Decl *D;
+
+  bool operator<(const DeclToAttach &Other) const {
+    return Offset < Other.Offset;
+  }
+};
+} // end anonymous namespace
+
+void ASTContext::attachCommentsToDecls(ArrayRef<const Decl *> Decls) const {
+  loadComments();
+
+  // Group the declarations by the file of their declaration location. The
+  // declarations the user can not document, or whose comment has already been
+  // searched, are recorded or skipped right away.
+  llvm::DenseMap<FileID, SmallVector<DeclToAttach, 16> > DeclsInFile;
+  for (const Decl *D : Decls) {
+    if (RedeclComments.count(D))
+      continue;
+
+    SourceLocation DeclLoc = getDeclLocForCommentSearch(D, SourceMgr);
+    if (DeclLoc.isInvalid()) {
+      RawCommentAndCacheFlags Raw;
+      Raw.setRaw(nullptr);
+      Raw.setKind(RawCommentAndCacheFlags::NoCommentInDecl);
+      Raw.setOriginalDecl(D);
+      RedeclComments[D] = Raw;
+      continue;
+    }
+
+    std::pair<FileID, unsigned> LocInfo = SourceMgr.getDecomposedLoc(DeclLoc);
+    DeclToAttach Entry = { LocInfo.second, DeclLoc, D };
+    DeclsInFile[LocInfo.first].push_back(Entry);
+  }
+  if (DeclsInFile.empty())
+    return;
+
+  // Group the comments the same way. The comments are sorted in translation
+  // unit order, so the comments of each file are sorted by offset.
+  llvm::DenseMap<FileID, SmallVector<RawComment *, 16> > CommentsInFile;
+  for (RawComment *RC : Comments.getComments()) {
+    FileID FID = SourceMgr.getFileID(RC->getLocStart());
+    if (DeclsInFile.count(FID))
+      CommentsInFile[FID].push_back(RC);
+  }
+
+  // Walk the declarations and the comments of each file together.
+  for (auto &File : DeclsInFile) {
+    SmallVectorImpl<DeclToAttach> &FileDecls = File.second;
+    std::stable_sort(FileDecls.begin(), FileDecls.end());
+
+    ArrayRef<RawComment *> FileComments;
+    auto Known = CommentsInFile.find(File.first);
+    if (Known != CommentsInFile.end())
+      FileComments = Known->second;
+
+    ArrayRef<RawComment *>::iterator Comment = FileComments.begin();
+    for (const DeclToAttach &Entry : FileDecls) {
+      while (Comment != FileComments.end() &&
+             SourceMgr.getFileOffset((*Comment)->getLocStart()) <
+                 Entry.Offset)
+        ++Comment;
+
+      RawComment *RC = nullptr;
+      if (!FileComments.empty())
+        RC = getCommentAroundDeclLoc(Entry.D, Entry.DeclLoc, FileComments,
+                                     Comment, SourceMgr);
+
+      RawCommentAndCacheFlags Raw;
+      if (RC) {
+        Raw.setRaw(RC);
+        Raw.setKind(RawCommentAndCacheFlags::FromDecl);
+      } else {
+        Raw.setRaw(nullptr);
+        Raw.setKind(RawCommentAndCacheFlags::NoCommentInDecl);
+      }
+      Raw.setOriginalDecl(Entry.D);
+      RedeclComments[Entry.D] = Raw;
+    }
+  }
+}
+
 namespace {
 /// If we have a 'templated' declaration for a template, adjust 'D' to
 /// refer to the actual template.
@@ -744,7 +862,7 @@ ASTContext::ASTContext(LangOptions &LOpts, SourceManager &SM,
       AddrSpaceMap(nullptr), Target(nullptr), PrintingPolicy(LOpts),
       Idents(idents), Selectors(sels), BuiltinInfo(builtins),
       DeclarationNames(*this), ExternalSource(nullptr), Listener(nullptr),
-      Comments(SM), CommentsLoaded(false),
+      DeclContextGeneration(0), Comments(SM), CommentsLoaded(false),
       CommentCommandTraits(BumpAlloc, LOpts.CommentOpts), LastSDM(nullptr, 0) {
   TUDecl = TranslationUnitDecl::Create(*this);
 }
@@ -858,6 +976,10 @@ void ASTContext::PrintStats() const {
                << NumImplicitDestructors
                << " implicit destructors created\n";
 
+  llvm::errs() << NumLookupTableBuilds << " lookup tables built, "
+               << NumLookupTableUpdates << " updated incrementally, "
+               << NumLookupTableDeclsWalked << " declarations walked\n";
+
   if (ExternalSource) {
     llvm::errs() << "\n";
     ExternalSource->PrintStats();
@@ -3034,6 +3156,7 @@ ASTContext::getFunctionType(QualType ResultTy, ArrayRef<QualType> ArgArray,
   FunctionProtoType *FTP = (FunctionProtoType*) Allocate(Size, TypeAlignment);
   FunctionProtoType::ExtProtoInfo newEPI = EPI;
   new (FTP) FunctionProtoType(ResultTy, ArgArray, Canonical, newEPI);
+  FTP->ProfileHash = ID.ComputeHash();
   Types.push_back(FTP);
   FunctionProtoTypes.InsertNode(FTP, InsertPos);
   return QualType(FTP, 0);
@@ -3383,6 +3506,7 @@ ASTContext::getCanonicalTemplateSpecializationType(TemplateName Template,
     Spec = new (Mem) TemplateSpecializationType(CanonTemplate,
                                                 CanonArgs.data(), NumArgs,
                                                 QualType(), QualType());
+    Spec->ProfileHash = ID.ComputeHash();
     Types.push_back(Spec);
     TemplateSpecializationTypes.InsertNode(Spec, InsertPos);
   }
@@ -1176,6 +1176,7 @@ void DeclContext::removeDecl(Decl *D) {
          "decl being removed from non-lexical context");
   assert((D->NextInContextAndBits.getPointer() || D == LastDecl) &&
          "decl is not in decls list");
+  ++getParentASTContext().DeclContextGeneration;
 
   // Remove D from the decl chain.  This is O(n) but hopefully rare.
   if (D == FirstDecl) {
@@ -1219,6 +1220,7 @@ void DeclContext::addHiddenDecl(Decl *D) {
          "Decl inserted into wrong lexical context");
   assert(!D->getNextDeclInContext() && D != LastDecl &&
          "Decl already inserted into a DeclContext");
+  ++getParentASTContext().DeclContextGeneration;
 
   if (FirstDecl) {
     LastDecl->NextInContextAndBits.setPointer(D);
@@ -1289,6 +1291,11 @@ static bool shouldBeHidden(NamedDecl *D) {
 /// Note that the produced map may miss out declarations from an
 /// external source. If it does, those entries will be marked with
 /// the 'hasExternalDecls' flag.
+///
+/// If the only declarations missing from the map are those loaded from the
+/// external source's lexical storage, only those are walked; since they are
+/// spliced in at the start of each context, they are the ones before the
+/// previous first declaration.
 StoredDeclsMap *DeclContext::buildLookup() {
   assert(this == getPrimaryContext() && "buildLookup called on non-primary DC");
 
@@ -1300,16 +1307,34 @@ StoredDeclsMap *DeclContext::buildLookup() {
 
   if (HasLazyExternalLexicalLookups) {
     HasLazyExternalLexicalLookups = false;
+
+    SmallVector<std::pair<DeclContext *, Decl *>, 2> LoadedContexts;
     for (auto *DC : Contexts) {
-      if (DC->hasExternalLexicalStorage())
-        HasLazyLocalLexicalLookups |=
-            DC->LoadLexicalDeclsFromExternalStorage();
+      if (!DC->hasExternalLexicalStorage())
+        continue;
+      Decl *OldFirstDecl = DC->FirstDecl;
+      if (!DC->LoadLexicalDeclsFromExternalStorage())
+        continue;
+      assert((!OldFirstDecl ||
+              std::find(decl_iterator(DC->FirstDecl), decl_iterator(),
+                        OldFirstDecl) != decl_iterator()) &&
+             "loaded lexical declarations not spliced in front of the "
+             "existing ones");
+      LoadedContexts.push_back(std::make_pair(DC, OldFirstDecl));
     }
 
-    if (!HasLazyLocalLexicalLookups)
+    if (!HasLazyLocalLexicalLookups) {
+      if (!LoadedContexts.empty())
+        ++ASTContext::NumLookupTableUpdates;
+      for (auto &Loaded : LoadedContexts)
+        buildLookupImpl(decl_iterator(Loaded.first->FirstDecl),
+                        decl_iterator(Loaded.second),
+                        hasExternalVisibleStorage());
       return LookupPtr;
+    }
   }
 
+  ++ASTContext::NumLookupTableBuilds;
   for (auto *DC : Contexts)
     buildLookupImpl(DC, hasExternalVisibleStorage());
 
@@ -1323,7 +1348,18 @@ StoredDeclsMap *DeclContext::buildLookup() {
 /// DeclContext, a DeclContext linked to it, or a transparent context
 /// nested within it.
 void DeclContext::buildLookupImpl(DeclContext *DCtx, bool Internal) {
-  for (Decl *D : DCtx->noload_decls()) {
+  buildLookupImpl(DCtx->noload_decls_begin(), DCtx->noload_decls_end(),
+                  Internal);
+}
+
+/// buildLookupImpl - Build part of the lookup data structure for the
+/// declarations in the range [Begin, End) of the declarations of a single
+/// context.
+void DeclContext::buildLookupImpl(decl_iterator Begin, decl_iterator End,
+                                  bool Internal) {
+  for (Decl *D : llvm::make_range(Begin, End)) {
+    ++ASTContext::NumLookupTableDeclsWalked;
+
     // Insert this declaration into the lookup structure, but only if
     // it's semantically within its decl context. Any other decls which
     // should be found in this context are added eagerly.
@@ -1333,7 +1369,8 @@ void DeclContext::buildLookupImpl(DeclContext *DCtx, bool Internal) {
     // in C++, we do not track external visible decls for the TU, so in
     // that case we need to collect them all here.
     if (NamedDecl *ND = dyn_cast<NamedDecl>(D))
-      if (ND->getDeclContext() == DCtx && !shouldBeHidden(ND) &&
+      if (ND->getLexicalDeclContext() == ND->getDeclContext() &&
+          !shouldBeHidden(ND) &&
           (!ND->isFromASTFile() ||
            (isTranslationUnit() &&
             !getParentASTContext().getLangOpts().CPlusPlus)))
@@ -1534,6 +1571,7 @@ void DeclContext::makeDeclVisibleInContext(NamedDecl *D) {
 void DeclContext::makeDeclVisibleInContextWithFlags(NamedDecl *D, bool Internal,
                                                     bool Recoverable) {
   assert(this == getPrimaryContext() && "expected a primary DC");
+  ++getParentASTContext().DeclContextGeneration;
 
   // Skip declarations within functions.
   if (isFunctionOrMethod())
@@ -42,6 +42,7 @@
 #include "clang/AST/StmtVisitor.h"
 #include "clang/AST/TypeLoc.h"
 #include "clang/Basic/Builtins.h"
+#include "clang/Basic/TargetBuiltins.h"
 #include "clang/Basic/TargetInfo.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/raw_ostream.h"
@@ -5522,6 +5523,7 @@ namespace {
     bool VisitCastExpr(const CastExpr* E);
     bool VisitInitListExpr(const InitListExpr *E);
     bool VisitUnaryImag(const UnaryOperator *E);
+    bool VisitCallExpr(const CallExpr *E);
     // FIXME: Missing: unary -, unary ~, binary add/sub/mul/div,
     //                 binary comparisons, binary and/or/xor,
     //                 shufflevector, ExtVectorElementExpr
@@ -5672,6 +5674,212 @@ bool VectorExprEvaluator::VisitUnaryImag(const UnaryOperator *E) {
   return ZeroInitialization(E);
 }
 
+namespace {
+/// Element-wise integer operations performed by the x86 SIMD builtins we know
+/// how to constant fold.
+enum X86VectorOp {
+  X86_AddSatS, X86_AddSatU, X86_SubSatS, X86_SubSatU, X86_AvgU,
+  X86_MaxS, X86_MaxU, X86_MinS, X86_MinU, X86_MulLo, X86_Abs, X86_Shufb
+};
+}
+
+static X86VectorOp getX86VectorOp(unsigned BuiltinOp, bool &Known) {
+  Known = true;
+  switch (BuiltinOp) {
+  case X86::BI__builtin_ia32_paddsb:
+  case X86::BI__builtin_ia32_paddsw:
+  case X86::BI__builtin_ia32_paddsb128:
+  case X86::BI__builtin_ia32_paddsw128:
+  case X86::BI__builtin_ia32_paddsb256:
+  case X86::BI__builtin_ia32_paddsw256:
+    return X86_AddSatS;
+  case X86::BI__builtin_ia32_paddusb:
+  case X86::BI__builtin_ia32_paddusw:
+  case X86::BI__builtin_ia32_paddusb128:
+  case X86::BI__builtin_ia32_paddusw128:
+  case X86::BI__builtin_ia32_paddusb256:
+  case X86::BI__builtin_ia32_paddusw256:
+    return X86_AddSatU;
+  case X86::BI__builtin_ia32_psubsb:
+  case X86::BI__builtin_ia32_psubsw:
+  case X86::BI__builtin_ia32_psubsb128:
+  case X86::BI__builtin_ia32_psubsw128:
+  case X86::BI__builtin_ia32_psubsb256:
+  case X86::BI__builtin_ia32_psubsw256:
+    return X86_SubSatS;
+  case X86::BI__builtin_ia32_psubusb:
+  case X86::BI__builtin_ia32_psubusw:
+  case X86::BI__builtin_ia32_psubusb128:
+  case X86::BI__builtin_ia32_psubusw128:
+  case X86::BI__builtin_ia32_psubusb256:
+  case X86::BI__builtin_ia32_psubusw256:
+    return X86_SubSatU;
+  case X86::BI__builtin_ia32_pavgb:
+  case X86::BI__builtin_ia32_pavgw:
+  case X86::BI__builtin_ia32_pavgb128:
+  case X86::BI__builtin_ia32_pavgw128:
+  case X86::BI__builtin_ia32_pavgb256:
+  case X86::BI__builtin_ia32_pavgw256:
+    return X86_AvgU;
+  case X86::BI__builtin_ia32_pmaxsw:
+  case X86::BI__builtin_ia32_pmaxsb128:
+  case X86::BI__builtin_ia32_pmaxsw128:
+  case X86::BI__builtin_ia32_pmaxsd128:
+  case X86::BI__builtin_ia32_pmaxsb256:
+  case X86::BI__builtin_ia32_pmaxsw256:
+  case X86::BI__builtin_ia32_pmaxsd256:
+    return X86_MaxS;
+  case X86::BI__builtin_ia32_pmaxub:
+  case X86::BI__builtin_ia32_pmaxub128:
+  case X86::BI__builtin_ia32_pmaxuw128:
+  case X86::BI__builtin_ia32_pmaxud128:
+  case X86::BI__builtin_ia32_pmaxub256:
+  case X86::BI__builtin_ia32_pmaxuw256:
+  case X86::BI__builtin_ia32_pmaxud256:
+    return X86_MaxU;
+  case X86::BI__builtin_ia32_pminsw:
+  case X86::BI__builtin_ia32_pminsb128:
+  case X86::BI__builtin_ia32_pminsw128:
+  case X86::BI__builtin_ia32_pminsd128:
+  case X86::BI__builtin_ia32_pminsb256:
+  case X86::BI__builtin_ia32_pminsw256:
+  case X86::BI__builtin_ia32_pminsd256:
+    return X86_MinS;
+  case X86::BI__builtin_ia32_pminub:
+  case X86::BI__builtin_ia32_pminub128:
+  case X86::BI__builtin_ia32_pminuw128:
+  case X86::BI__builtin_ia32_pminud128:
+  case X86::BI__builtin_ia32_pminub256:
+  case X86::BI__builtin_ia32_pminuw256:
+  case X86::BI__builtin_ia32_pminud256:
+    return X86_MinU;
+  case X86::BI__builtin_ia32_pmulld128:
+    return X86_MulLo;
+  case X86::BI__builtin_ia32_pabsb:
+  case X86::BI__builtin_ia32_pabsw:
+  case X86::BI__builtin_ia32_pabsd:
+  case X86::BI__builtin_ia32_pabsb128:
+  case X86::BI__builtin_ia32_pabsw128:
+  case X86::BI__builtin_ia32_pabsd128:
+  case X86::BI__builtin_ia32_pabsb256:
+  case X86::BI__builtin_ia32_pabsw256:
+  case X86::BI__builtin_ia32_pabsd256:
+    return X86_Abs;
+  case X86::BI__builtin_ia32_pshufb:
+  case X86::BI__builtin_ia32_pshufb128:
+  case X86::BI__builtin_ia32_pshufb256:
+    return X86_Shufb;
+  default:
+    Known = false;
+    return X86_Abs;
+  }
+}
+
+static llvm::APInt evaluateX86VectorElt(X86VectorOp Op,
+                                        const llvm::APInt &A,
+                                        const llvm::APInt &B) {
+  unsigned Width = A.getBitWidth();
+  bool Overflow = false;
+  switch (Op) {
+  case X86_AddSatS: {
+    llvm::APInt R = A.sadd_ov(B, Overflow);
+    if (!Overflow)
+      return R;
+    return A.isNegative() ? llvm::APInt::getSignedMinValue(Width)
+                          : llvm::APInt::getSignedMaxValue(Width);
+  }
+  case X86_AddSatU: {
+    llvm::APInt R = A.uadd_ov(B, Overflow);
+    return Overflow ? llvm::APInt::getMaxValue(Width) : R;
+  }
+  case X86_SubSatS: {
+    llvm::APInt R = A.ssub_ov(B, Overflow);
+    if (!Overflow)
+      return R;
+    return A.isNegative() ? llvm::APInt::getSignedMinValue(Width)
+                          : llvm::APInt::getSignedMaxValue(Width);
+  }
+  case X86_SubSatU:
+    return A.ult(B) ? llvm::APInt(Width, 0) : A - B;
+  case X86_AvgU:
+    return (A.zext(Width + 1) + B.zext(Width + 1) + 1).lshr(1).trunc(Width);
+  case X86_MaxS:
+    return A.slt(B) ? B : A;
+  case X86_MaxU:
+    return A.ult(B) ? B : A;
+  case X86_MinS:
+    return A.slt(B) ? A : B;
+  case X86_MinU:
+    return A.ult(B) ? A : B;
+  case X86_MulLo:
+    return A * B;
+  case X86_Abs:
+    return A.isNegative() ? -A : A;
+  case X86_Shufb:
+    break;
+  }
+  llvm_unreachable("pshufb is not an element-wise operation");
+}
+
+bool VectorExprEvaluator::VisitCallExpr(const CallExpr *E) {
+  // Target builtin IDs overlap between targets; only the x86 ones are known.
+  llvm::Triple::ArchType Arch = Info.Ctx.getTargetInfo().getTriple().getArch();
+  unsigned BuiltinOp = E->getBuiltinCallee();
+  bool Known = false;
+  X86VectorOp Op = X86_Abs;
+  if (BuiltinOp >= Builtin::FirstTSBuiltin &&
+      (Arch == llvm::Triple::x86 || Arch == llvm::Triple::x86_64))
+    Op = getX86VectorOp(BuiltinOp, Known);
+  if (!Known)
+    return ExprEvaluatorBaseTy::VisitCallExpr(E);
+
+  // Evaluate the operands; all of them are integer vectors with the same
+  // shape as the result.
+  unsigned NumArgs = Op == X86_Abs ? 1 : 2;
+  if (E->getNumArgs() != NumArgs)
+    return Error(E);
+  APValue Ops[2];
+  for (unsigned I = 0; I != NumArgs; ++I) {
+    if (!EvaluateVector(E->getArg(I), Ops[I], Info))
+      return false;
+    if (!Ops[I].isVector())
+      return Error(E);
+  }
+
+  const VectorType *VT = E->getType()->castAs<VectorType>();
+  unsigned NElts = VT->getNumElements();
+  bool IsUnsigned = VT->getElementType()->isUnsignedIntegerType();
+  for (unsigned I = 0; I != NumArgs; ++I) {
+    if (Ops[I].getVectorLength() != NElts)
+      return Error(E);
+    for (unsigned J = 0; J != NElts; ++J)
+      if (!Ops[I].getVectorElt(J).isInt())
+        return Error(E);
+  }
+
+  SmallVector<APValue, 32> Elts;
+  Elts.reserve(NElts);
+  for (unsigned J = 0; J != NElts; ++J) {
+    const APSInt &A = Ops[0].getVectorElt(J).getInt();
+    if (Op == X86_Shufb) {
+      // Each byte of the second operand selects a byte of the first one from
+      // within the same 128-bit lane (64 bits for the MMX form), or zero.
+      unsigned LaneSize = NElts < 16 ? NElts : 16;
+      uint64_t Sel = Ops[1].getVectorElt(J).getInt().getZExtValue();
+      llvm::APInt R(A.getBitWidth(), 0);
+      if (!(Sel & 0x80))
+        R = Ops[0].getVectorElt((J / LaneSize) * LaneSize +
+                                (Sel & (LaneSize - 1))).getInt();
+      Elts.push_back(APValue(APSInt(R, IsUnsigned)));
+      continue;
+    }
+    const APSInt &B = NumArgs > 1 ? Ops[1].getVectorElt(J).getInt() : A;
+    Elts.push_back(APValue(APSInt(evaluateX86VectorElt(Op, A, B),
+                                  IsUnsigned)));
+  }
+  return Success(Elts, E);
+}
+
 //===----------------------------------------------------------------------===//
 // Array Evaluation
 //===----------------------------------------------------------------------===//
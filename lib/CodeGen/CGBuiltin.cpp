@@ -269,6 +269,8 @@ RValue CodeGenFunction::EmitBuiltinExpr(const FunctionDecl *FD,
     if (Result.Val.isFloat())
       return RValue::get(llvm::ConstantFP::get(getLLVMContext(),
                                                Result.Val.getFloat()));
+    if (Result.Val.isVector())
+      return RValue::get(CGM.EmitConstantValue(Result.Val, E->getType(), this));
   }
 
   switch (BuiltinID) {
@@ -181,6 +181,8 @@ llvm::Constant *CodeGenModule::getOrCreateStaticVarDecl(
   if (llvm::Constant *ExistingGV = StaticLocalDeclMap[&D])
     return ExistingGV;
 
+  checkCodeGenPartitionState(D);
+
   QualType Ty = D.getType();
   assert(Ty->isConstantSizeType() && "VLAs can't be static");
 
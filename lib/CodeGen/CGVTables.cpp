@@ -764,6 +764,9 @@ CodeGenModule::getVTableLinkage(const CXXRecordDecl *RD) {
 /// functions).  For weak vtables, CodeGen tracks when they are needed and
 /// emits them as-needed.
 void CodeGenModule::EmitVTable(CXXRecordDecl *theClass) {
+  if (!isVTableInCodeGenPartition(theClass))
+    return;
+
   VTables.GenerateClassData(theClass);
 }
 
@@ -809,9 +812,10 @@ bool CodeGenVTables::isVTableExternal(const CXXRecordDecl *RD) {
   if (!keyFunction)
     return false;
 
-  // Otherwise, if we don't have a definition of the key function, the
-  // v-table must be defined somewhere else.
-  return !keyFunction->hasBody();
+  // Otherwise, if we don't have a definition of the key function, or if
+  // another code generation partition emits it, the v-table must be defined
+  // somewhere else.
+  return !keyFunction->hasBody() || !CGM.isVTableInCodeGenPartition(RD);
 }
 
 /// Given that we're currently at the end of the translation unit, and
@@ -42,6 +42,7 @@
 #include "clang/Frontend/CodeGenOptions.h"
 #include "clang/Sema/SemaDiagnostic.h"
 #include "llvm/ADT/APSInt.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/IR/CallSite.h"
 #include "llvm/IR/CallingConv.h"
@@ -1271,6 +1272,84 @@ bool CodeGenModule::MayBeEmittedEagerly(const ValueDecl *Global) {
   return true;
 }
 
+void CodeGenModule::checkCodeGenPartitionState(const VarDecl &D) {
+  if (CodeGenOpts.CodeGenPartitionCount <= 1 ||
+      D.getType().isConstant(getContext()))
+    return;
+
+  // Every partition that uses a definition with internal linkage emits its
+  // own copy of it, so mutable state would no longer be shared. The static
+  // locals of a function with internal linkage are copied along with it.
+  const FunctionDecl *FD = nullptr;
+  if (D.isStaticLocal()) {
+    FD = dyn_cast_or_null<FunctionDecl>(D.getParentFunctionOrMethod());
+    if (!FD || getContext().GetGVALinkageForFunction(FD) != GVA_Internal)
+      return;
+  } else if (getContext().GetGVALinkageForVariable(&D) != GVA_Internal) {
+    return;
+  }
+  getDiags().Report(D.getLocation(), diag::err_codegen_partition_internal_state)
+      << &D;
+}
+
+void CodeGenModule::checkCodeGenPartitionInit(const VarDecl &D) {
+  if (CodeGenOpts.CodeGenPartitionCount <= 1 ||
+      isTemplateInstantiation(D.getTemplateSpecializationKind()))
+    return;
+
+  // Each partition registers its own global initializers, so the variables
+  // of a translation unit would no longer be initialized and destroyed in
+  // the order of their definitions.
+  getDiags().Report(D.getLocation(), diag::err_codegen_partition_ordered_init)
+      << &D;
+}
+
+bool CodeGenModule::isInCodeGenPartition(GlobalDecl GD) {
+  unsigned Count = CodeGenOpts.CodeGenPartitionCount;
+  if (Count <= 1)
+    return true;
+
+  // Only externally visible definitions that no other translation unit may
+  // provide are split; everything else is emitted by every partition that
+  // uses it.
+  const auto *D = cast<ValueDecl>(GD.getDecl());
+  GVALinkage Linkage;
+  if (const auto *FD = dyn_cast<FunctionDecl>(D))
+    Linkage = getContext().GetGVALinkageForFunction(FD);
+  else
+    Linkage = getContext().GetGVALinkageForVariable(cast<VarDecl>(D));
+  if (Linkage != GVA_StrongExternal)
+    return true;
+
+  // Keep the definitions that refer to each other by alias together: an
+  // alias goes with its aliasee, and the variants of a constructor or
+  // destructor go with the complete one.
+  StringRef Key;
+  if (const auto *AA = D->getAttr<AliasAttr>())
+    Key = AA->getAliasee();
+  else if (const auto *CD = dyn_cast<CXXConstructorDecl>(D))
+    Key = getMangledName(GlobalDecl(CD, Ctor_Complete));
+  else if (const auto *DD = dyn_cast<CXXDestructorDecl>(D))
+    Key = getMangledName(GlobalDecl(DD, Dtor_Complete));
+  else
+    Key = getMangledName(GD);
+  return llvm::HashString(Key) % Count == CodeGenOpts.CodeGenPartitionIndex;
+}
+
+bool CodeGenModule::isVTableInCodeGenPartition(const CXXRecordDecl *RD) {
+  if (CodeGenOpts.CodeGenPartitionCount <= 1)
+    return true;
+
+  // Without a key function, the v-table is emitted by every partition that
+  // uses it, like an inline function.
+  const CXXMethodDecl *KeyFunction = Context.getCurrentKeyFunction(RD);
+  if (!KeyFunction)
+    return true;
+  if (const auto *DD = dyn_cast<CXXDestructorDecl>(KeyFunction))
+    return isInCodeGenPartition(GlobalDecl(DD, Dtor_Complete));
+  return isInCodeGenPartition(KeyFunction);
+}
+
 llvm::Constant *CodeGenModule::GetAddrOfUuidDescriptor(
     const CXXUuidofExpr* E) {
   // Sema has verified that IIDSource has a __declspec(uuid()), and that its
@@ -1333,8 +1412,11 @@ void CodeGenModule::EmitGlobal(GlobalDecl GD) {
 
   // If this is an alias definition (which otherwise looks like a declaration)
   // emit it now.
-  if (Global->hasAttr<AliasAttr>())
+  if (Global->hasAttr<AliasAttr>()) {
+    if (!isInCodeGenPartition(GD))
+      return;
     return EmitAliasDefinition(GD);
+  }
 
   // If this is CUDA, be selective about which declarations we emit.
   if (LangOpts.CUDA) {
@@ -1379,6 +1461,11 @@ void CodeGenModule::EmitGlobal(GlobalDecl GD) {
       return;
   }
 
+  // Definitions assigned to another partition are only referenced. Skipping
+  // them here also avoids deserializing their bodies from an AST file.
+  if (!isInCodeGenPartition(GD))
+    return;
+
   // Defer code generation to first use when possible, e.g. if this is an inline
   // function. If the global must always be emitted, do it eagerly if possible
   // to benefit from cache locality.
@@ -1508,7 +1595,7 @@ void CodeGenModule::EmitGlobalDefinition(GlobalDecl GD, llvm::GlobalValue *GV) {
   if (isa<FunctionDecl>(D)) {
     // At -O0, don't generate IR for functions with available_externally 
     // linkage.
-    if (!shouldEmitFunction(GD))
+    if (!shouldEmitFunction(GD) || !isInCodeGenPartition(GD))
       return;
 
     if (const auto *Method = dyn_cast<CXXMethodDecl>(D)) {
@@ -1977,6 +2064,10 @@ void CodeGenModule::maybeSetTrivialComdat(const Decl &D,
 }
 
 void CodeGenModule::EmitGlobalVarDefinition(const VarDecl *D) {
+  if (!isInCodeGenPartition(D))
+    return;
+  checkCodeGenPartitionState(*D);
+
   llvm::Constant *Init = nullptr;
   QualType ASTTy = D->getType();
   CXXRecordDecl *RD = ASTTy->getBaseElementTypeUnsafe()->getAsCXXRecordDecl();
@@ -2122,8 +2213,10 @@ void CodeGenModule::EmitGlobalVarDefinition(const VarDecl *D) {
   maybeSetTrivialComdat(*D, *GV);
 
   // Emit the initializer function if necessary.
-  if (NeedsGlobalCtor || NeedsGlobalDtor)
+  if (NeedsGlobalCtor || NeedsGlobalDtor) {
+    checkCodeGenPartitionInit(*D);
     EmitCXXGlobalVarDeclInitFunc(D, GV, NeedsGlobalCtor);
+  }
 
   SanitizerMD->reportGlobalToASan(GV, *D, NeedsGlobalCtor);
 
@@ -460,6 +460,14 @@ private:
   bool isTriviallyRecursive(const FunctionDecl *F);
   bool shouldEmitFunction(GlobalDecl GD);
 
+  /// Diagnose a mutable variable whose copies would diverge when code
+  /// generation is split into partitions.
+  void checkCodeGenPartitionState(const VarDecl &D);
+
+  /// Diagnose a variable with ordered dynamic initialization or destruction,
+  /// whose order would be lost when code generation is split into partitions.
+  void checkCodeGenPartitionInit(const VarDecl &D);
+
   /// @name Cache for Blocks Runtime Globals
   /// @{
 
@@ -1016,6 +1024,11 @@ public:
 
   void EmitVTable(CXXRecordDecl *Class);
 
+  /// Determine whether the v-table of the class, along with its VTT and type
+  /// info, belongs to the code generation partition being emitted. They go
+  /// with the key function of the class.
+  bool isVTableInCodeGenPartition(const CXXRecordDecl *RD);
+
   /// Emit the RTTI descriptors for the builtin types.
   void EmitFundamentalRTTIDescriptors();
 
@@ -1251,6 +1264,11 @@ private:
   /// which may later be explicitly instantiated.
   bool MayBeEmittedEagerly(const ValueDecl *D);
 
+  /// Determine whether the definition belongs to the code generation
+  /// partition being emitted (see -fcodegen-partition). Definitions of other
+  /// partitions are only declared.
+  bool isInCodeGenPartition(GlobalDecl GD);
+
   /// Check whether we can use a "simpler", more core exceptions personality
   /// function.
   void SimplifyPersonality();
@@ -3916,6 +3916,11 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     CmdArgs.push_back(A->getValue());
   }
 
+  if (Arg *A = Args.getLastArg(options::OPT_fspell_checking_work_limit_EQ)) {
+    CmdArgs.push_back("-fspell-checking-work-limit");
+    CmdArgs.push_back(A->getValue());
+  }
+
   // Pass -fmessage-length=.
   CmdArgs.push_back("-fmessage-length");
   if (Arg *A = Args.getLastArg(options::OPT_fmessage_length_EQ)) {
@@ -4222,6 +4227,14 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   // definitions.
   Args.AddAllArgs(CmdArgs, options::OPT_fmodule_map_file);
 
+  // -fcompilation-cache-path lets -cc1 reuse the outputs of identical
+  // compilations.
+  Args.AddLastArg(CmdArgs, options::OPT_fcompilation_cache_path);
+  Args.AddLastArg(CmdArgs, options::OPT_fcompilation_cache_size);
+  if (!Args.hasFlag(options::OPT_fcompilation_cache_direct,
+                    options::OPT_fno_compilation_cache_direct, true))
+    CmdArgs.push_back("-fno-compilation-cache-direct");
+
   // -fmodule-file can be used to specify files containing precompiled modules.
   Args.AddAllArgs(CmdArgs, options::OPT_fmodule_file);
 
@@ -4268,6 +4281,7 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
 
   // Pass through all -fmodules-ignore-macro arguments.
   Args.AddAllArgs(CmdArgs, options::OPT_fmodules_ignore_macro);
+  Args.AddLastArg(CmdArgs, options::OPT_fmodules_build_jobs_EQ);
   Args.AddLastArg(CmdArgs, options::OPT_fmodules_prune_interval);
   Args.AddLastArg(CmdArgs, options::OPT_fmodules_prune_after);
 
@@ -4296,6 +4310,7 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   }
 
   Args.AddLastArg(CmdArgs, options::OPT_fmodules_validate_system_headers);
+  Args.AddLastArg(CmdArgs, options::OPT_fmodules_lazy_module_maps);
 
   // -faccess-control is default.
   if (Args.hasFlag(options::OPT_fno_access_control,
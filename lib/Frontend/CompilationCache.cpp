@@ -0,0 +1,813 @@
+//===--- CompilationCache.cpp - Cache of compilation outputs --------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Cache entries have the following format, with all integers little endian:
+//
+//   magic       8 bytes, "CLCACHE1"
+//   count       uint32, the number of outputs
+//   outputs     count times:
+//     kind      uint32, a CompilationCache::OutputKind
+//     size      uint64
+//     data      size bytes
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/CompilationCache.h"
+#include "clang/Basic/DiagnosticFrontend.h"
+#include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/Version.h"
+#include "clang/Frontend/ChainedDiagnosticConsumer.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/TextDiagnosticPrinter.h"
+#include "clang/Frontend/Utils.h"
+#include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/Preprocessor.h"
+#include "clang/Lex/PreprocessorOptions.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace clang;
+using namespace llvm::support;
+
+/// The magic number starting every cache entry. Its version must be bumped
+/// whenever the format of the entries changes.
+static const char EntryMagic[] = "CLCACHE1";
+static const unsigned EntryMagicSize = sizeof(EntryMagic) - 1;
+
+/// The size recorded in a manifest for a file that must not exist.
+static const uint64_t MissingFileSize = ~uint64_t(0);
+
+/// \brief Returns true if \p Arg is a -cc1 option whose value is a path that
+/// does not affect the contents of the outputs of \p Clang, so that
+/// compilations that only differ in it share their cache entries.
+static bool isIgnoredPathOption(StringRef Arg, const CompilerInstance &Clang) {
+  if (Arg == "-o" || Arg == "-dependency-file" ||
+      Arg == "-serialize-diagnostic-file")
+    return true;
+
+  // The driver passes these for every compilation, but they only end up in
+  // the outputs with coverage or debug info.
+  const CodeGenOptions &CGOpts = Clang.getCodeGenOpts();
+  if (Arg == "-coverage-file")
+    return !CGOpts.EmitGcovArcs && !CGOpts.EmitGcovNotes;
+  if (Arg == "-fdebug-compilation-dir")
+    return CGOpts.getDebugInfo() == CodeGenOptions::NoDebugInfo;
+  return false;
+}
+
+/// \brief Write \p Data to \p Path by way of a temporary file, so that
+/// concurrent readers never see a partially written file.
+static bool writeFileAtomically(StringRef Path, StringRef Data) {
+  SmallString<128> TempPath;
+  int FD;
+  if (llvm::sys::fs::createUniqueFile(Path + ".tmp-%%%%%%%%", FD, TempPath))
+    return false;
+
+  llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+  OS << Data;
+  OS.close();
+  if (OS.has_error()) {
+    OS.clear_error();
+    llvm::sys::fs::remove(TempPath);
+    return false;
+  }
+
+  if (llvm::sys::fs::rename(TempPath, Path)) {
+    llvm::sys::fs::remove(TempPath);
+    return false;
+  }
+  return true;
+}
+
+std::unique_ptr<CompilationCache>
+CompilationCache::create(CompilerInstance &Clang,
+                         ArrayRef<const char *> Argv) {
+  const FrontendOptions &FEOpts = Clang.getFrontendOpts();
+  switch (FEOpts.ProgramAction) {
+  case frontend::EmitAssembly:
+  case frontend::EmitBC:
+  case frontend::EmitLLVM:
+  case frontend::EmitObj:
+    break;
+  default:
+    return nullptr;
+  }
+
+  if (FEOpts.Inputs.size() != 1 || !FEOpts.Inputs[0].isFile() ||
+      FEOpts.Inputs[0].getFile() == "-" || FEOpts.OutputFile.empty() ||
+      FEOpts.OutputFile == "-")
+    return nullptr;
+  InputKind IK = FEOpts.Inputs[0].getKind();
+  if (IK == IK_AST || IK == IK_LLVM_IR)
+    return nullptr;
+
+  // Modules and precompiled headers contribute declarations that do not show
+  // up in the preprocessed input, and timers and statistics produce output
+  // that cannot be replayed.
+  const PreprocessorOptions &PPOpts = Clang.getPreprocessorOpts();
+  if (Clang.getLangOpts().Modules || !FEOpts.ModuleFiles.empty() ||
+      !PPOpts.ImplicitPCHInclude.empty() ||
+      !PPOpts.ImplicitPTHInclude.empty() || !FEOpts.AddPluginActions.empty() ||
+      FEOpts.ShowStats || FEOpts.ShowTimers)
+    return nullptr;
+
+  std::unique_ptr<CompilationCache> Cache(new CompilationCache(Clang));
+  Cache->hashArguments(Argv);
+  if (!(FEOpts.CompilationCacheDirect && Cache->lookupManifest()) &&
+      !Cache->computeKey())
+    return nullptr;
+
+  Cache->getCachePath(Cache->EntryKey, ".entry", Cache->EntryPath);
+  return Cache;
+}
+
+void CompilationCache::getCachePath(StringRef Key, StringRef Extension,
+                                    SmallVectorImpl<char> &Path) {
+  Path.clear();
+  llvm::sys::path::append(Path, Clang.getFrontendOpts().CompilationCachePath,
+                          Key.substr(0, 2), Key.substr(2) + Extension);
+}
+
+void CompilationCache::hashArguments(ArrayRef<const char *> Argv) {
+  llvm::MD5 Hash;
+  Hash.update(EntryMagic);
+  Hash.update(getClangFullVersion());
+
+  for (unsigned I = 0, E = Argv.size(); I != E; ++I) {
+    StringRef Arg = Argv[I];
+    if (isIgnoredPathOption(Arg, Clang)) {
+      ++I;
+      continue;
+    }
+    if (Arg.startswith("-fcompilation-cache-") ||
+        Arg.startswith("-fno-compilation-cache-"))
+      continue;
+    // The diagnostics are stored without colors.
+    if (Arg == "-fcolor-diagnostics")
+      continue;
+    // Include the terminating null character to separate the arguments.
+    Hash.update(ArrayRef<uint8_t>(reinterpret_cast<const uint8_t *>(Arg.data()),
+                                  Arg.size() + 1));
+  }
+
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  llvm::MD5::stringifyResult(Result, ArgsKey);
+}
+
+bool CompilationCache::computeKey() {
+  llvm::MD5 Hash;
+  Hash.update(ArgsKey);
+  if (!hashInputFiles(Hash))
+    return false;
+
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  llvm::MD5::stringifyResult(Result, EntryKey);
+  return true;
+}
+
+namespace {
+/// Collects every file the preprocessed input depends on, including system
+/// headers.
+class ManifestDependencyCollector : public DependencyCollector {
+  bool needSystemDependencies() override { return true; }
+};
+
+/// Feeds the name and contents of every file the preprocessor enters, and
+/// the results of the __has_include probes, in order, into a hash.
+class InputFileHasher : public PPCallbacks {
+  Preprocessor &PP;
+  SourceManager &SM;
+  llvm::MD5 &Hash;
+
+  /// The digests of the buffers hashed so far, by the start of their data;
+  /// headers without include guards are entered many times.
+  llvm::DenseMap<const char *, std::string> Digests;
+
+public:
+  /// The files found by __has_include probes.
+  std::vector<std::string> ProbedFiles;
+
+  /// The paths at which __has_include probes found no file.
+  std::vector<std::string> MissingFiles;
+
+  /// Whether a probe that found no file looked in a framework or a header
+  /// map, whose candidate paths are not recorded.
+  bool HasUnrecordedProbe;
+
+  InputFileHasher(Preprocessor &PP, llvm::MD5 &Hash)
+      : PP(PP), SM(PP.getSourceManager()), Hash(Hash),
+        HasUnrecordedProbe(false) {}
+
+  void FileChanged(SourceLocation Loc, FileChangeReason Reason,
+                   SrcMgr::CharacteristicKind FileType,
+                   FileID PrevFID) override {
+    if (Reason != EnterFile)
+      return;
+
+    bool Invalid = false;
+    StringRef Data = SM.getBufferData(SM.getFileID(Loc), &Invalid);
+    std::string &Digest = Digests[Data.data()];
+    if (Digest.empty()) {
+      llvm::MD5 FileHash;
+      FileHash.update(Data);
+      llvm::MD5::MD5Result Result;
+      FileHash.final(Result);
+      Digest.assign(reinterpret_cast<const char *>(Result), sizeof(Result));
+    }
+
+    // Include the terminating null character to separate the name from the
+    // digest.
+    StringRef Name = SM.getBufferName(Loc);
+    Hash.update(ArrayRef<uint8_t>(
+        reinterpret_cast<const uint8_t *>(Name.data()), Name.size() + 1));
+    Hash.update(Digest);
+  }
+
+  void HasInclude(SourceLocation Loc, StringRef FileName, bool IsAngled,
+                  const FileEntry *File) override {
+    // A probe affects the preprocessed input without entering a file, so
+    // hash its result; the file found is only hashed if it is entered.
+    SmallString<128> Probe;
+    Probe += IsAngled ? '<' : '"';
+    Probe += FileName;
+    Probe += '\0';
+    if (File)
+      Probe += File->getName();
+    Hash.update(ArrayRef<uint8_t>(
+        reinterpret_cast<const uint8_t *>(Probe.data()), Probe.size() + 1));
+
+    if (File) {
+      ProbedFiles.push_back(File->getName());
+      return;
+    }
+
+    // Record every path the file could have been found at, whatever the
+    // search started from, so that the manifest notices when one appears.
+    if (llvm::sys::path::is_absolute(FileName)) {
+      MissingFiles.push_back(FileName);
+      return;
+    }
+    if (!IsAngled) {
+      if (const FileEntry *Includer =
+              SM.getFileEntryForID(SM.getFileID(SM.getExpansionLoc(Loc)))) {
+        SmallString<128> Path(Includer->getDir()->getName());
+        llvm::sys::path::append(Path, FileName);
+        MissingFiles.push_back(Path.str());
+      }
+    }
+    HeaderSearch &HS = PP.getHeaderSearchInfo();
+    for (auto I = HS.search_dir_begin(), E = HS.search_dir_end(); I != E; ++I) {
+      if (!I->isNormalDir()) {
+        HasUnrecordedProbe = true;
+        continue;
+      }
+      SmallString<128> Path(I->getDir()->getName());
+      llvm::sys::path::append(Path, FileName);
+      MissingFiles.push_back(Path.str());
+    }
+  }
+};
+
+/// Notices expansions of the macros that make the preprocessed input depend
+/// on the time of the compilation.
+class TimeMacroDetector : public PPCallbacks {
+  bool &UsesTime;
+
+public:
+  explicit TimeMacroDetector(bool &UsesTime) : UsesTime(UsesTime) {}
+
+  void MacroExpands(const Token &MacroNameTok, const MacroDefinition &MD,
+                    SourceRange Range, const MacroArgs *Args) override {
+    if (const IdentifierInfo *II = MacroNameTok.getIdentifierInfo()) {
+      StringRef Name = II->getName();
+      if (Name == "__DATE__" || Name == "__TIME__" || Name == "__TIMESTAMP__")
+        UsesTime = true;
+    }
+  }
+};
+} // end anonymous namespace
+
+void CompilationCache::getReadFiles(std::vector<std::string> &Files) {
+  const CodeGenOptions &CGOpts = Clang.getCodeGenOpts();
+  for (const std::string *Path :
+       {&CGOpts.InstrProfileInput, &CGOpts.SampleProfileFile,
+        &CGOpts.LinkBitcodeFile})
+    if (!Path->empty())
+      Files.push_back(*Path);
+  const LangOptions &LangOpts = Clang.getLangOpts();
+  Files.insert(Files.end(), LangOpts.SanitizerBlacklistFiles.begin(),
+               LangOpts.SanitizerBlacklistFiles.end());
+}
+
+static bool hashFile(StringRef Path, uint8_t (&Digest)[16]) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Path, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (!Buffer)
+    return false;
+  llvm::MD5 Hash;
+  Hash.update((*Buffer)->getBuffer());
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  memcpy(Digest, Result, sizeof(Digest));
+  return true;
+}
+
+bool CompilationCache::hashInputFiles(llvm::MD5 &Hash) {
+  // Preprocess the input with a separate instance, so that the compilation
+  // starts from scratch if the cache does not have its outputs.
+  CompilerInvocation *Invocation =
+      new CompilerInvocation(Clang.getInvocation());
+  // Don't let this pass write any of the outputs of the compilation.
+  Invocation->getDependencyOutputOpts() = DependencyOutputOptions();
+  Invocation->getDiagnosticOpts().DiagnosticSerializationFile.clear();
+  Invocation->getDiagnosticOpts().DiagnosticLogFile.clear();
+
+  CompilerInstance PPInstance(Clang.getPCHContainerOperations());
+  PPInstance.setInvocation(Invocation);
+  // The compilation reports the diagnostics itself; preprocessing errors
+  // just mean that it cannot be cached.
+  PPInstance.createDiagnostics(new IgnoringDiagConsumer());
+
+  PPInstance.setTarget(TargetInfo::CreateTargetInfo(
+      PPInstance.getDiagnostics(), Invocation->TargetOpts));
+  if (!PPInstance.hasTarget())
+    return false;
+  PPInstance.getTarget().adjust(PPInstance.getLangOpts());
+
+  bool RecordDependencies = Clang.getFrontendOpts().CompilationCacheDirect;
+  auto Collector = std::make_shared<ManifestDependencyCollector>();
+  if (RecordDependencies)
+    PPInstance.addDependencyCollector(Collector);
+
+  PPInstance.createFileManager();
+  PPInstance.createSourceManager(PPInstance.getFileManager());
+  if (!PPInstance.InitializeSourceManager(
+          Invocation->getFrontendOpts().Inputs[0]))
+    return false;
+  PPInstance.createPreprocessor(TU_Complete);
+  Preprocessor &PP = PPInstance.getPreprocessor();
+  PP.getBuiltinInfo().InitializeBuiltins(PP.getIdentifierTable(),
+                                         PP.getLangOpts());
+  bool UsesTime = false;
+  PP.addPPCallbacks(llvm::make_unique<TimeMacroDetector>(UsesTime));
+  auto Hasher = llvm::make_unique<InputFileHasher>(PP, Hash);
+  InputFileHasher &Probes = *Hasher;
+  PP.addPPCallbacks(std::move(Hasher));
+
+  // Only the files matter, so lex the input like -Eonly rather than printing
+  // it.
+  llvm::sys::TimeValue StartTime = llvm::sys::TimeValue::now();
+  PP.EnterMainSourceFile();
+  Token Tok;
+  do
+    PP.Lex(Tok);
+  while (Tok.isNot(tok::eof));
+
+  // The key does not cover the expansions of the time macros.
+  if (PPInstance.getDiagnostics().hasErrorOccurred() || UsesTime)
+    return false;
+
+  // The files the compilation reads besides its preprocessed input are
+  // named by its arguments, which only cover their paths.
+  std::vector<std::string> ReadFiles;
+  getReadFiles(ReadFiles);
+  for (const std::string &Path : ReadFiles) {
+    uint8_t Digest[16];
+    if (!hashFile(Path, Digest))
+      return false;
+    Hash.update(ArrayRef<uint8_t>(
+        reinterpret_cast<const uint8_t *>(Path.data()), Path.size() + 1));
+    Hash.update(Digest);
+  }
+
+  if (!RecordDependencies || Probes.HasUnrecordedProbe)
+    return true;
+
+  // Hash the dependencies for the manifest. A file modified since
+  // preprocessing started may not match what was preprocessed, so don't
+  // record anything then.
+  std::vector<std::string> Paths = Collector->getDependencies();
+  Paths.insert(Paths.end(), Probes.ProbedFiles.begin(),
+               Probes.ProbedFiles.end());
+  Paths.insert(Paths.end(), ReadFiles.begin(), ReadFiles.end());
+  for (const std::string &Path : Paths) {
+    llvm::sys::fs::file_status Status;
+    Dependency Dep;
+    Dep.Path = Path;
+    if (llvm::sys::fs::status(Path, Status) ||
+        Status.getLastModificationTime().toEpochTime() >=
+            StartTime.toEpochTime() ||
+        !hashFile(Path, Dep.Digest)) {
+      Dependencies.clear();
+      return true;
+    }
+    Dep.Size = Status.getSize();
+    Dependencies.push_back(std::move(Dep));
+  }
+
+  // A file that appears where a probe found none may change its result.
+  for (const std::string &Path : Probes.MissingFiles) {
+    if (llvm::sys::fs::exists(Path)) {
+      Dependencies.clear();
+      return true;
+    }
+    Dependency Dep;
+    Dep.Path = Path;
+    Dep.Size = MissingFileSize;
+    memset(Dep.Digest, 0, sizeof(Dep.Digest));
+    Dependencies.push_back(std::move(Dep));
+  }
+  return true;
+}
+
+/// The magic number starting every manifest. Its version must be bumped
+/// whenever the format of the manifests or the dependencies they record
+/// change.
+static const char ManifestMagic[] = "CLMANIF2";
+static const unsigned ManifestMagicSize = sizeof(ManifestMagic) - 1;
+
+/// The number of compilations a manifest remembers.
+static const unsigned MaxManifestRecords = 16;
+
+/// \brief Parse the records of a manifest, most recent first.
+///
+/// A manifest has the following format, with all integers little endian:
+///
+///   magic         8 bytes, "CLMANIF2"
+///   count         uint32, the number of records
+///   records       count times:
+///     key         32 bytes, the key of the cache entry in hex
+///     count       uint32, the number of dependencies
+///     dependencies  count times:
+///       length    uint32
+///       path      length bytes
+///       size      uint64, or MissingFileSize if the file must not exist
+///       digest    16 bytes, the MD5 hash of the contents
+template <typename RecordT>
+static bool readManifest(StringRef Data, std::vector<RecordT> &Records) {
+  if (!Data.startswith(ManifestMagic))
+    return false;
+  const unsigned char *Ptr = Data.bytes_begin() + ManifestMagicSize;
+  const unsigned char *End = Data.bytes_end();
+
+  if (End - Ptr < 4)
+    return false;
+  uint32_t NumRecords = endian::readNext<uint32_t, little, unaligned>(Ptr);
+  for (uint32_t I = 0; I != NumRecords; ++I) {
+    if (End - Ptr < 36)
+      return false;
+    RecordT Record;
+    Record.Key.assign(Ptr, Ptr + 32);
+    Ptr += 32;
+    uint32_t NumDeps = endian::readNext<uint32_t, little, unaligned>(Ptr);
+    for (uint32_t J = 0; J != NumDeps; ++J) {
+      if (End - Ptr < 4)
+        return false;
+      uint32_t Length = endian::readNext<uint32_t, little, unaligned>(Ptr);
+      if (uint64_t(End - Ptr) < uint64_t(Length) + 24)
+        return false;
+      Record.Dependencies.emplace_back();
+      auto &Dep = Record.Dependencies.back();
+      Dep.Path.assign(reinterpret_cast<const char *>(Ptr), Length);
+      Ptr += Length;
+      Dep.Size = endian::readNext<uint64_t, little, unaligned>(Ptr);
+      memcpy(Dep.Digest, Ptr, sizeof(Dep.Digest));
+      Ptr += sizeof(Dep.Digest);
+    }
+    Records.push_back(std::move(Record));
+  }
+  return true;
+}
+
+bool CompilationCache::lookupManifest() {
+  SmallString<128> ManifestPath;
+  getCachePath(ArgsKey, ".manifest", ManifestPath);
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(ManifestPath, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  std::vector<ManifestRecord> Records;
+  if (!Buffer || !readManifest((*Buffer)->getBuffer(), Records))
+    return false;
+
+  // The current state of the files seen so far; records often share most of
+  // their dependencies.
+  struct FileState {
+    bool Exists;
+    bool Hashed;
+    uint64_t Size;
+    uint8_t Digest[16];
+  };
+  llvm::StringMap<FileState> States;
+
+  for (const ManifestRecord &Record : Records) {
+    bool Matches = true;
+    for (const Dependency &Dep : Record.Dependencies) {
+      auto Known = States.find(Dep.Path);
+      if (Known == States.end()) {
+        FileState State;
+        llvm::sys::fs::file_status Status;
+        State.Exists = !llvm::sys::fs::status(Dep.Path, Status);
+        State.Hashed = false;
+        State.Size = State.Exists ? Status.getSize() : 0;
+        Known = States.insert(std::make_pair(Dep.Path, State)).first;
+      }
+
+      FileState &State = Known->second;
+      if (Dep.Size == MissingFileSize) {
+        if (State.Exists) {
+          Matches = false;
+          break;
+        }
+        continue;
+      }
+
+      // Only hash the file if its size matches.
+      if (State.Exists && State.Size == Dep.Size && !State.Hashed) {
+        State.Exists = hashFile(Dep.Path, State.Digest);
+        State.Hashed = true;
+      }
+      if (!State.Exists || State.Size != Dep.Size ||
+          memcmp(State.Digest, Dep.Digest, sizeof(Dep.Digest))) {
+        Matches = false;
+        break;
+      }
+    }
+
+    if (Matches) {
+      EntryKey = Record.Key;
+      FoundInManifest = true;
+      return true;
+    }
+  }
+  return false;
+}
+
+void CompilationCache::updateManifest() {
+  SmallString<128> ManifestPath;
+  getCachePath(ArgsKey, ".manifest", ManifestPath);
+
+  std::vector<ManifestRecord> Records(1);
+  Records[0].Key = EntryKey;
+  Records[0].Dependencies = std::move(Dependencies);
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(ManifestPath, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (Buffer && !readManifest((*Buffer)->getBuffer(), Records))
+    Records.resize(1);
+
+  // Drop the records of the same entry and the oldest ones.
+  for (unsigned I = 1; I < Records.size();) {
+    if (Records[I].Key == EntryKey)
+      Records.erase(Records.begin() + I);
+    else
+      ++I;
+  }
+  if (Records.size() > MaxManifestRecords)
+    Records.resize(MaxManifestRecords);
+
+  std::string Manifest;
+  {
+    llvm::raw_string_ostream OS(Manifest);
+    endian::Writer<little> LE(OS);
+    OS << ManifestMagic;
+    LE.write<uint32_t>(Records.size());
+    for (const ManifestRecord &Record : Records) {
+      OS << Record.Key;
+      LE.write<uint32_t>(Record.Dependencies.size());
+      for (const Dependency &Dep : Record.Dependencies) {
+        LE.write<uint32_t>(Dep.Path.size());
+        OS << Dep.Path;
+        LE.write<uint64_t>(Dep.Size);
+        OS.write(reinterpret_cast<const char *>(Dep.Digest),
+                 sizeof(Dep.Digest));
+      }
+    }
+  }
+  writeFileAtomically(ManifestPath, Manifest);
+}
+
+bool CompilationCache::replay() {
+  const FrontendOptions &FEOpts = Clang.getFrontendOpts();
+  StringRef OutputPaths[] = {
+    FEOpts.OutputFile,
+    Clang.getDependencyOutputOpts().OutputFile,
+    Clang.getDiagnosticOpts().DiagnosticSerializationFile
+  };
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Entry =
+      llvm::MemoryBuffer::getFile(EntryPath, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (Entry && (*Entry)->getBuffer().startswith(EntryMagic)) {
+    StringRef Data = (*Entry)->getBuffer();
+    const unsigned char *Ptr = Data.bytes_begin() + EntryMagicSize;
+    const unsigned char *End = Data.bytes_end();
+
+    StringRef Outputs[4];
+    bool Valid = End - Ptr >= 4;
+    if (Valid) {
+      uint32_t NumOutputs = endian::readNext<uint32_t, little, unaligned>(Ptr);
+      for (uint32_t I = 0; Valid && I != NumOutputs; ++I) {
+        if (End - Ptr < 12) {
+          Valid = false;
+          break;
+        }
+        uint32_t Kind = endian::readNext<uint32_t, little, unaligned>(Ptr);
+        uint64_t Size = endian::readNext<uint64_t, little, unaligned>(Ptr);
+        if (Kind > OK_DiagnosticText || Size > uint64_t(End - Ptr)) {
+          Valid = false;
+          break;
+        }
+        Outputs[Kind] = StringRef(reinterpret_cast<const char *>(Ptr), Size);
+        Ptr += Size;
+      }
+    }
+
+    // Every output the compilation asks for has to be replayed; if any of
+    // them cannot be written, compiling overwrites the others.
+    for (unsigned Kind = OK_MainOutput; Valid && Kind != OK_DiagnosticText;
+         ++Kind) {
+      if (OutputPaths[Kind].empty())
+        continue;
+      if (!Outputs[Kind].data() ||
+          !writeFileAtomically(OutputPaths[Kind], Outputs[Kind]))
+        Valid = false;
+    }
+
+    if (Valid) {
+      llvm::errs() << Outputs[OK_DiagnosticText];
+      if (FoundInManifest) {
+        SmallString<128> ManifestPath;
+        getCachePath(ArgsKey, ".manifest", ManifestPath);
+        Clang.getDiagnostics().Report(
+            diag::remark_compilation_cache_manifest_hit) << ManifestPath;
+      }
+      Clang.getDiagnostics().Report(diag::remark_compilation_cache_hit)
+          << EntryPath;
+
+      // The entry was found by preprocessing; record the dependencies so
+      // that the next compilation finds it through the manifest.
+      if (!Dependencies.empty())
+        updateManifest();
+
+      // Mark the entry as recently used, so that pruning keeps it.
+      int FD;
+      if (!llvm::sys::fs::openFileForWrite(EntryPath, FD,
+                                           llvm::sys::fs::F_Append)) {
+        llvm::sys::fs::setLastModificationAndAccessTime(
+            FD, llvm::sys::TimeValue::now());
+        llvm::sys::Process::SafelyCloseFileDescriptor(FD);
+      }
+      return true;
+    }
+  }
+
+  // Capture the diagnostics of the compilation as they are rendered, without
+  // colors: the entry is shared with compilations that do not use them, and
+  // colors are not always rendered as escape sequences.
+  DiagnosticStream = new llvm::raw_string_ostream(DiagnosticText);
+  IntrusiveRefCntPtr<DiagnosticOptions> CaptureOpts =
+      new DiagnosticOptions(Clang.getDiagnosticOpts());
+  CaptureOpts->ShowColors = false;
+  std::unique_ptr<DiagnosticConsumer> Capture(new TextDiagnosticPrinter(
+      *DiagnosticStream, &*CaptureOpts, /*OwnsOutputStream=*/true));
+  DiagnosticsEngine &Diags = Clang.getDiagnostics();
+  if (Diags.ownsClient())
+    Diags.setClient(
+        new ChainedDiagnosticConsumer(Diags.takeClient(), std::move(Capture)));
+  else
+    Diags.setClient(
+        new ChainedDiagnosticConsumer(Diags.getClient(), std::move(Capture)));
+  return false;
+}
+
+void CompilationCache::store() {
+  assert(DiagnosticStream && "storing a compilation replayed from the cache");
+  std::string Diagnostics = DiagnosticStream->str();
+
+  // Include the summary CompilerInstance::ExecuteAction printed after the
+  // diagnostics.
+  unsigned NumWarnings = Clang.getDiagnostics().getClient()->getNumWarnings();
+  if (Clang.getDiagnosticOpts().ShowCarets && NumWarnings) {
+    llvm::raw_string_ostream OS(Diagnostics);
+    OS << NumWarnings << " warning" << (NumWarnings == 1 ? "" : "s")
+       << " generated.\n";
+  }
+
+  const FrontendOptions &FEOpts = Clang.getFrontendOpts();
+  StringRef OutputPaths[] = {
+    FEOpts.OutputFile,
+    Clang.getDependencyOutputOpts().OutputFile,
+    Clang.getDiagnosticOpts().DiagnosticSerializationFile
+  };
+
+  std::unique_ptr<llvm::MemoryBuffer> Outputs[3];
+  for (unsigned Kind = OK_MainOutput; Kind != OK_DiagnosticText; ++Kind) {
+    if (OutputPaths[Kind].empty())
+      continue;
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+        llvm::MemoryBuffer::getFile(OutputPaths[Kind], /*FileSize=*/-1,
+                                    /*RequiresNullTerminator=*/false);
+    if (!Buffer)
+      return;
+    Outputs[Kind] = std::move(*Buffer);
+  }
+
+  StringRef Dir = llvm::sys::path::parent_path(EntryPath);
+  if (llvm::sys::fs::create_directories(Dir))
+    return;
+
+  std::string Entry;
+  {
+    llvm::raw_string_ostream OS(Entry);
+    endian::Writer<little> LE(OS);
+    OS << EntryMagic;
+    uint32_t NumOutputs = 1;
+    for (const auto &Output : Outputs)
+      NumOutputs += Output != nullptr;
+    LE.write<uint32_t>(NumOutputs);
+    for (unsigned Kind = OK_MainOutput; Kind != OK_DiagnosticText; ++Kind) {
+      if (!Outputs[Kind])
+        continue;
+      LE.write<uint32_t>(Kind);
+      LE.write<uint64_t>(Outputs[Kind]->getBufferSize());
+      OS << Outputs[Kind]->getBuffer();
+    }
+    LE.write<uint32_t>(OK_DiagnosticText);
+    LE.write<uint64_t>(Diagnostics.size());
+    OS << Diagnostics;
+  }
+
+  if (!writeFileAtomically(EntryPath, Entry))
+    return;
+  Clang.getDiagnostics().Report(diag::remark_compilation_cache_store)
+      << EntryPath;
+  if (!Dependencies.empty())
+    updateManifest();
+  pruneDirectory(Dir);
+}
+
+void CompilationCache::pruneDirectory(StringRef Dir) {
+  // Each of the 256 subdirectories gets an equal share of the size limit, so
+  // that only one of them needs to be scanned after storing an entry.
+  uint64_t Limit =
+      uint64_t(Clang.getFrontendOpts().CompilationCacheSize) * 1024 * 1024 /
+      256;
+
+  struct EntryInfo {
+    std::string Path;
+    llvm::sys::TimeValue LastUse;
+    uint64_t Size;
+
+    bool operator<(const EntryInfo &RHS) const {
+      return LastUse < RHS.LastUse;
+    }
+  };
+  std::vector<EntryInfo> Entries;
+  uint64_t TotalSize = 0;
+
+  std::error_code EC;
+  for (llvm::sys::fs::directory_iterator File(Dir, EC), FileEnd;
+       File != FileEnd && !EC; File.increment(EC)) {
+    StringRef Extension = llvm::sys::path::extension(File->path());
+    if (Extension != ".entry" && Extension != ".manifest")
+      continue;
+    llvm::sys::fs::file_status Status;
+    if (File->status(Status))
+      continue;
+    EntryInfo Info = { File->path(), Status.getLastModificationTime(),
+                       Status.getSize() };
+    Entries.push_back(Info);
+    TotalSize += Info.Size;
+  }
+  if (TotalSize <= Limit)
+    return;
+
+  // Remove the least recently used entries until the directory is well below
+  // its limit, so that storing the next entry does not prune again.
+  std::sort(Entries.begin(), Entries.end());
+  for (const EntryInfo &Info : Entries) {
+    if (TotalSize <= Limit / 10 * 9)
+      break;
+    if (!llvm::sys::fs::remove(Info.Path))
+      TotalSize -= Info.Size;
+  }
+}
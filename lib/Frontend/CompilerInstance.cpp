@@ -27,13 +27,17 @@
 #include "clang/Frontend/Utils.h"
 #include "clang/Frontend/VerifyDiagnosticConsumer.h"
 #include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/Lexer.h"
 #include "clang/Lex/PTHManager.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Sema/CodeCompleteConsumer.h"
 #include "clang/Sema/Sema.h"
 #include "clang/Serialization/ASTReader.h"
 #include "clang/Serialization/GlobalModuleIndex.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/FileSystem.h"
@@ -45,8 +49,12 @@
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <sys/stat.h>
 #include <system_error>
+#include <thread>
 #include <time.h>
 
 using namespace clang;
@@ -861,16 +869,12 @@ static InputKind getSourceInputKindFromOptions(const LangOptions &LangOpts) {
   return LangOpts.CPlusPlus? IK_CXX : IK_C;
 }
 
-/// \brief Compile a module file for the given module, using the options 
-/// provided by the importing compiler instance. Returns true if the module
-/// was built without errors.
-static bool compileModuleImpl(CompilerInstance &ImportingInstance,
-                              SourceLocation ImportLoc,
-                              Module *Module,
-                              StringRef ModuleFileName) {
-  ModuleMap &ModMap 
-    = ImportingInstance.getPreprocessor().getHeaderSearchInfo().getModuleMap();
-    
+/// \brief Construct the invocation for building the given module, from the
+/// options provided by the importing compiler instance. Its inputs are left
+/// for the caller to fill in.
+static IntrusiveRefCntPtr<CompilerInvocation>
+createModuleInvocation(CompilerInstance &ImportingInstance, Module *Module,
+                       StringRef ModuleFileName) {
   // Construct a compiler invocation for creating this module.
   IntrusiveRefCntPtr<CompilerInvocation> Invocation
     (new CompilerInvocation(ImportingInstance.getInvocation()));
@@ -896,24 +900,12 @@ static bool compileModuleImpl(CompilerInstance &ImportingInstance,
   // Note the name of the module we're building.
   Invocation->getLangOpts()->CurrentModule = Module->getTopLevelModuleName();
 
-  // Make sure that the failed-module structure has been allocated in
-  // the importing instance, and propagate the pointer to the newly-created
-  // instance.
-  PreprocessorOptions &ImportingPPOpts
-    = ImportingInstance.getInvocation().getPreprocessorOpts();
-  if (!ImportingPPOpts.FailedModules)
-    ImportingPPOpts.FailedModules = new PreprocessorOptions::FailedModulesSet;
-  PPOpts.FailedModules = ImportingPPOpts.FailedModules;
-
-  // If there is a module map file, build the module using the module map.
-  // Set up the inputs/outputs so that we build the module from its umbrella
-  // header.
+  // Set up the outputs; the module is built from its module map.
   FrontendOptions &FrontendOpts = Invocation->getFrontendOpts();
   FrontendOpts.OutputFile = ModuleFileName.str();
   FrontendOpts.DisableFree = false;
   FrontendOpts.GenerateGlobalModuleIndex = false;
   FrontendOpts.Inputs.clear();
-  InputKind IK = getSourceInputKindFromOptions(*Invocation->getLangOpts());
 
   // Don't free the remapped file buffers; they are owned by our caller.
   PPOpts.RetainRemappedFileBuffers = true;
@@ -921,7 +913,34 @@ static bool compileModuleImpl(CompilerInstance &ImportingInstance,
   Invocation->getDiagnosticOpts().VerifyDiagnostics = 0;
   assert(ImportingInstance.getInvocation().getModuleHash() ==
          Invocation->getModuleHash() && "Module hash mismatch!");
-  
+  return Invocation;
+}
+
+/// \brief Compile a module file for the given module, using the options 
+/// provided by the importing compiler instance. Returns true if the module
+/// was built without errors.
+static bool compileModuleImpl(CompilerInstance &ImportingInstance,
+                              SourceLocation ImportLoc,
+                              Module *Module,
+                              StringRef ModuleFileName) {
+  ModuleMap &ModMap 
+    = ImportingInstance.getPreprocessor().getHeaderSearchInfo().getModuleMap();
+
+  IntrusiveRefCntPtr<CompilerInvocation> Invocation =
+      createModuleInvocation(ImportingInstance, Module, ModuleFileName);
+  FrontendOptions &FrontendOpts = Invocation->getFrontendOpts();
+  InputKind IK = getSourceInputKindFromOptions(*Invocation->getLangOpts());
+
+  // Make sure that the failed-module structure has been allocated in
+  // the importing instance, and propagate the pointer to the newly-created
+  // instance.
+  PreprocessorOptions &ImportingPPOpts
+    = ImportingInstance.getInvocation().getPreprocessorOpts();
+  if (!ImportingPPOpts.FailedModules)
+    ImportingPPOpts.FailedModules = new PreprocessorOptions::FailedModulesSet;
+  Invocation->getPreprocessorOpts().FailedModules =
+      ImportingPPOpts.FailedModules;
+
   // Construct a compiler instance that will be used to actually create the
   // module.
   CompilerInstance Instance(ImportingInstance.getPCHContainerOperations(),
@@ -1081,6 +1100,447 @@ static bool compileAndLoadModule(CompilerInstance &ImportingInstance,
   }
 }
 
+namespace {
+/// \brief Records the diagnostics of a concurrent module build.
+class StoredDiagnosticCollector : public DiagnosticConsumer {
+  SmallVectorImpl<StoredDiagnostic> &StoredDiags;
+
+public:
+  StoredDiagnosticCollector(SmallVectorImpl<StoredDiagnostic> &StoredDiags)
+      : StoredDiags(StoredDiags) {}
+
+  void HandleDiagnostic(DiagnosticsEngine::Level Level,
+                        const Diagnostic &Info) override {
+    DiagnosticConsumer::HandleDiagnostic(Level, Info);
+    StoredDiags.push_back(StoredDiagnostic(Level, Info));
+  }
+};
+
+/// \brief A module to build before the importing compilation continues, as
+/// a node of the module build graph.
+struct ModuleBuildJob {
+  Module *TopLevel;
+  std::string ModuleFileName;
+  IntrusiveRefCntPtr<CompilerInvocation> Invocation;
+
+  /// \brief The module map the module is built from, and its contents if it
+  /// is inferred.
+  std::string ModuleMapPath;
+  std::string InferredModuleMap;
+  std::string ModuleMapForUniquing;
+
+  /// \brief The jobs that import this module.
+  SmallVector<unsigned, 4> Dependents;
+
+  /// \brief The number of imported modules that still have to be built.
+  unsigned PendingDependencies;
+
+  bool Succeeded;
+
+  /// \brief The diagnostics of the build, replayed by the importing instance
+  /// once all the builds finished.
+  SmallVector<StoredDiagnostic, 4> Diagnostics;
+
+  /// \brief The diagnostics engine and source manager of the build, kept
+  /// alive for the source locations of \c Diagnostics.
+  IntrusiveRefCntPtr<DiagnosticsEngine> Diags;
+  IntrusiveRefCntPtr<FileManager> FileMgr;
+  IntrusiveRefCntPtr<SourceManager> SourceMgr;
+
+  ModuleBuildJob(Module *TopLevel, StringRef ModuleFileName)
+      : TopLevel(TopLevel), ModuleFileName(ModuleFileName),
+        PendingDependencies(0), Succeeded(false) {}
+};
+
+/// \brief Finds the modules a module imports, by scanning its headers for
+/// inclusion and import directives.
+///
+/// The scan does not evaluate conditionals or expand macros, so it may find
+/// imports that the build of the module does not perform, or miss some (for
+/// example, headers included by macro name or found in an umbrella
+/// directory); the latter are built on demand, as usual.
+class ModuleImportScanner {
+  CompilerInstance &CI;
+  HeaderSearch &HS;
+  llvm::DenseSet<const FileEntry *> Visited;
+
+  void scanDirective(const char *Ptr, const char *End, const FileEntry *File,
+                     Module *Owner, SmallVectorImpl<Module *> &Imports);
+
+public:
+  ModuleImportScanner(CompilerInstance &CI)
+      : CI(CI), HS(CI.getPreprocessor().getHeaderSearchInfo()) {}
+
+  /// \brief Collect the top-level modules imported by the headers of \p M.
+  void scanModule(Module *M, SmallVectorImpl<Module *> &Imports);
+
+  /// \brief Collect the top-level modules imported by \p File, which is part
+  /// of \p Owner (or of the main file, if \p Owner is null).
+  void scanFile(const FileEntry *File, Module *Owner,
+                SmallVectorImpl<Module *> &Imports);
+};
+} // end anonymous namespace
+
+void ModuleImportScanner::scanModule(Module *M,
+                                     SmallVectorImpl<Module *> &Imports) {
+  Module *Owner = M->getTopLevelModule();
+  if (M == Owner)
+    Visited.clear();
+
+  for (Module *Use : M->DirectUses)
+    Imports.push_back(Use->getTopLevelModule());
+  if (Module::Header Umbrella = M->getUmbrellaHeader())
+    scanFile(Umbrella.Entry, Owner, Imports);
+  for (unsigned Kind = 0; Kind != Module::HK_Excluded; ++Kind)
+    for (const Module::Header &H : M->Headers[Kind])
+      scanFile(H.Entry, Owner, Imports);
+  for (auto Sub = M->submodule_begin(), SubEnd = M->submodule_end();
+       Sub != SubEnd; ++Sub)
+    scanModule(*Sub, Imports);
+}
+
+void ModuleImportScanner::scanFile(const FileEntry *File, Module *Owner,
+                                   SmallVectorImpl<Module *> &Imports) {
+  if (!File || !Visited.insert(File).second)
+    return;
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      CI.getFileManager().getBufferForFile(File);
+  if (!Buffer)
+    return;
+
+  const char *Start = (*Buffer)->getBufferStart();
+  const char *End = (*Buffer)->getBufferEnd();
+  Lexer RawLex(SourceLocation(), CI.getLangOpts(), Start, Start, End);
+  Token Tok;
+  RawLex.LexFromRawLexer(Tok);
+  while (Tok.isNot(tok::eof)) {
+    if (Tok.is(tok::hash) && Tok.isAtStartOfLine()) {
+      // #include, #import or #include_next.
+      RawLex.LexFromRawLexer(Tok);
+      if (Tok.is(tok::raw_identifier) &&
+          (Tok.getRawIdentifier() == "include" ||
+           Tok.getRawIdentifier() == "import" ||
+           Tok.getRawIdentifier() == "include_next"))
+        scanDirective(RawLex.getBufferLocation(), End, File, Owner, Imports);
+      continue;
+    }
+    if (Tok.is(tok::at)) {
+      // @import.
+      RawLex.LexFromRawLexer(Tok);
+      if (Tok.isNot(tok::raw_identifier) || Tok.getRawIdentifier() != "import")
+        continue;
+      RawLex.LexFromRawLexer(Tok);
+      if (Tok.is(tok::raw_identifier))
+        if (Module *M = HS.lookupModule(Tok.getRawIdentifier()))
+          if (M != Owner)
+            Imports.push_back(M);
+      continue;
+    }
+    RawLex.LexFromRawLexer(Tok);
+  }
+}
+
+void ModuleImportScanner::scanDirective(const char *Ptr, const char *End,
+                                        const FileEntry *File, Module *Owner,
+                                        SmallVectorImpl<Module *> &Imports) {
+  while (Ptr != End && (*Ptr == ' ' || *Ptr == '\t'))
+    ++Ptr;
+  if (Ptr == End || (*Ptr != '"' && *Ptr != '<'))
+    return;
+  bool IsAngled = *Ptr == '<';
+  const char *NameStart = ++Ptr;
+  while (Ptr != End && *Ptr != (IsAngled ? '>' : '"') && *Ptr != '\n')
+    ++Ptr;
+  if (Ptr == End || *Ptr == '\n')
+    return;
+
+  const DirectoryLookup *CurDir;
+  const FileEntry *Include = HS.LookupFile(
+      StringRef(NameStart, Ptr - NameStart), SourceLocation(), IsAngled,
+      /*FromDir=*/nullptr, CurDir, std::make_pair(File, File->getDir()),
+      /*SearchPath=*/nullptr, /*RelativePath=*/nullptr,
+      /*SuggestedModule=*/nullptr);
+  if (!Include)
+    return;
+
+  ModuleMap::KnownHeader Known = HS.findModuleForHeader(Include);
+  if (Known && !(Known.getRole() & ModuleMap::TextualHeader)) {
+    Module *M = Known.getModule()->getTopLevelModule();
+    if (M != Owner)
+      Imports.push_back(M);
+    return;
+  }
+
+  // The contents of textual and non-modular headers become part of the
+  // includer.
+  scanFile(Include, Owner, Imports);
+}
+
+#if LLVM_ENABLE_THREADS
+/// \brief Build the module of \p Job with a compiler instance that shares no
+/// state with the importing instance, so that it can run concurrently with
+/// other builds.
+static bool compileModuleInIsolation(ModuleBuildJob &Job,
+    std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+    vfs::FileSystem &VFS, ArrayRef<std::string> ModuleBuildStack) {
+  CompilerInstance Instance(PCHContainerOps, /*BuildingModule=*/true);
+  Instance.setInvocation(&*Job.Invocation);
+
+  // The diagnostics are stored now and replayed through the client of the
+  // importing instance once all the builds finished, on its thread.
+  Instance.createDiagnostics(new StoredDiagnosticCollector(Job.Diagnostics),
+                             /*ShouldOwnClient=*/true);
+  Job.Diags = &Instance.getDiagnostics();
+
+  Instance.setVirtualFileSystem(&VFS);
+  Instance.createFileManager();
+  Instance.createSourceManager(Instance.getFileManager());
+  SourceManager &SourceMgr = Instance.getSourceManager();
+  Job.FileMgr = &Instance.getFileManager();
+  Job.SourceMgr = &SourceMgr;
+  for (const std::string &Name : ModuleBuildStack)
+    SourceMgr.pushModuleBuildStack(Name, FullSourceLoc());
+  SourceMgr.pushModuleBuildStack(Job.TopLevel->Name, FullSourceLoc());
+
+  InputKind IK = getSourceInputKindFromOptions(*Job.Invocation->getLangOpts());
+  Job.Invocation->getFrontendOpts().Inputs.emplace_back(Job.ModuleMapPath, IK);
+  if (!Job.InferredModuleMap.empty()) {
+    const FileEntry *ModuleMapFile = Instance.getFileManager().getVirtualFile(
+        Job.ModuleMapPath, Job.InferredModuleMap.size(), 0);
+    SourceMgr.overrideFileContents(
+        ModuleMapFile,
+        llvm::MemoryBuffer::getMemBuffer(Job.InferredModuleMap));
+  }
+
+  const FileEntry *ModuleMapForUniquing = nullptr;
+  if (!Job.ModuleMapForUniquing.empty())
+    ModuleMapForUniquing =
+        Instance.getFileManager().getFile(Job.ModuleMapForUniquing);
+  GenerateModuleAction CreateModuleAction(ModuleMapForUniquing,
+                                          Job.TopLevel->IsSystem);
+
+  const unsigned ThreadStackSize = 8 << 20;
+  llvm::CrashRecoveryContext CRC;
+  CRC.RunSafelyOnThread([&]() { Instance.ExecuteAction(CreateModuleAction); },
+                        ThreadStackSize);
+  Instance.clearOutputFiles(/*EraseFiles=*/true);
+  return !Instance.getDiagnostics().hasErrorOccurred();
+}
+
+/// \brief Run the build of \p Job, unless another process is already
+/// building the same module file, in which case wait for it.
+static bool runModuleBuildJob(ModuleBuildJob &Job,
+    std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+    vfs::FileSystem &VFS, ArrayRef<std::string> ModuleBuildStack) {
+  llvm::sys::fs::create_directories(
+      llvm::sys::path::parent_path(Job.ModuleFileName));
+
+  while (1) {
+    llvm::LockFileManager Locked(Job.ModuleFileName);
+    switch (Locked) {
+    case llvm::LockFileManager::LFS_Error:
+      return false;
+
+    case llvm::LockFileManager::LFS_Owned:
+      return compileModuleInIsolation(Job, PCHContainerOps, VFS,
+                                      ModuleBuildStack);
+
+    case llvm::LockFileManager::LFS_Shared:
+      switch (Locked.waitForUnlock()) {
+      case llvm::LockFileManager::Res_Success:
+        return true;
+      case llvm::LockFileManager::Res_OwnerDied:
+        continue;
+      case llvm::LockFileManager::Res_Timeout:
+        return false;
+      }
+    }
+  }
+}
+#endif
+
+/// \brief Build \p Root and the modules it imports that are missing from the
+/// module cache, along with those imported by the main file, building the
+/// modules that do not depend on each other concurrently.
+///
+/// Returns true if \p Root was built. Modules whose builds fail or that are
+/// part of an import cycle are left for the importing instance to build on
+/// demand, which diagnoses the problem.
+static bool buildModulesConcurrently(CompilerInstance &ImportingInstance,
+                                     SourceLocation ImportLoc, Module *Root) {
+#if LLVM_ENABLE_THREADS
+  // Module dependency collection is not thread-safe.
+  if (ImportingInstance.getModuleDepCollector())
+    return false;
+
+  Preprocessor &PP = ImportingInstance.getPreprocessor();
+  HeaderSearch &HS = PP.getHeaderSearchInfo();
+  ModuleMap &ModMap = HS.getModuleMap();
+  SourceManager &SourceMgr = ImportingInstance.getSourceManager();
+
+  // The modules being built by the instances up the stack cannot be built
+  // again.
+  std::vector<std::string> ModuleBuildStack;
+  for (const auto &Entry : SourceMgr.getModuleBuildStack())
+    ModuleBuildStack.push_back(Entry.first);
+  if (!ImportingInstance.getLangOpts().CurrentModule.empty())
+    ModuleBuildStack.push_back(ImportingInstance.getLangOpts().CurrentModule);
+
+  std::vector<ModuleBuildJob> Jobs;
+  llvm::DenseMap<Module *, int> JobIndices;
+  auto getJob = [&](Module *M, bool Force) -> int {
+    auto Known = JobIndices.find(M);
+    if (Known != JobIndices.end())
+      return Known->second;
+
+    int Index = -1;
+    std::string ModuleFileName = HS.getModuleFileName(M);
+    if (!M->IsMissingRequirement &&
+        std::find(ModuleBuildStack.begin(), ModuleBuildStack.end(),
+                  M->Name) == ModuleBuildStack.end() &&
+        (Force || !llvm::sys::fs::exists(ModuleFileName))) {
+      Index = Jobs.size();
+      Jobs.emplace_back(M, ModuleFileName);
+    }
+    JobIndices[M] = Index;
+    return Index;
+  };
+
+  ModuleImportScanner Scanner(ImportingInstance);
+  SmallVector<Module *, 16> Imports;
+  int RootIndex = getJob(Root, /*Force=*/true);
+  if (RootIndex < 0)
+    return false;
+  if (ImportingInstance.getLangOpts().CurrentModule.empty()) {
+    Scanner.scanFile(SourceMgr.getFileEntryForID(SourceMgr.getMainFileID()),
+                     /*Owner=*/nullptr, Imports);
+    for (Module *M : Imports)
+      getJob(M, /*Force=*/false);
+  }
+
+  // Discover the dependency graph. New jobs are appended as they are found.
+  for (unsigned I = 0; I != Jobs.size(); ++I) {
+    Imports.clear();
+    Scanner.scanModule(Jobs[I].TopLevel, Imports);
+    llvm::SmallPtrSet<Module *, 16> Seen;
+    for (Module *M : Imports) {
+      if (!Seen.insert(M).second)
+        continue;
+      int Dep = getJob(M, /*Force=*/false);
+      if (Dep < 0 || unsigned(Dep) == I)
+        continue;
+      Jobs[Dep].Dependents.push_back(I);
+      ++Jobs[I].PendingDependencies;
+    }
+  }
+  // There is nothing to build concurrently.
+  if (Jobs.size() < 2)
+    return false;
+
+  // Set up the builds.
+  for (ModuleBuildJob &Job : Jobs) {
+    Job.Invocation = createModuleInvocation(ImportingInstance, Job.TopLevel,
+                                            Job.ModuleFileName);
+    // Failures are diagnosed by the importing instance when it builds the
+    // module again, so don't record them.
+    Job.Invocation->getPreprocessorOpts().FailedModules =
+        new PreprocessorOptions::FailedModulesSet;
+    Job.Invocation->getFrontendOpts().ModuleBuildJobs = 1;
+
+    if (const FileEntry *ModuleMapFile =
+            ModMap.getContainingModuleMapFile(Job.TopLevel)) {
+      Job.ModuleMapPath = ModuleMapFile->getName();
+    } else {
+      SmallString<128> FakeModuleMapFile(Job.TopLevel->Directory->getName());
+      llvm::sys::path::append(FakeModuleMapFile, "__inferred_module.map");
+      Job.ModuleMapPath = FakeModuleMapFile.str();
+      llvm::raw_string_ostream OS(Job.InferredModuleMap);
+      Job.TopLevel->print(OS);
+    }
+    if (const FileEntry *ModuleMapForUniquing =
+            ModMap.getModuleMapFileForUniquing(Job.TopLevel))
+      Job.ModuleMapForUniquing = ModuleMapForUniquing->getName();
+
+    ImportingInstance.getDiagnostics().Report(ImportLoc,
+                                              diag::remark_module_build)
+        << Job.TopLevel->Name << Job.ModuleFileName;
+  }
+
+  unsigned NumThreads = std::min<unsigned>(
+      ImportingInstance.getFrontendOpts().ModuleBuildJobs, Jobs.size());
+  ImportingInstance.getDiagnostics().Report(
+      ImportLoc, diag::remark_module_build_concurrent)
+      << unsigned(Jobs.size()) << NumThreads;
+
+  // Run the builds whose imports are available, until none are left or
+  // running.
+  std::mutex Mutex;
+  std::condition_variable Changed;
+  std::deque<unsigned> Ready;
+  unsigned Running = 0;
+  for (unsigned I = 0, E = Jobs.size(); I != E; ++I)
+    if (!Jobs[I].PendingDependencies)
+      Ready.push_back(I);
+
+  std::shared_ptr<PCHContainerOperations> PCHContainerOps =
+      ImportingInstance.getPCHContainerOperations();
+  vfs::FileSystem &VFS = ImportingInstance.getVirtualFileSystem();
+  auto Worker = [&]() {
+    std::unique_lock<std::mutex> Lock(Mutex);
+    while (1) {
+      Changed.wait(Lock, [&] { return !Ready.empty() || !Running; });
+      if (Ready.empty())
+        return;
+      unsigned Index = Ready.front();
+      Ready.pop_front();
+      ++Running;
+
+      Lock.unlock();
+      bool Succeeded = runModuleBuildJob(Jobs[Index], PCHContainerOps, VFS,
+                                         ModuleBuildStack);
+      Lock.lock();
+
+      --Running;
+      Jobs[Index].Succeeded = Succeeded;
+      // The modules importing a module that failed to build are not built.
+      if (Succeeded)
+        for (unsigned Dependent : Jobs[Index].Dependents)
+          if (!--Jobs[Dependent].PendingDependencies)
+            Ready.push_back(Dependent);
+      Changed.notify_all();
+    }
+  };
+  std::vector<std::thread> Threads;
+  for (unsigned I = 0; I != NumThreads; ++I)
+    Threads.emplace_back(Worker);
+  for (std::thread &Thread : Threads)
+    Thread.join();
+
+  bool BuiltAny = false;
+  for (ModuleBuildJob &Job : Jobs) {
+    if (!Job.Succeeded)
+      continue;
+    BuiltAny = true;
+    if (!Job.Diagnostics.empty()) {
+      Job.Diags->setClient(new ForwardingDiagnosticConsumer(
+                               ImportingInstance.getDiagnosticClient()),
+                           /*ShouldOwnClient=*/true);
+      for (const StoredDiagnostic &SD : Job.Diagnostics)
+        Job.Diags->Report(SD);
+    }
+    ImportingInstance.getDiagnostics().Report(ImportLoc,
+                                              diag::remark_module_build_done)
+        << Job.TopLevel->Name;
+  }
+
+  if (BuiltAny && ImportingInstance.getFrontendOpts().GenerateGlobalModuleIndex)
+    ImportingInstance.setBuildGlobalModuleIndex(true);
+  return Jobs[RootIndex].Succeeded;
+#else
+  return false;
+#endif
+}
+
 /// \brief Diagnose differences between the current definition of the given
 /// configuration macro and the definition provided on the command line.
 static void checkConfigMacro(Preprocessor &PP, StringRef ConfigMacro,
@@ -1488,9 +1948,21 @@ CompilerInstance::loadModule(SourceLocation ImportLoc,
         return ModuleLoadResult();
       }
 
+      // With several build jobs, first build the module along with the
+      // modules it imports concurrently.
+      bool Loaded = false;
+      if (getFrontendOpts().ModuleBuildJobs > 1 &&
+          buildModulesConcurrently(*this, ModuleNameLoc, Module))
+        Loaded = ModuleManager->ReadAST(ModuleFileName,
+                                        serialization::MK_ImplicitModule,
+                                        ImportLoc,
+                                        ASTReader::ARR_OutOfDate |
+                                            ASTReader::ARR_Missing) ==
+                 ASTReader::Success;
+
       // Try to compile and then load the module.
-      if (!compileAndLoadModule(*this, ImportLoc, ModuleNameLoc, Module,
-                                ModuleFileName)) {
+      if (!Loaded && !compileAndLoadModule(*this, ImportLoc, ModuleNameLoc,
+                                           Module, ModuleFileName)) {
         assert(getDiagnostics().hasErrorOccurred() &&
                "undiagnosed error in compileAndLoadModule");
         if (getPreprocessorOpts().FailedModules)
@@ -1677,6 +2149,7 @@ GlobalModuleIndex *CompilerInstance::loadGlobalModuleIndex(
   // we need to make the global index cover all modules, so we do that here.
   if (!HaveFullGlobalModuleIndex && GlobalIndex && !buildingModule()) {
     ModuleMap &MMap = getPreprocessor().getHeaderSearchInfo().getModuleMap();
+    MMap.loadAllLazyModuleMaps();
     bool RecreateIndex = false;
     for (ModuleMap::module_iterator I = MMap.module_begin(),
         E = MMap.module_end(); I != E; ++I) {
@@ -497,6 +497,20 @@ static bool ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args, InputKind IK,
     Diags.Report(diag::err_drv_invalid_value)
         << Args.getLastArg(OPT_mthread_model)->getAsString(Args)
         << Opts.ThreadModel;
+  if (Arg *A = Args.getLastArg(OPT_fcodegen_partition_EQ)) {
+    std::pair<StringRef, StringRef> IndexAndCount =
+        StringRef(A->getValue()).split('/');
+    unsigned Index, Count;
+    if (IndexAndCount.first.getAsInteger(10, Index) ||
+        IndexAndCount.second.getAsInteger(10, Count) || Count == 0 ||
+        Count > 0xffff || Index >= Count) {
+      Diags.Report(diag::err_drv_invalid_value) << A->getAsString(Args)
+                                                << A->getValue();
+    } else {
+      Opts.CodeGenPartitionCount = Count;
+      Opts.CodeGenPartitionIndex = Index;
+    }
+  }
   Opts.TrapFuncName = Args.getLastArgValue(OPT_ftrap_function_EQ);
   Opts.UseInitArray = Args.hasArg(OPT_fuse_init_array);
 
@@ -804,6 +818,8 @@ bool clang::ParseDiagnosticArgs(DiagnosticOptions &Opts, ArgList &Args,
   Opts.SpellCheckingLimit = getLastArgIntValue(
       Args, OPT_fspell_checking_limit,
       DiagnosticOptions::DefaultSpellCheckingLimit, Diags);
+  Opts.SpellCheckingWorkLimit = getLastArgIntValue(
+      Args, OPT_fspell_checking_work_limit, 0, Diags);
   Opts.TabStop = getLastArgIntValue(Args, OPT_ftabstop,
                                     DiagnosticOptions::DefaultTabStop, Diags);
   if (Opts.TabStop == 0 || Opts.TabStop > DiagnosticOptions::MaxTabStop) {
@@ -956,6 +972,13 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
 
   Opts.OverrideRecordLayoutsFile
     = Args.getLastArgValue(OPT_foverride_record_layout_EQ);
+  Opts.CompilationCachePath = Args.getLastArgValue(OPT_fcompilation_cache_path);
+  Opts.CompilationCacheSize =
+      getLastArgIntValue(Args, OPT_fcompilation_cache_size, 5120, Diags);
+  Opts.CompilationCacheDirect =
+      !Args.hasArg(OPT_fno_compilation_cache_direct);
+  Opts.ModuleBuildJobs =
+      getLastArgIntValue(Args, OPT_fmodules_build_jobs_EQ, 1, Diags);
   if (const Arg *A = Args.getLastArg(OPT_arcmt_check,
                                      OPT_arcmt_modify,
                                      OPT_arcmt_migrate)) {
@@ -1113,6 +1136,7 @@ static void ParseHeaderSearchArgs(HeaderSearchOptions &Opts, ArgList &Args) {
       getLastArgUInt64Value(Args, OPT_fbuild_session_timestamp, 0);
   Opts.ModulesValidateSystemHeaders =
       Args.hasArg(OPT_fmodules_validate_system_headers);
+  Opts.LazyModuleMaps = Args.hasArg(OPT_fmodules_lazy_module_maps);
   if (const Arg *A = Args.getLastArg(OPT_fmodule_format_EQ))
     Opts.ModuleFormat = A->getValue();
 
@@ -1559,6 +1583,8 @@ static void ParseLangArgs(LangOptions &Opts, ArgList &Args, InputKind IK,
       getLastArgIntValue(Args, OPT_fconstexpr_steps, 1048576, Diags);
   Opts.BracketDepth = getLastArgIntValue(Args, OPT_fbracket_depth, 256, Diags);
   Opts.DelayedTemplateParsing = Args.hasArg(OPT_fdelayed_template_parsing);
+  Opts.DelayedHeaderFunctionParsing =
+      Opts.CPlusPlus && Args.hasArg(OPT_fdelayed_header_function_parsing);
   Opts.NumLargeByValueCopy =
       getLastArgIntValue(Args, OPT_Wlarge_by_value_copy_EQ, 0, Diags);
   Opts.MSBitfields = Args.hasArg(OPT_mms_bitfields);
@@ -1579,6 +1605,7 @@ static void ParseLangArgs(LangOptions &Opts, ArgList &Args, InputKind IK,
                         || Args.hasArg(OPT_fdump_record_layouts);
   Opts.DumpVTableLayouts = Args.hasArg(OPT_fdump_vtable_layouts);
   Opts.SpellChecking = !Args.hasArg(OPT_fno_spell_checking);
+  Opts.CacheUnqualifiedLookup = Args.hasArg(OPT_fcache_unqualified_lookup);
   Opts.NoBitFieldTypeAlign = Args.hasArg(OPT_fno_bitfield_type_align);
   Opts.SinglePrecisionConstants = Args.hasArg(OPT_cl_single_precision_constant);
   Opts.FastRelaxedMath = Args.hasArg(OPT_cl_fast_relaxed_math);
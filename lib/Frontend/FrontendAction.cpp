@@ -447,6 +447,10 @@ bool FrontendAction::Execute() {
         CI.getPreprocessor().getHeaderSearchInfo().getModuleCachePath());
   }
 
+  // Record the module map files summarized by this compilation.
+  if (CI.hasPreprocessor())
+    CI.getPreprocessor().getHeaderSearchInfo().writeModuleMapIndex();
+
   return true;
 }
 
@@ -20,6 +20,7 @@
 #include "clang/Lex/HeaderSearchOptions.h"
 #include "clang/Lex/LexDiagnostic.h"
 #include "clang/Lex/Lexer.h"
+#include "clang/Lex/ModuleMapIndex.h"
 #include "clang/Lex/Preprocessor.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/Hashing.h"
@@ -96,6 +97,12 @@ void HeaderSearch::PrintStats() {
 
   fprintf(stderr, "%d framework lookups.\n", NumFrameworkLookups);
   fprintf(stderr, "%d subframework lookups.\n", NumSubFrameworkLookups);
+
+  if (ModMap.getNumLazyModuleMaps())
+    fprintf(stderr, "%u of %u lazy module map files parsed.\n",
+            ModMap.getNumParsedLazyModuleMaps(), ModMap.getNumLazyModuleMaps());
+  if (ModMapIndex)
+    ModMapIndex->printStats();
 }
 
 /// CreateHeaderMap - This method returns a HeaderMap for the specified
@@ -1192,7 +1199,7 @@ bool HeaderSearch::loadModuleMapFile(const FileEntry *File, bool IsSystem) {
 
 HeaderSearch::LoadModuleMapResult
 HeaderSearch::loadModuleMapFileImpl(const FileEntry *File, bool IsSystem,
-                                    const DirectoryEntry *Dir) {
+                                    const DirectoryEntry *Dir, bool Lazy) {
   assert(File && "expected FileEntry");
 
   // Check whether we've already loaded this module map, and mark it as being
@@ -1201,6 +1208,25 @@ HeaderSearch::loadModuleMapFileImpl(const FileEntry *File, bool IsSystem,
   if (!AddResult.second)
     return AddResult.first->second ? LMM_AlreadyLoaded : LMM_InvalidModuleMap;
 
+  // If the module map file (and its private module map file) only describe
+  // modules and headers by name, defer parsing them until one of those is
+  // looked up. Errors in the module map file are then only diagnosed if it
+  // is used.
+  if (Lazy) {
+    ModuleMapIndex &Index = getModuleMapIndex();
+    const FileEntry *PMMFile = getPrivateModuleMap(File, FileMgr);
+    const ModuleMapSummary *Summary = Index.getSummary(File, FileMgr);
+    const ModuleMapSummary *PrivateSummary =
+        PMMFile ? Index.getSummary(PMMFile, FileMgr) : nullptr;
+    if (Summary && !Summary->Eager &&
+        (!PMMFile || (PrivateSummary && !PrivateSummary->Eager))) {
+      ModMap.addLazyModuleMapFile(File, IsSystem, Dir, *Summary);
+      if (PMMFile)
+        ModMap.addLazyModuleMapFile(PMMFile, IsSystem, Dir, *PrivateSummary);
+      return LMM_NewlyLoaded;
+    }
+  }
+
   if (ModMap.parseModuleMapFile(File, IsSystem, Dir)) {
     LoadedModuleMaps[File] = false;
     return LMM_InvalidModuleMap;
@@ -1280,8 +1306,8 @@ HeaderSearch::loadModuleMapFile(const DirectoryEntry *Dir, bool IsSystem,
     return KnownDir->second ? LMM_AlreadyLoaded : LMM_InvalidModuleMap;
 
   if (const FileEntry *ModuleMapFile = lookupModuleMapFile(Dir, IsFramework)) {
-    LoadModuleMapResult Result =
-        loadModuleMapFileImpl(ModuleMapFile, IsSystem, Dir);
+    LoadModuleMapResult Result = loadModuleMapFileImpl(
+        ModuleMapFile, IsSystem, Dir, HSOpts->LazyModuleMaps);
     // Add Dir explicitly in case ModuleMapFile is in a subdirectory.
     // E.g. Foo.framework/Modules/module.modulemap
     //      ^Dir                  ^ModuleMapFile
@@ -1340,6 +1366,7 @@ void HeaderSearch::collectAllModules(SmallVectorImpl<Module *> &Modules) {
   }
 
   // Populate the list of modules.
+  ModMap.loadAllLazyModuleMaps();
   for (ModuleMap::module_iterator M = ModMap.module_begin(), 
                                MEnd = ModMap.module_end();
        M != MEnd; ++M) {
@@ -1365,6 +1392,26 @@ void HeaderSearch::loadTopLevelSystemModules() {
   }
 }
 
+ModuleMapIndex &HeaderSearch::getModuleMapIndex() {
+  if (!ModMapIndex) {
+    ModMapIndex.reset(new ModuleMapIndex());
+    // The summaries do not depend on the configuration, so they are stored
+    // at the root of the module cache.
+    if (!HSOpts->ModuleCachePath.empty())
+      ModMapIndex->load(HSOpts->ModuleCachePath);
+  }
+  return *ModMapIndex;
+}
+
+void HeaderSearch::writeModuleMapIndex() {
+  if (!ModMapIndex || !ModMapIndex->isDirty() ||
+      HSOpts->ModuleCachePath.empty())
+    return;
+
+  llvm::sys::fs::create_directories(HSOpts->ModuleCachePath);
+  ModMapIndex->write(HSOpts->ModuleCachePath);
+}
+
 void HeaderSearch::loadSubdirectoryModuleMaps(DirectoryLookup &SearchDir) {
   assert(HSOpts->ImplicitModuleMaps &&
          "Should not be loading subdirectory module maps");
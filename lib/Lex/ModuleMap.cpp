@@ -23,6 +23,7 @@
 #include "clang/Lex/LexDiagnostic.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/LiteralSupport.h"
+#include "clang/Lex/ModuleMapIndex.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/Allocator.h"
@@ -89,7 +90,8 @@ ModuleMap::ModuleMap(SourceManager &SourceMgr, DiagnosticsEngine &Diags,
                      HeaderSearch &HeaderInfo)
     : SourceMgr(SourceMgr), Diags(Diags), LangOpts(LangOpts), Target(Target),
       HeaderInfo(HeaderInfo), BuiltinIncludeDir(nullptr),
-      CompilingModule(nullptr), SourceModule(nullptr), NumCreatedModules(0) {
+      CompilingModule(nullptr), SourceModule(nullptr), NumCreatedModules(0),
+      NumUnparsedLazyModuleMaps(0) {
   MMapLangOpts.LineComment = true;
 }
 
@@ -162,8 +164,73 @@ static bool isBuiltinHeader(StringRef FileName) {
            .Default(false);
 }
 
+void ModuleMap::loadLazyModuleMap(unsigned Idx) {
+  if (LazyModuleMaps[Idx].Parsed)
+    return;
+
+  // Copy the entry, since parsing may register more lazy module maps.
+  LazyModuleMap Lazy = LazyModuleMaps[Idx];
+  LazyModuleMaps[Idx].Parsed = true;
+  --NumUnparsedLazyModuleMaps;
+  parseModuleMapFile(Lazy.File, Lazy.IsSystem, Lazy.HomeDir);
+}
+
+void ModuleMap::loadLazyModuleMaps(const LazyModuleMapIndexMap &Map,
+                                   StringRef Key) {
+  LazyModuleMapIndexMap::const_iterator Known = Map.find(Key);
+  if (Known == Map.end())
+    return;
+
+  // Parsing may register more lazy module maps, which invalidates Known.
+  SmallVector<unsigned, 1> Indices(Known->second.begin(),
+                                   Known->second.end());
+  for (unsigned Idx : Indices)
+    loadLazyModuleMap(Idx);
+}
+
+void ModuleMap::loadLazyModuleMapsForHeader(const FileEntry *File) {
+  if (!NumUnparsedLazyModuleMaps)
+    return;
+
+  loadLazyModuleMaps(LazyModuleMapsByHeader,
+                     llvm::sys::path::filename(File->getName()));
+
+  // Module maps with an umbrella may describe any header below their
+  // directory.
+  if (LazyModuleMapsByDirectory.empty())
+    return;
+  StringRef DirName =
+      SourceMgr.getFileManager().getCanonicalName(File->getDir());
+  for (; !DirName.empty(); DirName = llvm::sys::path::parent_path(DirName))
+    loadLazyModuleMaps(LazyModuleMapsByDirectory, DirName);
+}
+
+void ModuleMap::addLazyModuleMapFile(const FileEntry *File, bool IsSystem,
+                                     const DirectoryEntry *HomeDir,
+                                     const ModuleMapSummary &Summary) {
+  assert(!Summary.Eager && "module map file cannot be loaded lazily");
+  unsigned Idx = LazyModuleMaps.size();
+  LazyModuleMap Lazy = { File, HomeDir, IsSystem, /*Parsed=*/false };
+  LazyModuleMaps.push_back(Lazy);
+  ++NumUnparsedLazyModuleMaps;
+
+  for (const std::string &Name : Summary.ModuleNames)
+    LazyModuleMapsByModule[Name].push_back(Idx);
+  for (const std::string &Name : Summary.HeaderNames)
+    LazyModuleMapsByHeader[Name].push_back(Idx);
+  if (Summary.CoversDirectory)
+    LazyModuleMapsByDirectory[
+        SourceMgr.getFileManager().getCanonicalName(HomeDir)].push_back(Idx);
+}
+
+void ModuleMap::loadAllLazyModuleMaps() {
+  for (unsigned Idx = 0; NumUnparsedLazyModuleMaps; ++Idx)
+    loadLazyModuleMap(Idx);
+}
+
 ModuleMap::HeadersMap::iterator
 ModuleMap::findKnownHeader(const FileEntry *File) {
+  loadLazyModuleMapsForHeader(File);
   HeadersMap::iterator Known = Headers.find(File);
   if (HeaderInfo.getHeaderSearchOpts().ImplicitModuleMaps &&
       Known == Headers.end() && File->getDir() == BuiltinIncludeDir &&
@@ -438,6 +505,10 @@ bool ModuleMap::isHeaderInUnavailableModule(const FileEntry *Header) const {
 bool
 ModuleMap::isHeaderUnavailableInModule(const FileEntry *Header,
                                        const Module *RequestingModule) const {
+  // Parsing a lazy module map file only adds to the module map, so it is
+  // fine to do from a const lookup.
+  const_cast<ModuleMap *>(this)->loadLazyModuleMapsForHeader(Header);
+
   HeadersMap::const_iterator Known = Headers.find(Header);
   if (Known != Headers.end()) {
     for (SmallVectorImpl<KnownHeader>::const_iterator
@@ -522,6 +593,17 @@ Module *ModuleMap::findModule(StringRef Name) const {
   if (Known != Modules.end())
     return Known->getValue();
 
+  if (NumUnparsedLazyModuleMaps) {
+    // Parse the lazy module map files that describe this module, if any.
+    // This only adds to the module map, so it is fine to do from a const
+    // lookup.
+    const_cast<ModuleMap *>(this)->loadLazyModuleMaps(LazyModuleMapsByModule,
+                                                      Name);
+    Known = Modules.find(Name);
+    if (Known != Modules.end())
+      return Known->getValue();
+  }
+
   return nullptr;
 }
 
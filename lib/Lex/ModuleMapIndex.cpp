@@ -0,0 +1,430 @@
+//===--- ModuleMapIndex.cpp - Index of module map files -------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the ModuleMapIndex class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/ModuleMapIndex.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/LangOptions.h"
+#include "clang/Lex/Lexer.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/LockFileManager.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/OnDiskHashTable.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cstdio>
+#include <cstring>
+
+using namespace clang;
+
+const char *const ModuleMapIndex::IndexFileName = "modulemap.index";
+
+/// \brief The signature at the start of a module map index file.
+static const char IndexSignature[4] = { 'C', 'M', 'M', 'I' };
+
+/// \brief The module map index file version.
+static const unsigned CurrentVersion = 2;
+
+/// \brief The size of the header of an index file: the signature, the
+/// version and the offset of the buckets of the hash table.
+static const unsigned IndexHeaderSize = 12;
+
+namespace {
+
+/// \brief Trait used to read the module map index from the on-disk hash
+/// table.
+class ModuleMapIndexReaderTrait {
+public:
+  typedef StringRef external_key_type;
+  typedef StringRef internal_key_type;
+  typedef ModuleMapSummary data_type;
+  typedef unsigned hash_value_type;
+  typedef unsigned offset_type;
+
+  static bool EqualKey(const internal_key_type& a, const internal_key_type& b) {
+    return a == b;
+  }
+
+  static hash_value_type ComputeHash(const internal_key_type& a) {
+    return llvm::HashString(a);
+  }
+
+  static std::pair<unsigned, unsigned>
+  ReadKeyDataLength(const unsigned char*& d) {
+    using namespace llvm::support;
+    unsigned KeyLen = endian::readNext<uint16_t, little, unaligned>(d);
+    unsigned DataLen = endian::readNext<uint32_t, little, unaligned>(d);
+    return std::make_pair(KeyLen, DataLen);
+  }
+
+  static const internal_key_type&
+  GetInternalKey(const external_key_type& x) { return x; }
+
+  static const external_key_type&
+  GetExternalKey(const internal_key_type& x) { return x; }
+
+  static internal_key_type ReadKey(const unsigned char* d, unsigned n) {
+    return StringRef((const char *)d, n);
+  }
+
+  static void readNames(const unsigned char *&d,
+                        std::vector<std::string> &Names) {
+    using namespace llvm::support;
+    unsigned Count = endian::readNext<uint32_t, little, unaligned>(d);
+    Names.reserve(Count);
+    for (unsigned I = 0; I != Count; ++I) {
+      unsigned Len = endian::readNext<uint16_t, little, unaligned>(d);
+      Names.push_back(std::string((const char *)d, Len));
+      d += Len;
+    }
+  }
+
+  static data_type ReadData(const internal_key_type& k,
+                            const unsigned char* d,
+                            unsigned DataLen) {
+    using namespace llvm::support;
+
+    data_type Result;
+    Result.Size = endian::readNext<uint64_t, little, unaligned>(d);
+    Result.ModTime = endian::readNext<uint64_t, little, unaligned>(d);
+    unsigned Flags = *d++;
+    Result.Eager = Flags & 0x01;
+    Result.CoversDirectory = Flags & 0x02;
+    readNames(d, Result.ModuleNames);
+    readNames(d, Result.HeaderNames);
+    return Result;
+  }
+};
+
+typedef llvm::OnDiskIterableChainedHashTable<ModuleMapIndexReaderTrait>
+    ModuleMapIndexTable;
+
+/// \brief Trait used to generate the module map index as an on-disk hash
+/// table.
+class ModuleMapIndexWriterTrait {
+public:
+  typedef StringRef key_type;
+  typedef StringRef key_type_ref;
+  typedef ModuleMapSummary data_type;
+  typedef const ModuleMapSummary &data_type_ref;
+  typedef unsigned hash_value_type;
+  typedef unsigned offset_type;
+
+  static hash_value_type ComputeHash(key_type_ref Key) {
+    return llvm::HashString(Key);
+  }
+
+  static unsigned getNamesLength(const std::vector<std::string> &Names) {
+    unsigned Len = 4;
+    for (const std::string &Name : Names)
+      Len += 2 + Name.size();
+    return Len;
+  }
+
+  std::pair<unsigned,unsigned>
+  EmitKeyDataLength(raw_ostream& Out, key_type_ref Key, data_type_ref Data) {
+    using namespace llvm::support;
+    endian::Writer<little> LE(Out);
+    unsigned KeyLen = Key.size();
+    unsigned DataLen = 8 + 8 + 1 + getNamesLength(Data.ModuleNames) +
+                       getNamesLength(Data.HeaderNames);
+    LE.write<uint16_t>(KeyLen);
+    LE.write<uint32_t>(DataLen);
+    return std::make_pair(KeyLen, DataLen);
+  }
+
+  void EmitKey(raw_ostream& Out, key_type_ref Key, unsigned KeyLen) {
+    Out.write(Key.data(), KeyLen);
+  }
+
+  static void emitNames(raw_ostream &Out,
+                        const std::vector<std::string> &Names) {
+    using namespace llvm::support;
+    endian::Writer<little> LE(Out);
+    LE.write<uint32_t>(Names.size());
+    for (const std::string &Name : Names) {
+      LE.write<uint16_t>(Name.size());
+      Out.write(Name.data(), Name.size());
+    }
+  }
+
+  void EmitData(raw_ostream& Out, key_type_ref Key, data_type_ref Data,
+                unsigned DataLen) {
+    using namespace llvm::support;
+    endian::Writer<little> LE(Out);
+    LE.write<uint64_t>(Data.Size);
+    LE.write<uint64_t>(Data.ModTime);
+    LE.write<uint8_t>((Data.Eager ? 0x01 : 0) |
+                      (Data.CoversDirectory ? 0x02 : 0));
+    emitNames(Out, Data.ModuleNames);
+    emitNames(Out, Data.HeaderNames);
+  }
+};
+
+}
+
+ModuleMapIndex::ModuleMapIndex()
+    : Table(nullptr), Dirty(false), NumIndexHits(0), NumScans(0) {}
+
+ModuleMapIndex::~ModuleMapIndex() {
+  delete static_cast<ModuleMapIndexTable *>(Table);
+}
+
+void ModuleMapIndex::load(StringRef Directory) {
+  assert(!Table && "index already loaded");
+
+  SmallString<128> IndexPath(Directory);
+  llvm::sys::path::append(IndexPath, IndexFileName);
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> BufferOrErr =
+      llvm::MemoryBuffer::getFile(IndexPath, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (!BufferOrErr)
+    return;
+
+  // Check the signature and version; an index we cannot read will be
+  // replaced when this compilation writes its own.
+  StringRef Data = (*BufferOrErr)->getBuffer();
+  if (Data.size() < IndexHeaderSize + 4 ||
+      memcmp(Data.data(), IndexSignature, sizeof(IndexSignature)) != 0)
+    return;
+
+  using namespace llvm::support;
+  const unsigned char *Ptr =
+      (const unsigned char *)Data.data() + sizeof(IndexSignature);
+  unsigned Version = endian::readNext<uint32_t, little, unaligned>(Ptr);
+  uint32_t BucketOffset = endian::readNext<uint32_t, little, unaligned>(Ptr);
+  if (Version != CurrentVersion || BucketOffset == 0 ||
+      BucketOffset >= Data.size() - IndexHeaderSize)
+    return;
+
+  Buffer = std::move(*BufferOrErr);
+  const unsigned char *Base =
+      (const unsigned char *)Buffer->getBufferStart() + IndexHeaderSize;
+  Table = ModuleMapIndexTable::Create(Base + BucketOffset,
+                                      Base + sizeof(uint32_t), Base);
+}
+
+bool ModuleMapIndex::lookupInTable(StringRef Path,
+                                   ModuleMapSummary &Summary) const {
+  if (!Table)
+    return false;
+
+  ModuleMapIndexTable &T = *static_cast<ModuleMapIndexTable *>(Table);
+  ModuleMapIndexTable::iterator Known = T.find(Path);
+  if (Known == T.end())
+    return false;
+
+  Summary = *Known;
+  return true;
+}
+
+const ModuleMapSummary *
+ModuleMapIndex::getSummary(const FileEntry *File, FileManager &FileMgr) {
+  StringRef Path = File->getName();
+  llvm::StringMap<ModuleMapSummary>::iterator Known = Summaries.find(Path);
+  if (Known != Summaries.end())
+    return &Known->second;
+
+  uint64_t Size = File->getSize();
+  uint64_t ModTime = File->getModificationTime();
+
+  ModuleMapSummary Summary;
+  if (lookupInTable(Path, Summary) && Summary.Size == Size &&
+      Summary.ModTime == ModTime) {
+    ++NumIndexHits;
+    return &(Summaries[Path] = std::move(Summary));
+  }
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Contents =
+      FileMgr.getBufferForFile(File);
+  if (!Contents)
+    return nullptr;
+
+  Summary = ModuleMapSummary();
+  summarize(**Contents, Summary);
+  Summary.Size = Size;
+  Summary.ModTime = ModTime;
+  ++NumScans;
+  Dirty = true;
+  return &(Summaries[Path] = std::move(Summary));
+}
+
+void ModuleMapIndex::summarize(const llvm::MemoryBuffer &Contents,
+                               ModuleMapSummary &Summary) {
+  // Module maps are lexed with the C lexer, as in ModuleMapParser. We only
+  // need to recognize the few constructs that name modules and headers, so
+  // the raw lexer is enough. The summary only has to be conservative: a
+  // header name that matches too much just parses the module map early.
+  LangOptions LangOpts;
+  Lexer L(SourceLocation(), LangOpts, Contents.getBufferStart(),
+          Contents.getBufferStart(), Contents.getBufferEnd());
+
+  llvm::StringSet<> SeenModules, SeenHeaders;
+  unsigned Depth = 0;
+  StringRef Prev;
+  Token Tok;
+  do {
+    L.LexFromRawLexer(Tok);
+    StringRef Keyword;
+    switch (Tok.getKind()) {
+    case tok::raw_identifier: {
+      StringRef Id = Tok.getRawIdentifier();
+      if (Depth == 0 && Prev == "module") {
+        if (SeenModules.insert(Id).second)
+          Summary.ModuleNames.push_back(Id.str());
+      } else if (Depth == 0 && Id == "extern") {
+        // 'extern module' loads another module map file.
+        Summary.Eager = true;
+      } else if (Id == "header" && Prev == "umbrella") {
+        Summary.CoversDirectory = true;
+      }
+      Keyword = Id;
+      break;
+    }
+
+    case tok::star:
+      // 'framework module *' infers modules from a directory.
+      if (Depth == 0 && Prev == "module")
+        Summary.Eager = true;
+      break;
+
+    case tok::string_literal: {
+      StringRef Str(Tok.getLiteralData(), Tok.getLength());
+      if (Str.size() < 2)
+        break;
+      Str = Str.slice(1, Str.size() - 1);
+      if (Depth == 0 && Prev == "module") {
+        // A quoted module name. Names with escape sequences would have to be
+        // unescaped like ModuleMapParser does, so just parse those maps.
+        if (Str.find('\\') != StringRef::npos)
+          Summary.Eager = true;
+        else if (SeenModules.insert(Str).second)
+          Summary.ModuleNames.push_back(Str.str());
+      } else if (Prev == "header") {
+        StringRef Name = llvm::sys::path::filename(Str);
+        if (SeenHeaders.insert(Name).second)
+          Summary.HeaderNames.push_back(Name.str());
+      } else if (Prev == "umbrella") {
+        // An umbrella directory.
+        Summary.CoversDirectory = true;
+      }
+      break;
+    }
+
+    case tok::l_brace:
+      ++Depth;
+      break;
+
+    case tok::r_brace:
+      if (Depth)
+        --Depth;
+      break;
+
+    default:
+      break;
+    }
+    Prev = Keyword;
+  } while (Tok.isNot(tok::eof));
+}
+
+bool ModuleMapIndex::write(StringRef Directory) {
+  SmallString<128> IndexPath(Directory);
+  llvm::sys::path::append(IndexPath, IndexFileName);
+
+  // Coordinate writing the index file with other processes that might try to
+  // do the same.
+  llvm::LockFileManager Locked(IndexPath);
+  switch (Locked) {
+  case llvm::LockFileManager::LFS_Error:
+    return true;
+
+  case llvm::LockFileManager::LFS_Owned:
+    break;
+
+  case llvm::LockFileManager::LFS_Shared:
+    // Someone else is writing the index; our summaries will be recorded by
+    // a later compilation.
+    return false;
+  }
+
+  llvm::OnDiskChainedHashTableGenerator<ModuleMapIndexWriterTrait> Generator;
+  ModuleMapIndexWriterTrait Trait;
+
+  // Keep the summaries of the module map files this compilation did not use.
+  if (Table) {
+    ModuleMapIndexTable &T = *static_cast<ModuleMapIndexTable *>(Table);
+    for (ModuleMapIndexTable::key_iterator K = T.key_begin(),
+                                           KEnd = T.key_end();
+         K != KEnd; ++K) {
+      if (!Summaries.count(*K))
+        Generator.insert(*K, *T.find(*K), Trait);
+    }
+  }
+  for (llvm::StringMap<ModuleMapSummary>::iterator S = Summaries.begin(),
+                                                   SEnd = Summaries.end();
+       S != SEnd; ++S)
+    Generator.insert(S->first(), S->second, Trait);
+
+  // Create the on-disk hash table in a buffer.
+  SmallString<4096> TableData;
+  uint32_t BucketOffset;
+  {
+    using namespace llvm::support;
+    llvm::raw_svector_ostream Out(TableData);
+    // Make sure that no bucket is at offset 0
+    endian::Writer<little>(Out).write<uint32_t>(0);
+    BucketOffset = Generator.Emit(Out, Trait);
+  }
+
+  // Write the index to a temporary file.
+  llvm::SmallString<128> IndexTmpPath;
+  int TmpFD;
+  if (llvm::sys::fs::createUniqueFile(IndexPath + "-%%%%%%%%", TmpFD,
+                                      IndexTmpPath))
+    return true;
+
+  {
+    using namespace llvm::support;
+    llvm::raw_fd_ostream Out(TmpFD, true);
+    Out.write(IndexSignature, sizeof(IndexSignature));
+    endian::Writer<little> LE(Out);
+    LE.write<uint32_t>(CurrentVersion);
+    LE.write<uint32_t>(BucketOffset);
+    Out.write(TableData.data(), TableData.size());
+    Out.close();
+    if (Out.has_error()) {
+      Out.clear_error();
+      llvm::sys::fs::remove(IndexTmpPath);
+      return true;
+    }
+  }
+
+  // Rename the newly-written index file to the proper name.
+  if (llvm::sys::fs::rename(IndexTmpPath, IndexPath)) {
+    llvm::sys::fs::remove(IndexTmpPath);
+    return true;
+  }
+
+  Dirty = false;
+  return false;
+}
+
+void ModuleMapIndex::printStats() const {
+  std::fprintf(stderr, "*** Module Map Index Statistics:\n");
+  std::fprintf(stderr, "  %u module map summaries read from the index\n",
+               NumIndexHits);
+  std::fprintf(stderr, "  %u module map files lexed\n", NumScans);
+}
@@ -1363,6 +1363,9 @@ static bool EvaluateHasIncludeCommon(Token &Tok,
       PP.LookupFile(FilenameLoc, Filename, isAngled, LookupFrom, LookupFromFile,
                     CurDir, nullptr, nullptr, nullptr);
 
+  if (PPCallbacks *Callbacks = PP.getPPCallbacks())
+    Callbacks->HasInclude(FilenameLoc, Filename, isAngled, File);
+
   // Get the result value.  A result of true means the file exists.
   return File != nullptr;
 }
@@ -153,6 +153,7 @@ void clang::ParseAST(Sema &S, bool PrintStats, bool SkipFunctionBodies) {
   std::swap(OldCollectStats, S.CollectStats);
   if (PrintStats) {
     llvm::errs() << "\nSTATISTICS:\n";
+    P.PrintStats();
     P.getActions().PrintStats();
     S.getASTContext().PrintStats();
     Decl::PrintStats();
@@ -101,7 +101,10 @@ NamedDecl *Parser::ParseCXXInlineMethodDef(AccessSpecifier AS,
   // In delayed template parsing mode, if we are within a class template
   // or if we are about to parse function member template then consume
   // the tokens and store them for parsing at the end of the translation unit.
-  if (getLangOpts().DelayedTemplateParsing &&
+  // In delayed header function parsing mode, do the same for the members of
+  // the class templates and the member templates defined in headers.
+  if ((getLangOpts().DelayedTemplateParsing ||
+       isDelayableHeaderFunctionBody()) &&
       D.getFunctionDefinitionKind() == FDK_Definition &&
       !D.getDeclSpec().isConstexprSpecified() &&
       !(FnD && FnD->getAsFunction() &&
@@ -2199,6 +2199,8 @@ void Parser::ParseCXXClassMemberDeclaration(AccessSpecifier AS,
                                             AttributeList *AccessAttrs,
                                        const ParsedTemplateInfo &TemplateInfo,
                                        ParsingDeclRAIIObject *TemplateDiags) {
+  FunctionDeclaratorResults.clear();
+
   if (Tok.is(tok::at)) {
     if (getLangOpts().ObjC1 && NextToken().isObjCAtKeyword(tok::objc_defs))
       Diag(Tok, diag::err_at_defs_cxx);
@@ -100,6 +100,9 @@ Parser::ParseStatementOrDeclaration(StmtVector &Stmts, bool OnlyStatement,
 
   ParenBraceBracketBalancer BalancerRAIIObj(*this);
 
+  // Disambiguations are only reused within a statement.
+  FunctionDeclaratorResults.clear();
+
   ParsedAttributesWithRange Attrs(AttrFactory);
   MaybeParseCXX11Attributes(Attrs, nullptr, /*MightBeObjCMessageSend*/ true);
 
@@ -1372,6 +1372,7 @@ void Parser::ParseLateTemplatedFuncDef(LateParsedTemplate &LPT) {
 
   if (Tok.is(tok::kw_try)) {
     ParseFunctionTryBlock(LPT.D, FnScope);
+    Actions.UnmarkAsLateParsedTemplate(FunD);
   } else {
     if (Tok.is(tok::colon))
       ParseConstructorInitializer(LPT.D);
@@ -126,6 +126,7 @@ bool Parser::isCXXSimpleDeclaration(bool AllowForRangeDecl) {
   // or an identifier which doesn't resolve as anything. We need tentative
   // parsing...
 
+  ++NumDisambiguations;
   TentativeParsingAction PA(*this);
   TPR = TryParseSimpleDeclaration(AllowForRangeDecl);
   PA.Revert();
@@ -354,6 +355,7 @@ bool Parser::isCXXConditionDeclaration() {
   // Ok, we have a simple-type-specifier/typename-specifier followed by a '('.
   // We need tentative parsing...
 
+  ++NumDisambiguations;
   TentativeParsingAction PA(*this);
 
   // type-specifier-seq
@@ -423,6 +425,7 @@ bool Parser::isCXXTypeId(TentativeCXXTypeIdContext Context, bool &isAmbiguous) {
   // Ok, we have a simple-type-specifier/typename-specifier followed by a '('.
   // We need tentative parsing...
 
+  ++NumDisambiguations;
   TentativeParsingAction PA(*this);
 
   // type-specifier-seq
@@ -1591,6 +1594,22 @@ bool Parser::isCXXFunctionDeclarator(bool *IsAmbiguous) {
   // ambiguities mentioned in 6.8, the resolution is to consider any construct
   // that could possibly be a declaration a declaration.
 
+  // The declarator may already have been disambiguated in this statement,
+  // e.g., while deciding whether the statement is a declaration.
+  std::pair<unsigned, unsigned> Key(Tok.getLocation().getRawEncoding(),
+                                    GreaterThanIsOperator);
+  ++NumFunctionDeclaratorLookups;
+  llvm::DenseMap<std::pair<unsigned, unsigned>, unsigned>::iterator Known =
+      FunctionDeclaratorResults.find(Key);
+  if (Known != FunctionDeclaratorResults.end()) {
+    ++NumFunctionDeclaratorHits;
+    TPResult TPR = static_cast<TPResult>(Known->second);
+    if (IsAmbiguous && TPR == TPResult::Ambiguous)
+      *IsAmbiguous = true;
+    return TPR != TPResult::False;
+  }
+
+  ++NumDisambiguations;
   TentativeParsingAction PA(*this);
 
   ConsumeParen();
@@ -1617,6 +1636,8 @@ bool Parser::isCXXFunctionDeclarator(bool *IsAmbiguous) {
 
   PA.Revert();
 
+  FunctionDeclaratorResults[Key] = static_cast<unsigned>(TPR);
+
   if (IsAmbiguous && TPR == TPResult::Ambiguous)
     *IsAmbiguous = true;
 
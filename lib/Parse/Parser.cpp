@@ -72,7 +72,8 @@ Parser::Parser(Preprocessor &pp, Sema &actions, bool skipFunctionBodies)
   : PP(pp), Actions(actions), Diags(PP.getDiagnostics()),
     GreaterThanIsOperator(true), ColonIsSacred(false), 
     InMessageExpression(false), TemplateParameterDepth(0),
-    ParsingInObjCContainer(false) {
+    NumDisambiguations(0), NumFunctionDeclaratorLookups(0),
+    NumFunctionDeclaratorHits(0), ParsingInObjCContainer(false) {
   SkipFunctionBodies = pp.isCodeCompletionEnabled() || skipFunctionBodies;
   Tok.startToken();
   Tok.setKind(tok::eof);
@@ -91,6 +92,17 @@ Parser::Parser(Preprocessor &pp, Sema &actions, bool skipFunctionBodies)
   PP.setCodeCompletionHandler(*this);
 }
 
+void Parser::PrintStats() const {
+  llvm::errs() << "\n*** Parser Stats:\n";
+  llvm::errs() << NumDisambiguations
+               << " ambiguities resolved by tentative parsing\n";
+  llvm::errs() << NumFunctionDeclaratorLookups
+               << " function declarator disambiguations, "
+               << NumFunctionDeclaratorHits << " reused from the cache\n";
+  llvm::errs() << PP.getNumBacktrackedTokens()
+               << " tokens lexed again after backtracking\n";
+}
+
 DiagnosticBuilder Parser::Diag(SourceLocation Loc, unsigned DiagID) {
   return Diags.Report(Loc, DiagID);
 }
@@ -434,7 +446,8 @@ Parser::~Parser() {
 
   PP.clearCodeCompletionHandler();
 
-  if (getLangOpts().DelayedTemplateParsing &&
+  if ((getLangOpts().DelayedTemplateParsing ||
+       getLangOpts().DelayedHeaderFunctionParsing) &&
       !PP.isIncrementalProcessingEnabled() && !TemplateIds.empty()) {
     // If an ASTConsumer parsed delay-parsed templates in their
     // HandleTranslationUnit() method, TemplateIds created there were not
@@ -567,7 +580,8 @@ bool Parser::ParseTopLevelDecl(DeclGroupPtrTy &Result) {
 
   case tok::eof:
     // Late template parsing can begin.
-    if (getLangOpts().DelayedTemplateParsing)
+    if (getLangOpts().DelayedTemplateParsing ||
+        getLangOpts().DelayedHeaderFunctionParsing)
       Actions.SetLateTemplateParser(LateTemplateParserCallback,
                                     PP.isIncrementalProcessingEnabled() ?
                                     LateTemplateParserCleanupCallback : nullptr,
@@ -617,6 +631,7 @@ Parser::ParseExternalDeclaration(ParsedAttributesWithRange &attrs,
                                  ParsingDeclSpec *DS) {
   DestroyTemplateIdAnnotationsRAIIObj CleanupRAII(TemplateIds);
   ParenBraceBracketBalancer BalancerRAIIObj(*this);
+  FunctionDeclaratorResults.clear();
 
   if (PP.isCodeCompletionReached()) {
     cutOffParsing();
@@ -939,6 +954,27 @@ Parser::ParseDeclarationOrFunctionDefinition(ParsedAttributesWithRange &attrs,
   }
 }
 
+/// \brief Determine whether the body of the function definition starting at
+/// the current token can be skipped and only parsed if the function is
+/// instantiated, in delayed header function parsing mode.
+///
+/// Only the bodies of templates are delayed; the caller checks that the
+/// function is one. A delayed non-template body could only be parsed at the
+/// end of the translation unit, where it would find the declarations that
+/// follow it. Function bodies in the main file are always parsed, so that
+/// their diagnostics are not lost.
+bool Parser::isDelayableHeaderFunctionBody() {
+  if (!getLangOpts().DelayedHeaderFunctionParsing ||
+      Actions.TUKind != TU_Complete || PP.isIncrementalProcessingEnabled() ||
+      PP.isCodeCompletionEnabled() ||
+      Actions.CurContext->isFunctionOrMethod() ||
+      cast<Decl>(Actions.CurContext)->getParentFunctionOrMethod())
+    return false;
+
+  SourceManager &SM = PP.getSourceManager();
+  return !SM.isInMainFile(SM.getExpansionLoc(Tok.getLocation()));
+}
+
 /// ParseFunctionDefinition - We parsed and verified that the specified
 /// Declarator is well formed.  If this is a K&R-style function, read the
 /// parameters declaration-list, then start the compound-statement.
@@ -1012,7 +1048,12 @@ Decl *Parser::ParseFunctionDefinition(ParsingDeclarator &D,
 
   // In delayed template parsing mode, for function template we consume the
   // tokens and store them for late parsing at the end of the translation unit.
-  if (getLangOpts().DelayedTemplateParsing && Tok.isNot(tok::equal) &&
+  // In delayed header function parsing mode, we do the same for the function
+  // templates defined in headers, which are only parsed if they are
+  // instantiated.
+  if ((getLangOpts().DelayedTemplateParsing ||
+       isDelayableHeaderFunctionBody()) &&
+      Tok.isNot(tok::equal) &&
       TemplateInfo.Kind == ParsedTemplateInfo::Template &&
       Actions.canDelayFunctionBody(D)) {
     MultiTemplateParamsArg TemplateParameterLists(*TemplateInfo.TemplateParams);
@@ -104,13 +104,17 @@ Sema::Sema(Preprocessor &pp, ASTContext &ctxt, ASTConsumer &consumer,
     AccessCheckingSFINAE(false), InNonInstantiationSFINAEContext(false),
     NonInstantiationEntries(0), ArgumentPackSubstitutionIndex(-1),
     CurrentInstantiationScope(nullptr), DisableTypoCorrection(false),
-    TyposCorrected(0), AnalysisWarnings(*this), ThreadSafetyDeclCache(nullptr),
+    TyposCorrected(0), TypoCorrectionWork(0), AnalysisWarnings(*this),
+    ThreadSafetyDeclCache(nullptr),
     VarDataSharingAttributesStack(nullptr), CurScope(nullptr),
     Ident_super(nullptr), Ident___float128(nullptr)
 {
   TUScope = nullptr;
 
   LoadedExternalKnownNamespaces = false;
+  UnqualifiedLookupCacheDeclGeneration = 0;
+  UnqualifiedLookupCacheResolverGeneration = 0;
+  UnqualifiedLookupCacheExternalGeneration = 0;
   for (unsigned I = 0; I != NSAPI::NumNSNumberLiteralMethods; ++I)
     NSNumberLiteralMethods[I] = nullptr;
 
@@ -329,6 +333,11 @@ void Sema::addExternalSource(ExternalSemaSource *E) {
 void Sema::PrintStats() const {
   llvm::errs() << "\n*** Semantic Analysis Stats:\n";
   llvm::errs() << NumSFINAEErrors << " SFINAE diagnostics trapped.\n";
+  llvm::errs() << TyposCorrected << " typo corrections attempted, "
+               << TypoCorrectionWork << " candidate edit distances computed.\n";
+  if (TypoIndex)
+    TypoIndex->PrintStats();
+  LookupStats.print();
 
   BumpAlloc.PrintStats();
   AnalysisWarnings.PrintStats();
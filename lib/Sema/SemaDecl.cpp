@@ -1589,6 +1589,9 @@ static void CheckPoppedLabel(LabelDecl *L, Sema &S) {
 void Sema::ActOnPopScope(SourceLocation Loc, Scope *S) {
   S->mergeNRVOIntoParent();
 
+  // The Scope object may be reused for an unrelated scope.
+  flushUnqualifiedLookupCache();
+
   if (S->decl_empty()) return;
   assert((S->getFlags() & (Scope::DeclScope | Scope::TemplateParamScope)) &&
          "Scope shouldn't contain decls!");
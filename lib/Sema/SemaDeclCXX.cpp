@@ -7635,10 +7635,13 @@ void Sema::PushUsingDirective(Scope *S, UsingDirectiveDecl *UDir) {
   DeclContext *Ctx = S->getEntity();
   if (Ctx && !Ctx->isFunctionOrMethod())
     Ctx->addDecl(UDir);
-  else
+  else {
     // Otherwise, it is at block scope. The using-directives will affect lookup
-    // only to the end of the scope.
+    // only to the end of the scope. This does not declare anything, so the
+    // lookups cached for this scope have to be discarded explicitly.
     S->PushUsingDirective(UDir);
+    flushUnqualifiedLookupCache();
+  }
 }
 
 
@@ -43,6 +43,8 @@
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/ADT/edit_distance.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <iterator>
 #include <limits>
@@ -679,14 +681,18 @@ static bool LookupDirect(Sema &S, LookupResult &R, const DeclContext *DC) {
 
   // Perform lookup into this declaration context.
   DeclContext::lookup_result DR = DC->lookup(R.getLookupName());
+  unsigned NumResults = 0;
   for (DeclContext::lookup_iterator I = DR.begin(), E = DR.end(); I != E;
        ++I) {
     NamedDecl *D = *I;
+    ++NumResults;
     if ((D = R.getAcceptableDecl(D))) {
       R.addDecl(D);
       Found = true;
     }
   }
+  if (S.CollectStats)
+    S.LookupStats.recordContextLookup(DC, NumResults);
 
   if (!Found && DC->isTranslationUnit() && LookupBuiltin(S, R))
     return true;
@@ -1166,6 +1172,128 @@ bool Sema::CppLookupName(LookupResult &R, Scope *S) {
   return !R.empty();
 }
 
+Sema::LookupStatistics::LookupStatistics()
+    : NumUnqualifiedLookups(0), NumUnqualifiedCacheHits(0),
+      NumUnqualifiedCacheFlushes(0) {
+  std::fill(std::begin(NumContextLookups), std::end(NumContextLookups), 0);
+  std::fill(std::begin(NumContextResults), std::end(NumContextResults), 0);
+  std::fill(std::begin(ContextKindNames), std::end(ContextKindNames), nullptr);
+}
+
+void Sema::LookupStatistics::recordContextLookup(const DeclContext *DC,
+                                                 unsigned NumResults) {
+  unsigned Kind = DC->getDeclKind();
+  if (!ContextKindNames[Kind])
+    ContextKindNames[Kind] = DC->getDeclKindName();
+  ++NumContextLookups[Kind];
+  NumContextResults[Kind] += NumResults;
+}
+
+void Sema::LookupStatistics::print() const {
+  llvm::errs() << NumUnqualifiedLookups << " C++ unqualified lookups, "
+               << NumUnqualifiedCacheHits << " answered from cache, "
+               << NumUnqualifiedCacheFlushes << " cache flushes.\n";
+  llvm::errs() << "  Direct lookups by context kind:\n";
+  for (unsigned Kind = 0; Kind != Decl::lastDecl + 1; ++Kind) {
+    if (!NumContextLookups[Kind])
+      continue;
+    llvm::errs() << "    " << NumContextLookups[Kind] << " "
+                 << ContextKindNames[Kind] << " lookups, "
+                 << NumContextResults[Kind] << " declarations found\n";
+  }
+}
+
+void Sema::flushUnqualifiedLookupCache() {
+  if (UnqualifiedLookupCache.empty())
+    return;
+  ++LookupStats.NumUnqualifiedCacheFlushes;
+  UnqualifiedLookupCache.clear();
+}
+
+bool Sema::canCacheUnqualifiedLookup(const LookupResult &R, Scope *S) const {
+  if (!getLangOpts().CacheUnqualifiedLookup || !S)
+    return false;
+
+  // Module visibility can change without any declaration being added.
+  if (getLangOpts().Modules)
+    return false;
+
+  // Only memoize within function bodies, where the same names tend to be
+  // looked up again and again from the same scope.
+  if (FunctionScopes.size() <= 1 || !ActiveTemplateInstantiations.empty())
+    return false;
+
+  // Lookup of these names implicitly declares special members.
+  return !isImplicitlyDeclaredMemberFunctionName(R.getLookupName());
+}
+
+/// \brief Flush the unqualified lookup cache if any declaration has been
+/// added or removed since it was last validated.
+///
+/// \returns true if the cache was still valid.
+bool Sema::validateUnqualifiedLookupCache() {
+  uint32_t ExternalGeneration =
+      Context.getExternalSource() ? Context.getExternalSource()->getGeneration()
+                                  : 0;
+  if (UnqualifiedLookupCacheDeclGeneration == Context.DeclContextGeneration &&
+      UnqualifiedLookupCacheResolverGeneration == IdResolver.getGeneration() &&
+      UnqualifiedLookupCacheExternalGeneration == ExternalGeneration)
+    return true;
+
+  flushUnqualifiedLookupCache();
+  UnqualifiedLookupCacheDeclGeneration = Context.DeclContextGeneration;
+  UnqualifiedLookupCacheResolverGeneration = IdResolver.getGeneration();
+  UnqualifiedLookupCacheExternalGeneration = ExternalGeneration;
+  return false;
+}
+
+const Sema::CachedUnqualifiedLookup *
+Sema::findCachedUnqualifiedLookup(const LookupResult &R, Scope *S) {
+  if (!validateUnqualifiedLookupCache())
+    return nullptr;
+
+  UnqualifiedLookupCacheMap::iterator Pos = UnqualifiedLookupCache.find(
+      std::make_pair(S, R.getLookupName().getAsOpaquePtr()));
+  if (Pos == UnqualifiedLookupCache.end())
+    return nullptr;
+
+  for (const CachedUnqualifiedLookup &Entry : Pos->second)
+    if (Entry.LookupKind == (unsigned)R.getLookupKind() &&
+        Entry.IDNS == R.getIdentifierNamespace() &&
+        Entry.ScopeFlags == S->getFlags() &&
+        Entry.Redecl == R.isForRedeclaration() &&
+        Entry.AllowHidden == R.isHiddenDeclarationVisible())
+      return &Entry;
+  return nullptr;
+}
+
+void Sema::cacheUnqualifiedLookup(const LookupResult &R, Scope *S,
+                                  bool Found) {
+  // Ambiguities carry base paths, and results that depend on the current
+  // instantiation are recomputed when it is complete.
+  if (R.isAmbiguous() || R.wasNotFoundInCurrentInstantiation())
+    return;
+
+  // The lookup itself may have declared something (e.g., a builtin); the
+  // result reflects that, so only entries computed earlier are stale.
+  validateUnqualifiedLookupCache();
+
+  CachedUnqualifiedLookup Entry;
+  Entry.LookupKind = R.getLookupKind();
+  Entry.IDNS = R.getIdentifierNamespace();
+  Entry.ScopeFlags = S->getFlags();
+  Entry.Redecl = R.isForRedeclaration();
+  Entry.AllowHidden = R.isHiddenDeclarationVisible();
+  Entry.Found = Found;
+  Entry.Shadowed = R.isShadowed();
+  Entry.NamingClass = R.getNamingClass();
+  for (LookupResult::iterator I = R.begin(), E = R.end(); I != E; ++I)
+    Entry.Decls.push_back(std::make_pair(*I, I.getAccess()));
+
+  UnqualifiedLookupCache[std::make_pair(S, R.getLookupName().getAsOpaquePtr())]
+      .push_back(std::move(Entry));
+}
+
 /// \brief Find the declaration that a class temploid member specialization was
 /// instantiated from, or the member itself if it is an explicit specialization.
 static Decl *getInstantiatedFrom(Decl *D, MemberSpecializationInfo *MSInfo) {
@@ -1550,8 +1678,30 @@ bool Sema::LookupName(LookupResult &R, Scope *S, bool AllowBuiltinCreation) {
         return true;
       }
   } else {
-    // Perform C++ unqualified name lookup.
-    if (CppLookupName(R, S))
+    // Perform C++ unqualified name lookup, reusing the result of an earlier
+    // identical lookup from the same scope if it is still valid.
+    ++LookupStats.NumUnqualifiedLookups;
+    bool UseCache = canCacheUnqualifiedLookup(R, S);
+    bool Found;
+    if (const CachedUnqualifiedLookup *Cached =
+            UseCache ? findCachedUnqualifiedLookup(R, S) : nullptr) {
+      ++LookupStats.NumUnqualifiedCacheHits;
+      for (const auto &D : Cached->Decls)
+        R.addDecl(D.first, D.second);
+      if (!Cached->Decls.empty())
+        R.resolveKind();
+      if (Cached->NamingClass)
+        R.setNamingClass(Cached->NamingClass);
+      if (Cached->Shadowed)
+        R.setShadowed();
+      Found = Cached->Found;
+    } else {
+      Found = CppLookupName(R, S);
+      if (UseCache)
+        cacheUnqualifiedLookup(R, S, Found);
+    }
+
+    if (Found)
       return true;
   }
 
@@ -3589,6 +3739,139 @@ static void getNestedNameSpecifierIdentifiers(
     Identifiers.push_back(II);
 }
 
+uint64_t TypoCorrectionIndex::getSignature(StringRef Name) {
+  // Identifier characters map onto distinct bits; everything else shares the
+  // last one, which only weakens (never invalidates) the distance bound.
+  uint64_t Signature = 0;
+  for (char C : Name) {
+    unsigned Bit;
+    if (C >= 'a' && C <= 'z')
+      Bit = C - 'a';
+    else if (C >= 'A' && C <= 'Z')
+      Bit = 26 + (C - 'A');
+    else if (C >= '0' && C <= '9')
+      Bit = 52 + (C - '0');
+    else if (C == '_')
+      Bit = 62;
+    else
+      Bit = 63;
+    Signature |= uint64_t(1) << Bit;
+  }
+  return Signature;
+}
+
+void TypoCorrectionIndex::addName(BucketList &Buckets, StringRef Name) {
+  if (Name.empty())
+    return;
+  if (Buckets.size() <= Name.size())
+    Buckets.resize(Name.size() + 1);
+  Entry E = { Name, getSignature(Name) };
+  Buckets[Name.size()].push_back(E);
+}
+
+TypoCorrectionIndex::~TypoCorrectionIndex() {
+  if (!LocalBuckets.empty())
+    Context.Idents.setCreatedIdentifiersList(nullptr);
+}
+
+void TypoCorrectionIndex::updateLocal() {
+  if (LocalBuckets.empty()) {
+    // Index the whole identifier table once, then have it record the
+    // identifiers created later so that they can be added incrementally.
+    ++NumLocalBuilds;
+    LocalBuckets.resize(1);
+    for (const auto &I : Context.Idents)
+      addName(LocalBuckets, I.getKey());
+    Context.Idents.setCreatedIdentifiersList(&NewLocalIdents);
+    return;
+  }
+
+  if (NewLocalIdents.empty())
+    return;
+
+  ++NumLocalUpdates;
+  for (IdentifierInfo *II : NewLocalIdents)
+    addName(LocalBuckets, II->getName());
+  NewLocalIdents.clear();
+}
+
+void TypoCorrectionIndex::updateExternal() {
+  IdentifierInfoLookup *External = Context.Idents.getExternalIdentifierLookup();
+  if (!External)
+    return;
+
+  // Loading a new AST file bumps the external source's generation.
+  ExternalASTSource *Source = Context.getExternalSource();
+  uint32_t Generation = Source ? Source->getGeneration() : 0;
+  if (HasExternalIndex && IndexedExternalGeneration == Generation)
+    return;
+
+  ++NumExternalBuilds;
+  ExternalBuckets.clear();
+  ExternalNameAlloc.Reset();
+  std::unique_ptr<IdentifierIterator> Iter(External->getIdentifiers());
+  do {
+    StringRef Name = Iter->Next();
+    if (Name.empty())
+      break;
+
+    char *Mem = ExternalNameAlloc.Allocate<char>(Name.size());
+    std::copy(Name.begin(), Name.end(), Mem);
+    addName(ExternalBuckets, StringRef(Mem, Name.size()));
+  } while (true);
+  HasExternalIndex = true;
+  IndexedExternalGeneration = Generation;
+}
+
+void TypoCorrectionIndex::scanBuckets(const BucketList &Buckets,
+                                      StringRef Typo,
+                                      SmallVectorImpl<StringRef> &Candidates) {
+  // Mirror the bounds applied by TypoCorrectionConsumer::addName: the length
+  // difference must be at most a third of the typo's length, and the edit
+  // distance must be below UpperBound.
+  unsigned TypoLen = Typo.size();
+  unsigned MaxLenDiff = TypoLen / 3;
+  unsigned UpperBound = (TypoLen + 2) / 3 + 1;
+  uint64_t TypoSig = getSignature(Typo);
+
+  unsigned MinLen = TypoLen - MaxLenDiff;
+  unsigned MaxLen = std::min<unsigned>(TypoLen + MaxLenDiff,
+                                       Buckets.size() ? Buckets.size() - 1 : 0);
+  for (unsigned Len = MinLen; Len <= MaxLen; ++Len) {
+    for (const Entry &E : Buckets[Len]) {
+      ++NumNamesScanned;
+      // Every character class present in only one of the two names requires
+      // at least one distinct edit.
+      unsigned Missing = llvm::countPopulation(TypoSig & ~E.Signature);
+      unsigned Extra = llvm::countPopulation(E.Signature & ~TypoSig);
+      if (std::max(Missing, Extra) >= UpperBound)
+        continue;
+      Candidates.push_back(E.Name);
+    }
+  }
+}
+
+void TypoCorrectionIndex::findCandidates(
+    StringRef Typo, SmallVectorImpl<StringRef> &Candidates) {
+  ++NumQueries;
+  updateLocal();
+  updateExternal();
+
+  unsigned Before = Candidates.size();
+  scanBuckets(LocalBuckets, Typo, Candidates);
+  scanBuckets(ExternalBuckets, Typo, Candidates);
+  NumCandidatesReturned += Candidates.size() - Before;
+}
+
+void TypoCorrectionIndex::PrintStats() const {
+  llvm::errs() << "  Typo correction index: " << NumQueries << " queries, "
+               << NumLocalBuilds << " local builds, " << NumLocalUpdates
+               << " local updates, " << NumExternalBuilds
+               << " external builds\n";
+  llvm::errs() << "    " << NumNamesScanned << " names scanned, "
+               << NumCandidatesReturned << " candidates returned\n";
+}
+
 void TypoCorrectionConsumer::FoundDecl(NamedDecl *ND, NamedDecl *Hiding,
                                        DeclContext *Ctx, bool InBaseClass) {
   // Don't consider hidden names for typo correction.
@@ -3635,6 +3918,7 @@ void TypoCorrectionConsumer::addName(StringRef Name, NamedDecl *ND,
   // Compute an upper bound on the allowable edit distance, so that the
   // edit-distance algorithm can short-circuit.
   unsigned UpperBound = (TypoStr.size() + 2) / 3 + 1;
+  ++SemaRef.TypoCorrectionWork;
   unsigned ED = TypoStr.edit_distance(Name, true, UpperBound);
   if (ED >= UpperBound) return;
 
@@ -4254,6 +4538,10 @@ std::unique_ptr<TypoCorrectionConsumer> Sema::makeTypoCorrectionConsumer(
   unsigned Limit = getDiagnostics().getDiagnosticOptions().SpellCheckingLimit;
   if (Limit && TyposCorrected >= Limit)
     return nullptr;
+  unsigned WorkLimit =
+      getDiagnostics().getDiagnosticOptions().SpellCheckingWorkLimit;
+  if (WorkLimit && TypoCorrectionWork >= WorkLimit)
+    return nullptr;
   ++TyposCorrected;
 
   // If we're handling a missing symbol error, using modules, and the
@@ -4299,24 +4587,16 @@ std::unique_ptr<TypoCorrectionConsumer> Sema::makeTypoCorrectionConsumer(
 
   if (IsUnqualifiedLookup || SearchNamespaces) {
     // For unqualified lookup, look through all of the names that we have
-    // seen in this translation unit.
-    // FIXME: Re-add the ability to skip very unlikely potential corrections.
-    for (const auto &I : Context.Idents)
-      Consumer->FoundName(I.getKey());
-
-    // Walk through identifiers in external identifier sources.
-    // FIXME: Re-add the ability to skip very unlikely potential corrections.
-    if (IdentifierInfoLookup *External
-                            = Context.Idents.getExternalIdentifierLookup()) {
-      std::unique_ptr<IdentifierIterator> Iter(External->getIdentifiers());
-      do {
-        StringRef Name = Iter->Next();
-        if (Name.empty())
-          break;
-
-        Consumer->FoundName(Name);
-      } while (true);
-    }
+    // seen in this translation unit, including those in external identifier
+    // sources. The index discards names that cannot be within the edit
+    // distance bound without computing their edit distance.
+    if (!TypoIndex)
+      TypoIndex.reset(new TypoCorrectionIndex(Context));
+
+    SmallVector<StringRef, 32> Candidates;
+    TypoIndex->findCandidates(Typo->getName(), Candidates);
+    for (StringRef Name : Candidates)
+      Consumer->FoundName(Name);
   }
 
   AddKeywordsToConsumer(*this, *Consumer, S, CCCRef, SS && SS->isNotEmpty());
@@ -5865,6 +5865,7 @@ void ASTReader::CompleteRedeclChain(const Decl *D) {
     return;
   }
 
+  ++NumRedeclChainsCompleted;
   const DeclContext *DC = D->getDeclContext()->getRedeclContext();
 
   // If this is a named declaration, complete it by looking it up
@@ -6684,6 +6685,20 @@ void ASTReader::PrintStats() {
                  ((float)NumMethodPoolTableHits/NumMethodPoolTableLookups
                   * 100.0));
   }
+  if (NumMethodPoolUpToDateLookups) {
+    std::fprintf(stderr,
+                 "  %u/%u method pool lookups needed no module file search "
+                 "(%f%%)\n",
+                 NumMethodPoolUpToDateLookups, NumMethodPoolLookups,
+                 ((float)NumMethodPoolUpToDateLookups/NumMethodPoolLookups
+                  * 100.0));
+  }
+  if (NumMethodPoolMethodsRead)
+    std::fprintf(stderr, "  %u methods read from method pools\n",
+                 NumMethodPoolMethodsRead);
+  if (NumRedeclChainsCompleted)
+    std::fprintf(stderr, "  %u redeclaration chains completed\n",
+                 NumRedeclChainsCompleted);
 
   if (NumIdentifierLookupHits) {
     std::fprintf(stderr,
@@ -6944,6 +6959,8 @@ namespace clang { namespace serialization {
       
       This->InstanceMethods.append(Data.Instance.begin(), Data.Instance.end());
       This->FactoryMethods.append(Data.Factory.begin(), Data.Factory.end());
+      This->Reader.NumMethodPoolMethodsRead +=
+          Data.Instance.size() + Data.Factory.size();
       This->InstanceBits = Data.InstanceBits;
       This->FactoryBits = Data.FactoryBits;
       This->InstanceHasMoreThanOneDecl = Data.InstanceHasMoreThanOneDecl;
@@ -6986,8 +7003,26 @@ void ASTReader::ReadMethodPool(Selector Sel) {
   
   // Search for methods defined with this selector.
   ++NumMethodPoolLookups;
+
+  // If no module file was loaded since this selector was last looked up, the
+  // global method pool already has all of its methods.
+  if (PriorGeneration == Generation) {
+    ++NumMethodPoolUpToDateLookups;
+    return;
+  }
+
+  // If there is a global index, look there first to determine which modules
+  // provably do not have any methods with this selector.
+  GlobalModuleIndex::HitSet Hits;
+  GlobalModuleIndex::HitSet *HitsPtr = nullptr;
+  if (!loadGlobalIndex()) {
+    if (GlobalIndex->lookupSelector(Sel, Hits)) {
+      HitsPtr = &Hits;
+    }
+  }
+
   ReadMethodPoolVisitor Visitor(*this, Sel, PriorGeneration);
-  ModuleMgr.visit(&ReadMethodPoolVisitor::visit, &Visitor);
+  ModuleMgr.visit(&ReadMethodPoolVisitor::visit, &Visitor, HitsPtr);
   
   if (Visitor.getInstanceMethods().empty() &&
       Visitor.getFactoryMethods().empty())
@@ -8480,9 +8515,11 @@ ASTReader::ASTReader(Preprocessor &PP, ASTContext &Context,
       NumIdentifierLookupHits(0), NumSelectorsRead(0),
       NumMethodPoolEntriesRead(0), NumMethodPoolLookups(0),
       NumMethodPoolHits(0), NumMethodPoolTableLookups(0),
-      NumMethodPoolTableHits(0), TotalNumMethodPoolEntries(0),
+      NumMethodPoolTableHits(0), NumMethodPoolUpToDateLookups(0),
+      NumMethodPoolMethodsRead(0), TotalNumMethodPoolEntries(0),
       NumLexicalDeclContextsRead(0), TotalLexicalDeclContexts(0),
       NumVisibleDeclContextsRead(0), TotalVisibleDeclContexts(0),
+      NumRedeclChainsCompleted(0),
       TotalModulesSizeInBits(0), NumCurrentElementsDeserializing(0),
       PassingDeclsToConsumer(false), ReadingKind(Read_None) {
   SourceMgr.setExternalSLocEntrySource(this);
@@ -11,6 +11,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "ASTCommon.h"
 #include "ASTReaderInternals.h"
 #include "clang/Frontend/PCHContainerOperations.h"
 #include "clang/Basic/FileManager.h"
@@ -30,6 +31,7 @@
 #include "llvm/Support/OnDiskHashTable.h"
 #include "llvm/Support/Path.h"
 #include <cstdio>
+#include <map>
 using namespace clang;
 using namespace serialization;
 
@@ -50,7 +52,9 @@ namespace {
     /// \brief Describes a module, including its file name and dependencies.
     MODULE,
     /// \brief The index for identifiers.
-    IDENTIFIER_INDEX
+    IDENTIFIER_INDEX,
+    /// \brief The index for selectors in the global method pools.
+    SELECTOR_INDEX
   };
 }
 
@@ -58,7 +62,7 @@ namespace {
 static const char * const IndexFileName = "modules.idx";
 
 /// \brief The global index file version.
-static const unsigned CurrentVersion = 1;
+static const unsigned CurrentVersion = 2;
 
 //----------------------------------------------------------------------------//
 // Global module index reader.
@@ -121,12 +125,56 @@ public:
 typedef llvm::OnDiskIterableChainedHashTable<IdentifierIndexReaderTrait>
     IdentifierIndexTable;
 
+/// \brief Trait used to read the selector index from the on-disk hash table.
+///
+/// The selector index is keyed by the hash of each selector, as computed by
+/// serialization::ComputeHash(), which can be computed from the method pool
+/// of a module file without resolving the identifiers of its selectors.
+class SelectorIndexReaderTrait {
+public:
+  typedef unsigned external_key_type;
+  typedef unsigned internal_key_type;
+  typedef SmallVector<unsigned, 2> data_type;
+  typedef unsigned hash_value_type;
+  typedef unsigned offset_type;
+
+  static bool EqualKey(internal_key_type a, internal_key_type b) {
+    return a == b;
+  }
+
+  static hash_value_type ComputeHash(internal_key_type a) { return a; }
+
+  static std::pair<unsigned, unsigned>
+  ReadKeyDataLength(const unsigned char*& d) {
+    using namespace llvm::support;
+    unsigned DataLen = endian::readNext<uint16_t, little, unaligned>(d);
+    return std::make_pair(4u, DataLen);
+  }
+
+  static internal_key_type GetInternalKey(external_key_type x) { return x; }
+
+  static internal_key_type ReadKey(const unsigned char* d, unsigned) {
+    using namespace llvm::support;
+    return endian::readNext<uint32_t, little, unaligned>(d);
+  }
+
+  static data_type ReadData(internal_key_type k,
+                            const unsigned char* d,
+                            unsigned DataLen) {
+    return IdentifierIndexReaderTrait::ReadData(StringRef(), d, DataLen);
+  }
+};
+
+typedef llvm::OnDiskChainedHashTable<SelectorIndexReaderTrait>
+    SelectorIndexTable;
+
 }
 
 GlobalModuleIndex::GlobalModuleIndex(std::unique_ptr<llvm::MemoryBuffer> Buffer,
                                      llvm::BitstreamCursor Cursor)
-    : Buffer(std::move(Buffer)), IdentifierIndex(), NumIdentifierLookups(),
-      NumIdentifierLookupHits() {
+    : Buffer(std::move(Buffer)), IdentifierIndex(), SelectorIndex(),
+      NumIdentifierLookups(), NumIdentifierLookupHits(),
+      NumSelectorLookups(), NumSelectorLookupHits() {
   // Read the global index.
   bool InGlobalIndexBlock = false;
   bool Done = false;
@@ -224,12 +272,22 @@ GlobalModuleIndex::GlobalModuleIndex(std::unique_ptr<llvm::MemoryBuffer> Buffer,
             (const unsigned char *)Blob.data(), IdentifierIndexReaderTrait());
       }
       break;
+
+    case SELECTOR_INDEX:
+      // Wire up the selector index.
+      if (Record[0]) {
+        SelectorIndex = SelectorIndexTable::Create(
+            (const unsigned char *)Blob.data() + Record[0],
+            (const unsigned char *)Blob.data(), SelectorIndexReaderTrait());
+      }
+      break;
     }
   }
 }
 
 GlobalModuleIndex::~GlobalModuleIndex() {
   delete static_cast<IdentifierIndexTable *>(IdentifierIndex);
+  delete static_cast<SelectorIndexTable *>(SelectorIndex);
 }
 
 std::pair<GlobalModuleIndex *, GlobalModuleIndex::ErrorCode>
@@ -317,6 +375,31 @@ bool GlobalModuleIndex::lookupIdentifier(StringRef Name, HitSet &Hits) {
   return true;
 }
 
+bool GlobalModuleIndex::lookupSelector(Selector Sel, HitSet &Hits) {
+  Hits.clear();
+
+  // If there's no selector index, there is nothing we can do.
+  if (!SelectorIndex)
+    return false;
+
+  // Look into the selector index.
+  ++NumSelectorLookups;
+  SelectorIndexTable &Table = *static_cast<SelectorIndexTable *>(SelectorIndex);
+  SelectorIndexTable::iterator Known =
+      Table.find(serialization::ComputeHash(Sel));
+  if (Known == Table.end())
+    return true;
+
+  SmallVector<unsigned, 2> ModuleIDs = *Known;
+  for (unsigned I = 0, N = ModuleIDs.size(); I != N; ++I) {
+    if (ModuleFile *MF = Modules[ModuleIDs[I]].File)
+      Hits.insert(MF);
+  }
+
+  ++NumSelectorLookupHits;
+  return true;
+}
+
 bool GlobalModuleIndex::loadedModuleFile(ModuleFile *File) {
   // Look for the module in the global module index based on the module name.
   StringRef Name = File->ModuleName;
@@ -351,6 +434,11 @@ void GlobalModuleIndex::printStats() {
             NumIdentifierLookupHits, NumIdentifierLookups,
             (double)NumIdentifierLookupHits*100.0/NumIdentifierLookups);
   }
+  if (NumSelectorLookups) {
+    fprintf(stderr, "  %u / %u selector lookups succeeded (%f%%)\n",
+            NumSelectorLookupHits, NumSelectorLookups,
+            (double)NumSelectorLookupHits*100.0/NumSelectorLookups);
+  }
   std::fprintf(stderr, "\n");
 }
 
@@ -400,6 +488,14 @@ namespace {
     /// \brief A mapping from all interesting identifiers to the set of module
     /// files in which those identifiers are considered interesting.
     InterestingIdentifierMap InterestingIdentifiers;
+
+    /// \brief Mapping from selector hashes to the list of module file IDs
+    /// whose method pool has an entry for a selector with that hash.
+    typedef std::map<unsigned, SmallVector<unsigned, 2> > SelectorHashMap;
+
+    /// \brief The hashes of the selectors in the method pools of all module
+    /// files.
+    SelectorHashMap SelectorHashes;
     
     /// \brief Write the block-info block for the global module index file.
     void emitBlockInfoBlock(llvm::BitstreamWriter &Stream);
@@ -468,6 +564,7 @@ GlobalModuleIndexBuilder::emitBlockInfoBlock(llvm::BitstreamWriter &Stream) {
   RECORD(INDEX_METADATA);
   RECORD(MODULE);
   RECORD(IDENTIFIER_INDEX);
+  RECORD(SELECTOR_INDEX);
 #undef RECORD
 #undef BLOCK
 
@@ -638,6 +735,42 @@ bool GlobalModuleIndexBuilder::loadModuleFile(const FileEntry *File) {
       }
     }
 
+    // Handle the method pool. Only the hash of each selector is recorded, so
+    // rather than reading the keys, walk the buckets of the on-disk hash
+    // table: each non-empty bucket is a 16-bit item count followed by the
+    // items, each of which starts with the 32-bit hash of its selector and
+    // the 16-bit lengths of its key and data.
+    if (State == ASTBlock && Code == METHOD_POOL && Record[0] > 0) {
+      using namespace llvm::support;
+      const unsigned char *Base = (const unsigned char *)Blob.data();
+      const unsigned char *Buckets = Base + Record[0];
+      unsigned NumBuckets = endian::readNext<uint32_t, little, unaligned>(
+                              Buckets);
+      (void)endian::readNext<uint32_t, little, unaligned>(Buckets);
+      for (unsigned B = 0; B != NumBuckets; ++B) {
+        unsigned Offset = endian::readNext<uint32_t, little, unaligned>(
+                            Buckets);
+        if (!Offset)
+          continue;
+
+        const unsigned char *Items = Base + Offset;
+        unsigned NumItems = endian::readNext<uint16_t, little, unaligned>(
+                              Items);
+        for (unsigned I = 0; I != NumItems; ++I) {
+          unsigned Hash = endian::readNext<uint32_t, little, unaligned>(Items);
+          unsigned KeyLen = endian::readNext<uint16_t, little, unaligned>(
+                              Items);
+          unsigned DataLen = endian::readNext<uint16_t, little, unaligned>(
+                               Items);
+          Items += KeyLen + DataLen;
+
+          SmallVectorImpl<unsigned> &IDs = SelectorHashes[Hash];
+          if (IDs.empty() || IDs.back() != ID)
+            IDs.push_back(ID);
+        }
+      }
+    }
+
     // We don't care about this record.
   }
 
@@ -684,6 +817,39 @@ public:
   }
 };
 
+/// \brief Trait used to generate the selector index as an on-disk hash table.
+class SelectorIndexWriterTrait {
+public:
+  typedef unsigned key_type;
+  typedef unsigned key_type_ref;
+  typedef SmallVector<unsigned, 2> data_type;
+  typedef const SmallVector<unsigned, 2> &data_type_ref;
+  typedef unsigned hash_value_type;
+  typedef unsigned offset_type;
+
+  static hash_value_type ComputeHash(key_type_ref Key) { return Key; }
+
+  std::pair<unsigned,unsigned>
+  EmitKeyDataLength(raw_ostream& Out, key_type_ref Key, data_type_ref Data) {
+    using namespace llvm::support;
+    unsigned DataLen = Data.size() * 4;
+    endian::Writer<little>(Out).write<uint16_t>(DataLen);
+    return std::make_pair(4u, DataLen);
+  }
+
+  void EmitKey(raw_ostream& Out, key_type_ref Key, unsigned KeyLen) {
+    using namespace llvm::support;
+    endian::Writer<little>(Out).write<uint32_t>(Key);
+  }
+
+  void EmitData(raw_ostream& Out, key_type_ref Key, data_type_ref Data,
+                unsigned DataLen) {
+    using namespace llvm::support;
+    for (unsigned I = 0, N = Data.size(); I != N; ++I)
+      endian::Writer<little>(Out).write<uint32_t>(Data[I]);
+  }
+};
+
 }
 
 void GlobalModuleIndexBuilder::writeIndex(llvm::BitstreamWriter &Stream) {
@@ -763,6 +929,43 @@ void GlobalModuleIndexBuilder::writeIndex(llvm::BitstreamWriter &Stream) {
     Stream.EmitRecordWithBlob(IDTableAbbrev, Record, IdentifierTable);
   }
 
+  // Write the selector hash -> module file mapping.
+  {
+    llvm::OnDiskChainedHashTableGenerator<SelectorIndexWriterTrait> Generator;
+    SelectorIndexWriterTrait Trait;
+
+    // Populate the hash table.
+    for (SelectorHashMap::iterator I = SelectorHashes.begin(),
+                                   IEnd = SelectorHashes.end();
+         I != IEnd; ++I) {
+      Generator.insert(I->first, I->second, Trait);
+    }
+
+    // Create the on-disk hash table in a buffer.
+    SmallString<4096> SelectorTable;
+    uint32_t BucketOffset;
+    {
+      using namespace llvm::support;
+      llvm::raw_svector_ostream Out(SelectorTable);
+      // Make sure that no bucket is at offset 0
+      endian::Writer<little>(Out).write<uint32_t>(0);
+      BucketOffset = Generator.Emit(Out, Trait);
+    }
+
+    // Create a blob abbreviation
+    BitCodeAbbrev *Abbrev = new BitCodeAbbrev();
+    Abbrev->Add(BitCodeAbbrevOp(SELECTOR_INDEX));
+    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32));
+    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
+    unsigned SelTableAbbrev = Stream.EmitAbbrev(Abbrev);
+
+    // Write the selector table
+    Record.clear();
+    Record.push_back(SELECTOR_INDEX);
+    Record.push_back(BucketOffset);
+    Stream.EmitRecordWithBlob(SelTableAbbrev, Record, SelectorTable);
+  }
+
   Stream.ExitBlock();
 }
 
@@ -17,11 +17,14 @@
 #include "ClangSACheckers.h"
 #include "clang/AST/Attr.h"
 #include "clang/Basic/Builtins.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/StaticAnalyzer/Core/BugReporter/BugType.h"
 #include "clang/StaticAnalyzer/Core/Checker.h"
 #include "clang/StaticAnalyzer/Core/CheckerManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/CheckerContext.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ProgramStateTrait.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include <climits>
 
 using namespace clang;
@@ -37,6 +40,11 @@ public:
 
   void checkPreStmt(const CallExpr *CE, CheckerContext &C) const;
 
+  /// \brief Populate the rule table with the built-in attack surface and the
+  /// rules listed in \p ConfigFile, if it is not empty. Problems with the
+  /// file are reported through \p Diags, if it is not null.
+  void initRules(StringRef ConfigFile, DiagnosticsEngine *Diags);
+
 private:
   static const unsigned InvalidArgIndex = UINT_MAX;
   /// Denotes the return vale.
@@ -104,6 +112,22 @@ private:
   
   typedef SmallVector<unsigned, 2> ArgVector;
 
+  /// Parse a list of argument indexes, where "ret" denotes the return value
+  /// (if \p AllowReturnValue is true) and "*" all arguments.  Returns false
+  /// on a malformed entry.
+  static bool parseArgList(ArrayRef<StringRef> Tokens, ArgVector &Args,
+                           bool AllowReturnValue);
+
+  /// Read additional rules from a text file, one rule per line:
+  ///
+  ///   source    <function> <dst>...
+  ///   propagate <function> <src>... -> <dst>...
+  ///   sink      <function> <arg>
+  ///
+  /// Blank lines and lines starting with '#' are ignored.  The return value
+  /// ("ret") cannot be a propagation source.
+  void loadRules(StringRef ConfigFile, DiagnosticsEngine *Diags);
+
   /// \brief A struct used to specify taint propagation rules for a function.
   ///
   /// If any of the possible taint source arguments is tainted, all of the
@@ -168,6 +192,36 @@ private:
     ProgramStateRef process(const CallExpr *CE, CheckerContext &C) const;
 
   };
+
+  /// \brief Everything the checker knows about a callee, found by a single
+  /// hash lookup on its name.
+  struct TaintRule {
+    /// Propagation applied at pre-visit.
+    TaintPropagationRule Propagation;
+    /// Custom evaluation at pre-visit, if any.
+    FnCheck PreCheck;
+    /// Custom evaluation at post-visit, if any.
+    FnCheck PostCheck;
+    /// Values which are tainted on return: ReturnValueIndex or pointer
+    /// arguments, whose pointee becomes tainted.
+    ArgVector SourceArgs;
+    /// Argument which must not be tainted, or InvalidArgIndex.
+    unsigned SinkArg;
+
+    TaintRule() : PreCheck(nullptr), PostCheck(nullptr),
+                  SinkArg(InvalidArgIndex) {}
+  };
+
+  llvm::StringMap<TaintRule> Rules;
+
+  const TaintRule *findRule(StringRef Name) const {
+    llvm::StringMap<TaintRule>::const_iterator I = Rules.find(Name);
+    return I == Rules.end() ? nullptr : &I->second;
+  }
+
+  /// Taint the values listed in \p Args after a call to a source function.
+  ProgramStateRef taintSourceArgs(const ArgVector &Args, const CallExpr *CE,
+                                  CheckerContext &C) const;
 };
 
 const unsigned GenericTaintChecker::ReturnValueIndex;
@@ -192,40 +246,40 @@ const char GenericTaintChecker::MsgTaintedBufferSize[] =
 /// to the call post-visit. The values are unsigned integers, which are either
 /// ReturnValueIndex, or indexes of the pointer/reference argument, which
 /// points to data, which should be tainted on return.
+///
+/// The common case is kept as a bit mask in a single state slot: the top bit
+/// stands for the return value and the remaining bits for the first
+/// arguments.  Only indexes which do not fit go into the set.
+REGISTER_TRAIT_WITH_PROGRAMSTATE(TaintArgsOnPostVisitMask, unsigned)
 REGISTER_SET_WITH_PROGRAMSTATE(TaintArgsOnPostVisit, unsigned)
 
+static const unsigned TaintMaskMaxArg = CHAR_BIT * sizeof(unsigned) - 1;
+static const unsigned TaintMaskReturnBit = 1u << TaintMaskMaxArg;
+
+static ProgramStateRef addTaintArgOnPostVisit(ProgramStateRef State,
+                                              unsigned ArgNum,
+                                              unsigned ReturnValueIndex) {
+  unsigned Bit;
+  if (ArgNum == ReturnValueIndex)
+    Bit = TaintMaskReturnBit;
+  else if (ArgNum < TaintMaskMaxArg)
+    Bit = 1u << ArgNum;
+  else
+    return State->add<TaintArgsOnPostVisit>(ArgNum);
+
+  unsigned Mask = State->get<TaintArgsOnPostVisitMask>();
+  if (Mask & Bit)
+    return State;
+  return State->set<TaintArgsOnPostVisitMask>(Mask | Bit);
+}
+
 GenericTaintChecker::TaintPropagationRule
 GenericTaintChecker::TaintPropagationRule::getTaintPropagationRule(
                                                      const FunctionDecl *FDecl,
                                                      StringRef Name,
                                                      CheckerContext &C) {
-  // TODO: Currently, we might lose precision here: we always mark a return
-  // value as tainted even if it's just a pointer, pointing to tainted data.
-
-  // Check for exact name match for functions without builtin substitutes.
-  TaintPropagationRule Rule = llvm::StringSwitch<TaintPropagationRule>(Name)
-    .Case("atoi", TaintPropagationRule(0, ReturnValueIndex))
-    .Case("atol", TaintPropagationRule(0, ReturnValueIndex))
-    .Case("atoll", TaintPropagationRule(0, ReturnValueIndex))
-    .Case("getc", TaintPropagationRule(0, ReturnValueIndex))
-    .Case("fgetc", TaintPropagationRule(0, ReturnValueIndex))
-    .Case("getc_unlocked", TaintPropagationRule(0, ReturnValueIndex))
-    .Case("getw", TaintPropagationRule(0, ReturnValueIndex))
-    .Case("toupper", TaintPropagationRule(0, ReturnValueIndex))
-    .Case("tolower", TaintPropagationRule(0, ReturnValueIndex))
-    .Case("strchr", TaintPropagationRule(0, ReturnValueIndex))
-    .Case("strrchr", TaintPropagationRule(0, ReturnValueIndex))
-    .Case("read", TaintPropagationRule(0, 2, 1, true))
-    .Case("pread", TaintPropagationRule(InvalidArgIndex, 1, true))
-    .Case("gets", TaintPropagationRule(InvalidArgIndex, 0, true))
-    .Case("fgets", TaintPropagationRule(2, 0, true))
-    .Case("getline", TaintPropagationRule(2, 0))
-    .Case("getdelim", TaintPropagationRule(3, 0))
-    .Case("fgetln", TaintPropagationRule(0, ReturnValueIndex))
-    .Default(TaintPropagationRule());
-
-  if (!Rule.isNull())
-    return Rule;
+  // Functions without builtin substitutes are matched by exact name through
+  // the rule table before we get here.
 
   // Check if it's one of the memory setting/copying functions.
   // This check is specialized but faster then calling isCLibraryFunction.
@@ -248,7 +302,7 @@ GenericTaintChecker::TaintPropagationRule::getTaintPropagationRule(
     };
 
   // Process all other functions which could be defined as builtins.
-  if (Rule.isNull()) {
+  {
     if (C.isCLibraryFunction(FDecl, "snprintf") ||
         C.isCLibraryFunction(FDecl, "sprintf"))
       return TaintPropagationRule(InvalidArgIndex, 0, true);
@@ -301,8 +355,12 @@ void GenericTaintChecker::addSourcesPre(const CallExpr *CE,
     return;
 
   // First, try generating a propagation rule for this function.
-  TaintPropagationRule Rule =
-    TaintPropagationRule::getTaintPropagationRule(FDecl, Name, C);
+  const TaintRule *Known = findRule(Name);
+  TaintPropagationRule Rule;
+  if (Known)
+    Rule = Known->Propagation;
+  if (Rule.isNull())
+    Rule = TaintPropagationRule::getTaintPropagationRule(FDecl, Name, C);
   if (!Rule.isNull()) {
     State = Rule.process(CE, C);
     if (!State)
@@ -312,12 +370,9 @@ void GenericTaintChecker::addSourcesPre(const CallExpr *CE,
   }
 
   // Otherwise, check if we have custom pre-processing implemented.
-  FnCheck evalFunction = llvm::StringSwitch<FnCheck>(Name)
-    .Case("fscanf", &GenericTaintChecker::preFscanf)
-    .Default(nullptr);
   // Check and evaluate the call.
-  if (evalFunction)
-    State = (this->*evalFunction)(CE, C);
+  if (Known && Known->PreCheck)
+    State = (this->*Known->PreCheck)(CE, C);
   if (!State)
     return;
   C.addTransition(State);
@@ -330,13 +385,23 @@ bool GenericTaintChecker::propagateFromPre(const CallExpr *CE,
 
   // Depending on what was tainted at pre-visit, we determined a set of
   // arguments which should be tainted after the function returns. These are
-  // stored in the state as TaintArgsOnPostVisit set.
+  // stored in the state as the TaintArgsOnPostVisitMask bit mask and the
+  // TaintArgsOnPostVisit overflow set.
+  unsigned Mask = State->get<TaintArgsOnPostVisitMask>();
   TaintArgsOnPostVisitTy TaintArgs = State->get<TaintArgsOnPostVisit>();
-  if (TaintArgs.isEmpty())
+  if (!Mask && TaintArgs.isEmpty())
     return false;
 
-  for (llvm::ImmutableSet<unsigned>::iterator
-         I = TaintArgs.begin(), E = TaintArgs.end(); I != E; ++I) {
+  SmallVector<unsigned, 8> ArgNums;
+  if (Mask & TaintMaskReturnBit)
+    ArgNums.push_back(ReturnValueIndex);
+  for (unsigned i = 0; i < TaintMaskMaxArg; ++i)
+    if (Mask & (1u << i))
+      ArgNums.push_back(i);
+  ArgNums.append(TaintArgs.begin(), TaintArgs.end());
+
+  for (SmallVectorImpl<unsigned>::iterator
+         I = ArgNums.begin(), E = ArgNums.end(); I != E; ++I) {
     unsigned ArgNum  = *I;
 
     // Special handling for the tainted return value.
@@ -356,6 +421,7 @@ bool GenericTaintChecker::propagateFromPre(const CallExpr *CE,
   }
 
   // Clear up the taint info from the state.
+  State = State->remove<TaintArgsOnPostVisitMask>();
   State = State->remove<TaintArgsOnPostVisit>();
 
   if (State != C.getState()) {
@@ -376,25 +442,18 @@ void GenericTaintChecker::addSourcesPost(const CallExpr *CE,
   StringRef Name = C.getCalleeName(FDecl);
   if (Name.empty())
     return;
-  FnCheck evalFunction = llvm::StringSwitch<FnCheck>(Name)
-    .Case("scanf", &GenericTaintChecker::postScanf)
-    // TODO: Add support for vfscanf & family.
-    .Case("getchar", &GenericTaintChecker::postRetTaint)
-    .Case("getchar_unlocked", &GenericTaintChecker::postRetTaint)
-    .Case("getenv", &GenericTaintChecker::postRetTaint)
-    .Case("fopen", &GenericTaintChecker::postRetTaint)
-    .Case("fdopen", &GenericTaintChecker::postRetTaint)
-    .Case("freopen", &GenericTaintChecker::postRetTaint)
-    .Case("getch", &GenericTaintChecker::postRetTaint)
-    .Case("wgetch", &GenericTaintChecker::postRetTaint)
-    .Case("socket", &GenericTaintChecker::postSocket)
-    .Default(nullptr);
 
   // If the callee isn't defined, it is not of security concern.
+  const TaintRule *Known = findRule(Name);
+  if (!Known)
+    return;
+
   // Check and evaluate the call.
   ProgramStateRef State = nullptr;
-  if (evalFunction)
-    State = (this->*evalFunction)(CE, C);
+  if (Known->PostCheck)
+    State = (this->*Known->PostCheck)(CE, C);
+  else if (!Known->SourceArgs.empty())
+    State = taintSourceArgs(Known->SourceArgs, CE, C);
   if (!State)
     return;
 
@@ -472,6 +531,14 @@ GenericTaintChecker::TaintPropagationRule::process(const CallExpr *CE,
   if (!IsTainted)
     return State;
 
+  // Rules from the configuration file are not checked against the callee's
+  // signature; skip a rule that names an argument this call does not have.
+  for (ArgVector::const_iterator I = DstArgs.begin(),
+                                 E = DstArgs.end(); I != E; ++I)
+    if (*I != InvalidArgIndex && *I != ReturnValueIndex &&
+        *I >= CE->getNumArgs())
+      return State;
+
   // Mark the arguments which should be tainted after the function returns.
   for (ArgVector::const_iterator I = DstArgs.begin(),
                                  E = DstArgs.end(); I != E; ++I) {
@@ -490,20 +557,20 @@ GenericTaintChecker::TaintPropagationRule::process(const CallExpr *CE,
         QualType PType = ArgTy->getPointeeType();
         if ((!PType.isNull() && !PType.isConstQualified())
             || (ArgTy->isReferenceType() && !Arg->getType().isConstQualified()))
-          State = State->add<TaintArgsOnPostVisit>(i);
+          State = addTaintArgOnPostVisit(State, i, ReturnValueIndex);
       }
       continue;
     }
 
     // Should mark the return value?
     if (ArgNum == ReturnValueIndex) {
-      State = State->add<TaintArgsOnPostVisit>(ReturnValueIndex);
+      State = addTaintArgOnPostVisit(State, ReturnValueIndex,
+                                     ReturnValueIndex);
       continue;
     }
 
     // Mark the given argument.
-    assert(ArgNum < CE->getNumArgs());
-    State = State->add<TaintArgsOnPostVisit>(ArgNum);
+    State = addTaintArgOnPostVisit(State, ArgNum, ReturnValueIndex);
   }
 
   return State;
@@ -522,7 +589,7 @@ ProgramStateRef GenericTaintChecker::preFscanf(const CallExpr *CE,
       isStdin(CE->getArg(0), C)) {
     // All arguments except for the first two should get taint.
     for (unsigned int i = 2; i < CE->getNumArgs(); ++i)
-        State = State->add<TaintArgsOnPostVisit>(i);
+        State = addTaintArgOnPostVisit(State, i, ReturnValueIndex);
     return State;
   }
 
@@ -570,6 +637,33 @@ ProgramStateRef GenericTaintChecker::postRetTaint(const CallExpr *CE,
   return C.getState()->addTaint(CE, C.getLocationContext());
 }
 
+ProgramStateRef
+GenericTaintChecker::taintSourceArgs(const ArgVector &Args, const CallExpr *CE,
+                                     CheckerContext &C) const {
+  ProgramStateRef State = C.getState();
+  for (ArgVector::const_iterator I = Args.begin(), E = Args.end(); I != E;
+       ++I) {
+    unsigned ArgNum = *I;
+
+    if (ArgNum == ReturnValueIndex) {
+      State = State->addTaint(CE, C.getLocationContext());
+      continue;
+    }
+
+    // The data pointed to by the listed arguments is tainted; with
+    // InvalidArgIndex, that is every pointer argument.
+    unsigned Begin = ArgNum, End = ArgNum + 1;
+    if (ArgNum == InvalidArgIndex) {
+      Begin = 0;
+      End = CE->getNumArgs();
+    }
+    for (unsigned i = Begin; i < End && i < CE->getNumArgs(); ++i)
+      if (SymbolRef Sym = getPointedToSymbol(C, CE->getArg(i)))
+        State = State->addTaint(Sym);
+  }
+  return State;
+}
+
 bool GenericTaintChecker::isStdin(const Expr *E, CheckerContext &C) {
   ProgramStateRef State = C.getState();
   SVal Val = State->getSVal(E, C.getLocationContext());
@@ -670,20 +764,12 @@ bool GenericTaintChecker::checkSystemCall(const CallExpr *CE,
   // TODO: It might make sense to run this check on demand. In some cases, 
   // we should check if the environment has been cleansed here. We also might 
   // need to know if the user was reset before these calls(seteuid).
-  unsigned ArgNum = llvm::StringSwitch<unsigned>(Name)
-    .Case("system", 0)
-    .Case("popen", 0)
-    .Case("execl", 0)
-    .Case("execle", 0)
-    .Case("execlp", 0)
-    .Case("execv", 0)
-    .Case("execvp", 0)
-    .Case("execvP", 0)
-    .Case("execve", 0)
-    .Case("dlopen", 0)
-    .Default(UINT_MAX);
-
-  if (ArgNum == UINT_MAX || CE->getNumArgs() < (ArgNum + 1))
+  const TaintRule *Known = findRule(Name);
+  if (!Known)
+    return false;
+
+  unsigned ArgNum = Known->SinkArg;
+  if (ArgNum == InvalidArgIndex || CE->getNumArgs() < (ArgNum + 1))
     return false;
 
   if (generateReportIfTainted(CE->getArg(ArgNum),
@@ -735,6 +821,156 @@ bool GenericTaintChecker::checkTaintedBufferSize(const CallExpr *CE,
   return false;
 }
 
+//===----------------------------------------------------------------------===//
+// Rule table.
+//===----------------------------------------------------------------------===//
+
+void GenericTaintChecker::initRules(StringRef ConfigFile,
+                                    DiagnosticsEngine *Diags) {
+  // TODO: Currently, we might lose precision here: we always mark a return
+  // value as tainted even if it's just a pointer, pointing to tainted data.
+
+  // Propagation rules for functions without builtin substitutes.
+  struct {
+    const char *Name;
+    TaintPropagationRule Rule;
+  } Propagators[] = {
+    { "atoi", TaintPropagationRule(0, ReturnValueIndex) },
+    { "atol", TaintPropagationRule(0, ReturnValueIndex) },
+    { "atoll", TaintPropagationRule(0, ReturnValueIndex) },
+    { "getc", TaintPropagationRule(0, ReturnValueIndex) },
+    { "fgetc", TaintPropagationRule(0, ReturnValueIndex) },
+    { "getc_unlocked", TaintPropagationRule(0, ReturnValueIndex) },
+    { "getw", TaintPropagationRule(0, ReturnValueIndex) },
+    { "toupper", TaintPropagationRule(0, ReturnValueIndex) },
+    { "tolower", TaintPropagationRule(0, ReturnValueIndex) },
+    { "strchr", TaintPropagationRule(0, ReturnValueIndex) },
+    { "strrchr", TaintPropagationRule(0, ReturnValueIndex) },
+    { "read", TaintPropagationRule(0, 2, 1, true) },
+    { "pread", TaintPropagationRule(InvalidArgIndex, 1, true) },
+    { "gets", TaintPropagationRule(InvalidArgIndex, 0, true) },
+    { "fgets", TaintPropagationRule(2, 0, true) },
+    { "getline", TaintPropagationRule(2, 0) },
+    { "getdelim", TaintPropagationRule(3, 0) },
+    { "fgetln", TaintPropagationRule(0, ReturnValueIndex) },
+  };
+  for (const auto &P : Propagators)
+    Rules[P.Name].Propagation = P.Rule;
+
+  // Custom pre-processing.
+  Rules["fscanf"].PreCheck = &GenericTaintChecker::preFscanf;
+
+  // Taint sources.
+  Rules["scanf"].PostCheck = &GenericTaintChecker::postScanf;
+  // TODO: Add support for vfscanf & family.
+  Rules["socket"].PostCheck = &GenericTaintChecker::postSocket;
+  const char *RetSources[] = {
+    "getchar", "getchar_unlocked", "getenv", "fopen", "fdopen", "freopen",
+    "getch", "wgetch"
+  };
+  for (const char *Name : RetSources)
+    Rules[Name].PostCheck = &GenericTaintChecker::postRetTaint;
+
+  // Sinks.
+  // TODO: It might make sense to run this check on demand. In some cases,
+  // we should check if the environment has been cleansed here. We also might
+  // need to know if the user was reset before these calls(seteuid).
+  const char *SystemCalls[] = {
+    "system", "popen", "execl", "execle", "execlp", "execv", "execvp",
+    "execvP", "execve", "dlopen"
+  };
+  for (const char *Name : SystemCalls)
+    Rules[Name].SinkArg = 0;
+
+  if (!ConfigFile.empty())
+    loadRules(ConfigFile, Diags);
+}
+
+bool GenericTaintChecker::parseArgList(ArrayRef<StringRef> Tokens,
+                                       ArgVector &Args,
+                                       bool AllowReturnValue) {
+  for (ArrayRef<StringRef>::iterator I = Tokens.begin(), E = Tokens.end();
+       I != E; ++I) {
+    unsigned ArgNum;
+    if (*I == "ret") {
+      if (!AllowReturnValue)
+        return false;
+      ArgNum = ReturnValueIndex;
+    }
+    else if (*I == "*")
+      ArgNum = InvalidArgIndex;
+    else if (I->getAsInteger(10, ArgNum) || ArgNum >= ReturnValueIndex)
+      return false;
+    Args.push_back(ArgNum);
+  }
+  return !Args.empty();
+}
+
+void GenericTaintChecker::loadRules(StringRef ConfigFile,
+                                    DiagnosticsEngine *Diags) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+    llvm::MemoryBuffer::getFile(ConfigFile);
+  if (!Buffer) {
+    if (Diags)
+      Diags->Report(diag::warn_analyzer_taint_config_unreadable)
+          << ConfigFile << Buffer.getError().message();
+    return;
+  }
+
+  SmallVector<StringRef, 16> Lines;
+  (*Buffer)->getBuffer().split(Lines, "\n");
+  for (unsigned LineNo = 0, e = Lines.size(); LineNo != e; ++LineNo) {
+    StringRef Line = Lines[LineNo].trim();
+    if (Line.empty() || Line.startswith("#"))
+      continue;
+
+    SmallVector<StringRef, 8> Tokens;
+    Line.split(Tokens, " ", -1, /*KeepEmpty=*/false);
+
+    bool Valid = Tokens.size() >= 3;
+    if (Valid) {
+      StringRef Kind = Tokens[0];
+      TaintRule &Rule = Rules[Tokens[1]];
+      ArrayRef<StringRef> Rest = makeArrayRef(Tokens).slice(2);
+
+      if (Kind == "source") {
+        ArgVector Dsts;
+        Valid = parseArgList(Rest, Dsts, /*AllowReturnValue=*/true);
+        if (Valid) {
+          Rule.PostCheck = nullptr;
+          Rule.SourceArgs = Dsts;
+        }
+      } else if (Kind == "propagate") {
+        ArrayRef<StringRef>::iterator Arrow =
+          std::find(Rest.begin(), Rest.end(), "->");
+        TaintPropagationRule Prop;
+        Valid = Arrow != Rest.end() &&
+                parseArgList(ArrayRef<StringRef>(Rest.begin(), Arrow),
+                             Prop.SrcArgs, /*AllowReturnValue=*/false) &&
+                parseArgList(ArrayRef<StringRef>(Arrow + 1, Rest.end()),
+                             Prop.DstArgs, /*AllowReturnValue=*/true);
+        if (Valid)
+          Rule.Propagation = Prop;
+      } else if (Kind == "sink") {
+        unsigned ArgNum;
+        Valid = Rest.size() == 1 && !Rest[0].getAsInteger(10, ArgNum) &&
+                ArgNum < InvalidArgIndex;
+        if (Valid)
+          Rule.SinkArg = ArgNum;
+      } else {
+        Valid = false;
+      }
+    }
+
+    if (!Valid && Diags)
+      Diags->Report(diag::warn_analyzer_taint_config_malformed_rule)
+          << ConfigFile << LineNo + 1 << Line;
+  }
+}
+
 void ento::registerGenericTaintChecker(CheckerManager &mgr) {
-  mgr.registerChecker<GenericTaintChecker>();
+  GenericTaintChecker *checker = mgr.registerChecker<GenericTaintChecker>();
+  checker->initRules(
+      mgr.getAnalyzerOptions().getOptionAsString("Config", "", checker),
+      mgr.getDiagnostics());
 }
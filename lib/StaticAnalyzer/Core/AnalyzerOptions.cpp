@@ -227,6 +227,18 @@ bool AnalyzerOptions::shouldWriteStableReportFilename() {
                           /* Default = */ false);
 }
 
+bool AnalyzerOptions::shouldShareHTMLSourcePages() {
+  return getBooleanOption(ShareHTMLSourcePages,
+                          "html-shared-source",
+                          /* Default = */ false);
+}
+
+StringRef AnalyzerOptions::getFunctionStatsDir() {
+  if (!FunctionStatsDir.hasValue())
+    FunctionStatsDir = getOptionAsString("function-stats-dir", "");
+  return FunctionStatsDir.getValue();
+}
+
 int AnalyzerOptions::getOptionAsInteger(StringRef Name, int DefaultVal,
                                         const CheckerBase *C,
                                         bool SearchInParents) {
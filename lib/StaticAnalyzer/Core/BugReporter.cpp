@@ -42,6 +42,10 @@ using namespace ento;
 
 STATISTIC(MaxBugClassSize,
           "The maximum number of bug reports in the same equivalence class");
+STATISTIC(NumTrimmedGraphs,
+          "The # of trimmed graphs built for path generation");
+STATISTIC(NumSharedTrimmedGraphs,
+          "The # of times a trimmed graph was reused for another consumer");
 STATISTIC(MaxValidBugClassSize,
           "The maximum number of bug reports in the same equivalence class "
           "where at least one report is valid (not suppressed)");
@@ -2734,7 +2738,6 @@ PathDiagnosticLocation BugReport::getLocation(const SourceManager &SM) const {
 //===----------------------------------------------------------------------===//
 
 BugReportEquivClass::~BugReportEquivClass() { }
-GRBugReporter::~GRBugReporter() { }
 BugReporterData::~BugReporterData() {}
 
 ExplodedGraph &GRBugReporter::getGraph() { return Eng.getGraph(); }
@@ -2800,8 +2803,15 @@ public:
   size_t Index;
 };
 
+}
+
 /// A wrapper around a trimmed graph and its node maps.
-class TrimmedGraph {
+///
+/// The trimmed graph of an equivalence class only depends on the error nodes
+/// of its reports, so it is built once and shared by every
+/// PathDiagnosticConsumer; each consumer walks the report graphs with its own
+/// cursor.
+class GRBugReporter::TrimmedGraph {
   InterExplodedGraphMap InverseMap;
 
   typedef llvm::DenseMap<const ExplodedNode *, unsigned> PriorityMapTy;
@@ -2843,12 +2853,23 @@ public:
   TrimmedGraph(const ExplodedGraph *OriginalGraph,
                ArrayRef<const ExplodedNode *> Nodes);
 
-  bool popNextReportGraph(ReportGraph &GraphWrapper);
+  /// Build the single-path graph for the report at position \p Cursor in
+  /// order of increasing path length, advancing \p Cursor.
+  bool getNextReportGraph(size_t &Cursor, ReportGraph &GraphWrapper) const;
 };
+
+GRBugReporter::GRBugReporter(BugReporterData &d, ExprEngine &eng)
+    : BugReporter(d, GRBugReporterKind), Eng(eng) {}
+
+GRBugReporter::~GRBugReporter() {}
+
+void GRBugReporter::clearSharedTrimmedGraph() {
+  SharedTrimmedGraph.reset();
+  SharedTrimmedGraphNodes.clear();
 }
 
-TrimmedGraph::TrimmedGraph(const ExplodedGraph *OriginalGraph,
-                           ArrayRef<const ExplodedNode *> Nodes) {
+GRBugReporter::TrimmedGraph::TrimmedGraph(const ExplodedGraph *OriginalGraph,
+                                          ArrayRef<const ExplodedNode *> Nodes) {
   // The trimmed graph is created in the body of the constructor to ensure
   // that the DenseMaps have been initialized already.
   InterExplodedGraphMap ForwardMap;
@@ -2905,12 +2926,16 @@ TrimmedGraph::TrimmedGraph(const ExplodedGraph *OriginalGraph,
             PriorityCompare<true>(PriorityMap));
 }
 
-bool TrimmedGraph::popNextReportGraph(ReportGraph &GraphWrapper) {
-  if (ReportNodes.empty())
+bool GRBugReporter::TrimmedGraph::getNextReportGraph(
+    size_t &Cursor, ReportGraph &GraphWrapper) const {
+  // ReportNodes is sorted from the longest path to the shortest.
+  if (Cursor >= ReportNodes.size())
     return false;
 
   const ExplodedNode *OrigN;
-  std::tie(OrigN, GraphWrapper.Index) = ReportNodes.pop_back_val();
+  std::tie(OrigN, GraphWrapper.Index) =
+      ReportNodes[ReportNodes.size() - 1 - Cursor];
+  ++Cursor;
   assert(PriorityMap.find(OrigN) != PriorityMap.end() &&
          "error node not accessible from root");
 
@@ -3089,15 +3114,33 @@ bool GRBugReporter::generatePathDiagnostic(PathDiagnostic& PD,
     }
   }
 
-  TrimmedGraph TrimG(&getGraph(), errorNodes);
+  // Reuse the trimmed graph built for a previous consumer of the same
+  // reports. Reports in it that have since been marked invalid are skipped
+  // below.
+  SmallVector<const ExplodedNode *, 32> allErrorNodes;
+  for (BugReport *R : bugReports)
+    allErrorNodes.push_back(R->getErrorNode());
+  if (SharedTrimmedGraph &&
+      ArrayRef<const ExplodedNode *>(allErrorNodes)
+          .equals(SharedTrimmedGraphNodes)) {
+    ++NumSharedTrimmedGraphs;
+  } else {
+    ++NumTrimmedGraphs;
+    SharedTrimmedGraph.reset(new TrimmedGraph(&getGraph(), errorNodes));
+    SharedTrimmedGraphNodes.swap(allErrorNodes);
+  }
+
+  const TrimmedGraph &TrimG = *SharedTrimmedGraph;
   ReportGraph ErrorGraph;
+  size_t Cursor = 0;
 
-  while (TrimG.popNextReportGraph(ErrorGraph)) {
+  while (TrimG.getNextReportGraph(Cursor, ErrorGraph)) {
     // Find the BugReport with the original location.
     assert(ErrorGraph.Index < bugReports.size());
     BugReport *R = bugReports[ErrorGraph.Index];
     assert(R && "No original report found for sliced graph.");
-    assert(R->isValid() && "Report selected by trimmed graph marked invalid.");
+    if (!R->isValid())
+      continue;
 
     // Start building the path diagnostic...
     PathDiagnosticBuilder PDB(*this, R, ErrorGraph.BackMap, &PC);
@@ -3382,6 +3425,10 @@ void BugReporter::FlushReport(BugReportEquivClass& EQ) {
       FlushReport(exampleReport, *PDC, bugReports);
     }
   }
+
+  // The trimmed graph is only shared by the consumers of one class.
+  if (GRBugReporter *GR = dyn_cast<GRBugReporter>(this))
+    GR->clearSharedTrimmedGraph();
 }
 
 void BugReporter::FlushReport(BugReport *exampleReport,
@@ -22,8 +22,10 @@
 #include "clang/Rewrite/Core/Rewriter.h"
 #include "clang/StaticAnalyzer/Core/BugReporter/PathDiagnostic.h"
 #include "clang/StaticAnalyzer/Core/CheckerManager.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
@@ -43,6 +45,10 @@ class HTMLDiagnostics : public PathDiagnosticConsumer {
   bool createdDir, noDir;
   const Preprocessor &PP;
   AnalyzerOptions &AnalyzerOpts;
+
+  /// The highlighted source pages written so far, keyed by the file they
+  /// display.  An empty name records a page that could not be written.
+  llvm::DenseMap<const FileEntry *, std::string> SharedSourcePages;
 public:
   HTMLDiagnostics(AnalyzerOptions &AnalyzerOpts, const std::string& prefix, const Preprocessor &pp);
 
@@ -68,6 +74,25 @@ public:
 
   void ReportDiag(const PathDiagnostic& D,
                   FilesMade *filesMade);
+
+  /// Write a report that refers to a shared, highlighted source page
+  /// instead of embedding its own copy of the annotated file.
+  void ReportDiagWithSharedSource(const PathDiagnostic &D,
+                                  const PathPieces &path, FileID FID,
+                                  StringRef declName, raw_ostream &os);
+
+  /// Return the name of the highlighted page for \p FID, relative to the
+  /// output directory, emitting the page the first time it is requested.
+  StringRef getSharedSourcePage(FileID FID);
+
+  void EmitReportHeader(raw_ostream &os, const PathDiagnostic &D,
+                        StringRef FileName, StringRef declName,
+                        unsigned PathLength, int LineNumber,
+                        int ColumnNumber);
+
+  void EmitSharedSourcePiece(raw_ostream &os, StringRef SourcePage,
+                             FileID BugFileID, const PathDiagnosticPiece &P,
+                             unsigned num, unsigned max);
 };
 
 } // end anonymous namespace
@@ -128,9 +153,6 @@ void HTMLDiagnostics::ReportDiag(const PathDiagnostic& D,
     (*path.begin())->getLocation().asLocation().getExpansionLoc().getFileID();
   assert(!FID.isInvalid());
 
-  // Create a new rewriter to generate HTML.
-  Rewriter R(const_cast<SourceManager&>(SMgr), PP.getLangOpts());
-
   // Get the function/method name
   SmallString<128> declName("unknown");
   int offsetDecl = 0;
@@ -150,129 +172,61 @@ void HTMLDiagnostics::ReportDiag(const PathDiagnostic& D,
       }
   }
 
-  // Process the path.
-  unsigned n = path.size();
-  unsigned max = n;
-
-  for (PathPieces::const_reverse_iterator I = path.rbegin(),
-       E = path.rend();
-        I != E; ++I, --n)
-    HandlePiece(R, FID, **I, n, max);
-
-  // Add line numbers, header, footer, etc.
-
-  // unsigned FID = R.getSourceMgr().getMainFileID();
-  html::EscapeText(R, FID);
-  html::AddLineNumbers(R, FID);
-
-  // If we have a preprocessor, relex the file and syntax highlight.
-  // We might not have a preprocessor if we come from a deserialized AST file,
-  // for example.
-
-  html::SyntaxHighlight(R, FID, PP);
-  html::HighlightMacros(R, FID, PP);
-
-  // Get the full directory name of the analyzed file.
-
   const FileEntry* Entry = SMgr.getFileEntryForID(FID);
+  bool ShareSource = AnalyzerOpts.shouldShareHTMLSourcePages();
 
-  // This is a cludge; basically we want to append either the full
-  // working directory if we have no directory information.  This is
-  // a work in progress.
-
-  llvm::SmallString<0> DirName;
+  // In the shared-source mode the report is streamed straight to disk, so
+  // there is nothing to prepare before the file is created.
+  std::unique_ptr<Rewriter> R;
+  const RewriteBuffer *Buf = nullptr;
+  if (!ShareSource) {
+    // Create a new rewriter to generate HTML.
+    R.reset(new Rewriter(const_cast<SourceManager&>(SMgr), PP.getLangOpts()));
 
-  if (llvm::sys::path::is_relative(Entry->getName())) {
-    llvm::sys::fs::current_path(DirName);
-    DirName += '/';
-  }
+    // Process the path.
+    unsigned n = path.size();
+    unsigned max = n;
 
-  int LineNumber = (*path.rbegin())->getLocation().asLocation().getExpansionLineNumber();
-  int ColumnNumber = (*path.rbegin())->getLocation().asLocation().getExpansionColumnNumber();
+    for (PathPieces::const_reverse_iterator I = path.rbegin(),
+         E = path.rend();
+          I != E; ++I, --n)
+      HandlePiece(*R, FID, **I, n, max);
 
-  // Add the name of the file as an <h1> tag.
+    // Add line numbers, header, footer, etc.
 
-  {
-    std::string s;
-    llvm::raw_string_ostream os(s);
+    // unsigned FID = R.getSourceMgr().getMainFileID();
+    html::EscapeText(*R, FID);
+    html::AddLineNumbers(*R, FID);
 
-    os << "<!-- REPORTHEADER -->\n"
-      << "<h3>Bug Summary</h3>\n<table class=\"simpletable\">\n"
-          "<tr><td class=\"rowname\">File:</td><td>"
-      << html::EscapeText(DirName)
-      << html::EscapeText(Entry->getName())
-      << "</td></tr>\n<tr><td class=\"rowname\">Location:</td><td>"
-         "<a href=\"#EndPath\">line "
-      << LineNumber
-      << ", column "
-      << ColumnNumber
-      << "</a></td></tr>\n"
-         "<tr><td class=\"rowname\">Description:</td><td>"
-      << D.getVerboseDescription() << "</td></tr>\n";
-
-    // Output any other meta data.
-
-    for (PathDiagnostic::meta_iterator I=D.meta_begin(), E=D.meta_end();
-         I!=E; ++I) {
-      os << "<tr><td></td><td>" << html::EscapeText(*I) << "</td></tr>\n";
-    }
+    // If we have a preprocessor, relex the file and syntax highlight.
+    // We might not have a preprocessor if we come from a deserialized AST file,
+    // for example.
 
-    os << "</table>\n<!-- REPORTSUMMARYEXTRA -->\n"
-          "<h3>Annotated Source Code</h3>\n";
+    html::SyntaxHighlight(*R, FID, PP);
+    html::HighlightMacros(*R, FID, PP);
 
-    R.InsertTextBefore(SMgr.getLocForStartOfFile(FID), os.str());
-  }
+    int LineNumber =
+      (*path.rbegin())->getLocation().asLocation().getExpansionLineNumber();
+    int ColumnNumber =
+      (*path.rbegin())->getLocation().asLocation().getExpansionColumnNumber();
 
-  // Embed meta-data tags.
-  {
     std::string s;
     llvm::raw_string_ostream os(s);
+    EmitReportHeader(os, D, Entry->getName(), declName, path.size(),
+                     LineNumber, ColumnNumber);
+    R->InsertTextBefore(SMgr.getLocForStartOfFile(FID), os.str());
 
-    StringRef BugDesc = D.getVerboseDescription();
-    if (!BugDesc.empty())
-      os << "\n<!-- BUGDESC " << BugDesc << " -->\n";
-
-    StringRef BugType = D.getBugType();
-    if (!BugType.empty())
-      os << "\n<!-- BUGTYPE " << BugType << " -->\n";
-
-    StringRef BugCategory = D.getCategory();
-    if (!BugCategory.empty())
-      os << "\n<!-- BUGCATEGORY " << BugCategory << " -->\n";
-
-    os << "\n<!-- BUGFILE " << DirName << Entry->getName() << " -->\n";
-
-    os << "\n<!-- FILENAME " << llvm::sys::path::filename(Entry->getName()) << " -->\n";
-
-    os  << "\n<!-- FUNCTIONNAME " <<  declName << " -->\n";
+    // Add CSS, header, and footer.
 
-    os << "\n<!-- BUGLINE "
-       << LineNumber
-       << " -->\n";
+    html::AddHeaderFooterInternalBuiltinCSS(*R, FID, Entry->getName());
 
-    os << "\n<!-- BUGCOLUMN "
-      << ColumnNumber
-      << " -->\n";
+    // Get the rewrite buffer.
+    Buf = R->getRewriteBufferFor(FID);
 
-    os << "\n<!-- BUGPATHLENGTH " << path.size() << " -->\n";
-
-    // Mark the end of the tags.
-    os << "\n<!-- BUGMETAEND -->\n";
-
-    // Insert the text.
-    R.InsertTextBefore(SMgr.getLocForStartOfFile(FID), os.str());
-  }
-
-  // Add CSS, header, and footer.
-
-  html::AddHeaderFooterInternalBuiltinCSS(R, FID, Entry->getName());
-
-  // Get the rewrite buffer.
-  const RewriteBuffer *Buf = R.getRewriteBufferFor(FID);
-
-  if (!Buf) {
-    llvm::errs() << "warning: no diagnostics generated for main file.\n";
-    return;
+    if (!Buf) {
+      llvm::errs() << "warning: no diagnostics generated for main file.\n";
+      return;
+    }
   }
 
   // Create a path for the target HTML file.
@@ -322,11 +276,266 @@ void HTMLDiagnostics::ReportDiag(const PathDiagnostic& D,
     filesMade->addDiagnostic(D, getName(),
                              llvm::sys::path::filename(ResultPath));
 
+  if (ShareSource) {
+    ReportDiagWithSharedSource(D, path, FID, declName, os);
+    return;
+  }
+
   // Emit the HTML to disk.
   for (RewriteBuffer::iterator I = Buf->begin(), E = Buf->end(); I!=E; ++I)
       os << *I;
 }
 
+void HTMLDiagnostics::EmitReportHeader(raw_ostream &os,
+                                       const PathDiagnostic &D,
+                                       StringRef FileName, StringRef declName,
+                                       unsigned PathLength, int LineNumber,
+                                       int ColumnNumber) {
+  // This is a cludge; basically we want to append either the full
+  // working directory if we have no directory information.  This is
+  // a work in progress.
+
+  llvm::SmallString<0> DirName;
+
+  if (llvm::sys::path::is_relative(FileName)) {
+    llvm::sys::fs::current_path(DirName);
+    DirName += '/';
+  }
+
+  // Embed meta-data tags.
+
+  StringRef BugDesc = D.getVerboseDescription();
+  if (!BugDesc.empty())
+    os << "\n<!-- BUGDESC " << BugDesc << " -->\n";
+
+  StringRef BugType = D.getBugType();
+  if (!BugType.empty())
+    os << "\n<!-- BUGTYPE " << BugType << " -->\n";
+
+  StringRef BugCategory = D.getCategory();
+  if (!BugCategory.empty())
+    os << "\n<!-- BUGCATEGORY " << BugCategory << " -->\n";
+
+  os << "\n<!-- BUGFILE " << DirName << FileName << " -->\n";
+
+  os << "\n<!-- FILENAME " << llvm::sys::path::filename(FileName) << " -->\n";
+
+  os  << "\n<!-- FUNCTIONNAME " <<  declName << " -->\n";
+
+  os << "\n<!-- BUGLINE "
+     << LineNumber
+     << " -->\n";
+
+  os << "\n<!-- BUGCOLUMN "
+    << ColumnNumber
+    << " -->\n";
+
+  os << "\n<!-- BUGPATHLENGTH " << PathLength << " -->\n";
+
+  // Mark the end of the tags.
+  os << "\n<!-- BUGMETAEND -->\n";
+
+  // Add the name of the file as an <h1> tag.
+
+  os << "<!-- REPORTHEADER -->\n"
+    << "<h3>Bug Summary</h3>\n<table class=\"simpletable\">\n"
+        "<tr><td class=\"rowname\">File:</td><td>"
+    << html::EscapeText(DirName)
+    << html::EscapeText(FileName)
+    << "</td></tr>\n<tr><td class=\"rowname\">Location:</td><td>"
+       "<a href=\"#EndPath\">line "
+    << LineNumber
+    << ", column "
+    << ColumnNumber
+    << "</a></td></tr>\n"
+       "<tr><td class=\"rowname\">Description:</td><td>"
+    << D.getVerboseDescription() << "</td></tr>\n";
+
+  // Output any other meta data.
+
+  for (PathDiagnostic::meta_iterator I=D.meta_begin(), E=D.meta_end();
+       I!=E; ++I) {
+    os << "<tr><td></td><td>" << html::EscapeText(*I) << "</td></tr>\n";
+  }
+
+  os << "</table>\n<!-- REPORTSUMMARYEXTRA -->\n"
+        "<h3>Annotated Source Code</h3>\n";
+}
+
+//===----------------------------------------------------------------------===//
+// Shared source pages.
+//===----------------------------------------------------------------------===//
+
+StringRef HTMLDiagnostics::getSharedSourcePage(FileID FID) {
+  SourceManager &SM = PP.getSourceManager();
+  const FileEntry *Entry = SM.getFileEntryForID(FID);
+
+  llvm::DenseMap<const FileEntry *, std::string>::iterator Known =
+    SharedSourcePages.find(Entry);
+  if (Known != SharedSourcePages.end())
+    return Known->second;
+
+  std::string &PageName = SharedSourcePages[Entry];
+
+  // Name the page after the file contents it shows, so that reports from
+  // other translation units written to the same directory reuse it.
+  llvm::MD5 Hash;
+  Hash.update(Entry->getName());
+  uint64_t Stamp[2] = { uint64_t(Entry->getSize()),
+                        uint64_t(Entry->getModificationTime()) };
+  Hash.update(llvm::makeArrayRef(reinterpret_cast<const uint8_t *>(Stamp),
+                                 sizeof(Stamp)));
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Digest;
+  llvm::MD5::stringifyResult(Result, Digest);
+
+  std::string Name = "source-";
+  Name += llvm::sys::path::filename(Entry->getName()).str();
+  Name += '-';
+  Name += Digest.substr(0, 16).str();
+  Name += ".html";
+
+  SmallString<128> Path;
+  llvm::sys::path::append(Path, Directory, Name);
+  if (llvm::sys::fs::exists(Path.str())) {
+    PageName = Name;
+    return PageName;
+  }
+
+  Rewriter R(SM, PP.getLangOpts());
+  html::EscapeText(R, FID);
+  html::AddLineNumbers(R, FID);
+  html::SyntaxHighlight(R, FID, PP);
+  html::HighlightMacros(R, FID, PP);
+  html::AddHeaderFooterInternalBuiltinCSS(R, FID, Entry->getName());
+
+  const RewriteBuffer *Buf = R.getRewriteBufferFor(FID);
+  if (!Buf)
+    return PageName;
+
+  int FD;
+  std::error_code EC = llvm::sys::fs::openFileForWrite(
+      Path, FD, llvm::sys::fs::F_RW | llvm::sys::fs::F_Excl);
+  if (EC == llvm::errc::file_exists) {
+    PageName = Name;
+    return PageName;
+  }
+  if (EC) {
+    llvm::errs() << "warning: could not create file '" << Path
+                 << "': " << EC.message() << '\n';
+    return PageName;
+  }
+
+  llvm::raw_fd_ostream os(FD, true);
+  for (RewriteBuffer::iterator I = Buf->begin(), E = Buf->end(); I!=E; ++I)
+    os << *I;
+
+  PageName = Name;
+  return PageName;
+}
+
+void HTMLDiagnostics::ReportDiagWithSharedSource(const PathDiagnostic &D,
+                                                 const PathPieces &path,
+                                                 FileID FID,
+                                                 StringRef declName,
+                                                 raw_ostream &os) {
+  const SourceManager &SMgr = PP.getSourceManager();
+  const FileEntry *Entry = SMgr.getFileEntryForID(FID);
+  StringRef SourcePage = getSharedSourcePage(FID);
+
+  FullSourceLoc EndLoc = (*path.rbegin())->getLocation().asLocation();
+
+  html::EmitHeaderInternalBuiltinCSS(os, Entry->getName());
+  EmitReportHeader(os, D, Entry->getName(), declName, path.size(),
+                   EndLoc.getExpansionLineNumber(),
+                   EndLoc.getExpansionColumnNumber());
+
+  if (!SourcePage.empty())
+    os << "<p><a href=\"" << SourcePage << "\">"
+       << html::EscapeText(llvm::sys::path::filename(Entry->getName()))
+       << "</a></p>\n";
+
+  // Emit each event next to a copy of the line it refers to; the full,
+  // highlighted file lives on the shared page.
+  os << "<table class=\"code\">\n";
+
+  unsigned n = 1;
+  unsigned max = path.size();
+  for (PathPieces::const_iterator I = path.begin(), E = path.end(); I != E;
+       ++I, ++n)
+    EmitSharedSourcePiece(os, SourcePage, FID, **I, n, max);
+
+  os << "</table>\n</body></html>\n";
+}
+
+void HTMLDiagnostics::EmitSharedSourcePiece(raw_ostream &os,
+                                            StringRef SourcePage,
+                                            FileID BugFileID,
+                                            const PathDiagnosticPiece &P,
+                                            unsigned num, unsigned max) {
+  FullSourceLoc Pos = P.getLocation().asLocation();
+
+  if (!Pos.isValid())
+    return;
+
+  const SourceManager &SM = Pos.getManager();
+  std::pair<FileID, unsigned> LPosInfo = SM.getDecomposedExpansionLoc(Pos);
+
+  if (LPosInfo.first != BugFileID)
+    return;
+
+  unsigned LineNo = SM.getLineNumber(LPosInfo.first, LPosInfo.second);
+  unsigned ColNo = SM.getColumnNumber(LPosInfo.first, LPosInfo.second);
+
+  StringRef Buffer = SM.getBufferData(LPosInfo.first);
+  size_t LineStart = LPosInfo.second - (ColNo - 1);
+  size_t LineEnd = Buffer.find_first_of("\r\n", LineStart);
+  StringRef Line = Buffer.slice(LineStart, LineEnd);
+
+  const char *Kind = nullptr;
+  switch (P.getKind()) {
+  case PathDiagnosticPiece::Call:
+      llvm_unreachable("Calls should already be handled");
+  case PathDiagnosticPiece::Event:  Kind = "Event"; break;
+  case PathDiagnosticPiece::ControlFlow: Kind = "Control"; break;
+    // Setting Kind to "Control" is intentional.
+  case PathDiagnosticPiece::Macro: Kind = "Control"; break;
+  }
+
+  os << "<tr><td class=\"num\">";
+  if (!SourcePage.empty())
+    os << "<a href=\"" << SourcePage << "#LN" << LineNo << "\">" << LineNo
+       << "</a>";
+  else
+    os << LineNo;
+  os << "</td><td class=\"line\">" << html::EscapeText(Line)
+     << "</td></tr>\n";
+
+  os << "<tr><td class=\"num\"></td><td class=\"line\"><div id=\"";
+  if (num == max)
+    os << "EndPath";
+  else
+    os << "Path" << num;
+  os << "\" class=\"msg msg" << Kind << "\">";
+
+  if (max > 1)
+    os << "<table class=\"msgT\"><tr><td valign=\"top\">"
+          "<div class=\"PathIndex PathIndex" << Kind << "\">" << num
+       << "</div></td><td>";
+
+  if (const PathDiagnosticMacroPiece *MP =
+        dyn_cast<PathDiagnosticMacroPiece>(&P))
+    ProcessMacroPiece(os, *MP, 0);
+  else
+    os << html::EscapeText(P.getString());
+
+  if (max > 1)
+    os << "</td></tr></table>";
+
+  os << "</div></td></tr>\n";
+}
+
 void HTMLDiagnostics::HandlePiece(Rewriter& R, FileID BugFileID,
                                   const PathDiagnosticPiece& P,
                                   unsigned num, unsigned max) {
@@ -41,9 +41,11 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Timer.h"
+#include "llvm/Support/YAMLParser.h"
 #include "llvm/Support/raw_ostream.h"
 #include <memory>
 #include <queue>
@@ -185,6 +187,27 @@ public:
   /// translation unit.
   FunctionSummariesTy FunctionSummaries;
 
+  /// Performance data for one path-sensitive analysis of a function.
+  struct FunctionStats {
+    std::string Name;
+    std::string Location;
+    ExprEngine::InliningModes IMode;
+    unsigned NumBlocks;
+    unsigned NumVisitedBlocks;
+    unsigned NumSteps;
+    unsigned NumNodes;
+    bool ReachedMaxSteps;
+    bool BlocksExhausted;
+    double WallTime;
+    double UserTime;
+    ssize_t MemUsed;
+  };
+
+  /// The directory the per-function statistics are written to, or empty if
+  /// they are not collected.
+  StringRef FunctionStatsDir;
+  std::vector<FunctionStats> FunctionStatsRecords;
+
   AnalysisConsumer(const Preprocessor& pp,
                    const std::string& outdir,
                    AnalyzerOptionsRef opts,
@@ -193,6 +216,7 @@ public:
     : RecVisitorMode(0), RecVisitorBR(nullptr), Ctx(nullptr), PP(pp),
       OutDir(outdir), Opts(opts), Plugins(plugins), Injector(injector) {
     DigestAnalyzerOptions();
+    FunctionStatsDir = Opts->getFunctionStatsDir();
     if (Opts->PrintStats) {
       llvm::EnableStatistics();
       TUTotalTimer = new llvm::Timer("Analyzer Total Time");
@@ -331,6 +355,9 @@ public:
                         ExprEngine::InliningModes IMode,
                         SetOfConstDecls *VisitedCallees);
 
+  /// \brief Write the collected per-function statistics as JSON.
+  void EmitFunctionStats();
+
   /// Visitors for the RecursiveASTVisitor.
   bool shouldWalkTypesOfTypeLocs() const { return false; }
 
@@ -555,6 +582,9 @@ void AnalysisConsumer::HandleTranslationUnit(ASTContext &C) {
 
   if (TUTotalTimer) TUTotalTimer->stopTimer();
 
+  if (!FunctionStatsDir.empty())
+    EmitFunctionStats();
+
   // Count how many basic blocks we have not covered.
   NumBlocksInAnalyzedFunctions = FunctionSummaries.getTotalNumBasicBlocks();
   if (NumBlocksInAnalyzedFunctions > 0)
@@ -646,6 +676,10 @@ void AnalysisConsumer::ActionExprEngine(Decl *D, bool ObjCGCEnabled,
   if (!Mgr->getAnalysisDeclContext(D)->getAnalysis<RelaxedLiveVariables>())
     return;
 
+  llvm::TimeRecord StartTime;
+  if (!FunctionStatsDir.empty())
+    StartTime = llvm::TimeRecord::getCurrentTime(/*Start=*/true);
+
   ExprEngine Eng(*Mgr, ObjCGCEnabled, VisitedCallees, &FunctionSummaries,IMode);
 
   // Set the graph auditor.
@@ -656,8 +690,10 @@ void AnalysisConsumer::ActionExprEngine(Decl *D, bool ObjCGCEnabled,
   }
 
   // Execute the worklist algorithm.
-  Eng.ExecuteWorkList(Mgr->getAnalysisDeclContextManager().getStackFrame(D),
-                      Mgr->options.getMaxNodesPerTopLevelFunction());
+  bool ReachedMaxSteps =
+      Eng.ExecuteWorkList(Mgr->getAnalysisDeclContextManager().getStackFrame(D),
+                          Mgr->options.getMaxNodesPerTopLevelFunction());
+  unsigned NumNodes = Eng.getGraph().getNumCreatedNodes();
 
   // Release the auditor (if any) so that it doesn't monitor the graph
   // created BugReporter.
@@ -669,6 +705,36 @@ void AnalysisConsumer::ActionExprEngine(Decl *D, bool ObjCGCEnabled,
 
   // Display warnings.
   Eng.getBugReporter().FlushReports();
+
+  if (FunctionStatsDir.empty())
+    return;
+
+  // The time spent generating the bug reports is included, as it grows with
+  // the size of the exploded graph.
+  llvm::TimeRecord Time = llvm::TimeRecord::getCurrentTime(/*Start=*/false);
+  Time -= StartTime;
+
+  FunctionStats Stats;
+  if (const NamedDecl *ND = dyn_cast<NamedDecl>(D))
+    Stats.Name = ND->getQualifiedNameAsString();
+  else
+    Stats.Name = "block";
+  SourceManager &SM = Mgr->getASTContext().getSourceManager();
+  PresumedLoc Loc = SM.getPresumedLoc(SM.getExpansionLoc(D->getLocation()));
+  if (Loc.isValid())
+    Stats.Location = (Twine(Loc.getFilename()) + ":" + Twine(Loc.getLine()) +
+                      ":" + Twine(Loc.getColumn())).str();
+  Stats.IMode = IMode;
+  Stats.NumBlocks = Mgr->getCFG(D)->getNumBlockIDs();
+  Stats.NumVisitedBlocks = FunctionSummaries.getNumVisitedBasicBlocks(D);
+  Stats.NumSteps = Eng.getNumSteps();
+  Stats.NumNodes = NumNodes;
+  Stats.ReachedMaxSteps = ReachedMaxSteps;
+  Stats.BlocksExhausted = Eng.wasBlocksExhausted();
+  Stats.WallTime = Time.getWallTime();
+  Stats.UserTime = Time.getUserTime();
+  Stats.MemUsed = Time.getMemUsed();
+  FunctionStatsRecords.push_back(std::move(Stats));
 }
 
 void AnalysisConsumer::RunPathSensitiveChecks(Decl *D,
@@ -691,6 +757,51 @@ void AnalysisConsumer::RunPathSensitiveChecks(Decl *D,
   }
 }
 
+void AnalysisConsumer::EmitFunctionStats() {
+  std::unique_ptr<llvm::raw_fd_ostream> File;
+  raw_ostream *OS = &llvm::errs();
+  if (FunctionStatsDir != "-") {
+    SmallString<128> Model(FunctionStatsDir);
+    llvm::sys::path::append(Model, "stats-%%%%%%.json");
+    SmallString<128> Path;
+    int FD;
+    if (std::error_code EC = llvm::sys::fs::createUniqueFile(Model, FD, Path)) {
+      llvm::errs() << "warning: could not create function statistics file in '"
+                   << FunctionStatsDir << "': " << EC.message() << '\n';
+      return;
+    }
+    File.reset(new llvm::raw_fd_ostream(FD, /*shouldClose=*/true));
+    OS = File.get();
+  }
+
+  SourceManager &SM = Ctx->getSourceManager();
+  const FileEntry *MainFile = SM.getFileEntryForID(SM.getMainFileID());
+  *OS << "{\n  \"file\": \""
+      << llvm::yaml::escape(MainFile ? MainFile->getName() : "")
+      << "\",\n  \"functions\": [";
+  for (unsigned I = 0, E = FunctionStatsRecords.size(); I != E; ++I) {
+    const FunctionStats &S = FunctionStatsRecords[I];
+    *OS << (I ? ",\n" : "\n")
+        << "    { \"name\": \"" << llvm::yaml::escape(S.Name)
+        << "\", \"location\": \"" << llvm::yaml::escape(S.Location)
+        << "\", \"mode\": \""
+        << (S.IMode == ExprEngine::Inline_Minimal ? "minimal" : "regular")
+        << "\", \"blocks\": " << S.NumBlocks
+        << ", \"visited-blocks\": " << S.NumVisitedBlocks
+        << ", \"steps\": " << S.NumSteps
+        << ", \"nodes\": " << S.NumNodes
+        << ", \"max-steps-reached\": "
+        << (S.ReachedMaxSteps ? "true" : "false")
+        << ", \"blocks-exhausted\": "
+        << (S.BlocksExhausted ? "true" : "false")
+        << ", \"wall\": " << llvm::format("%.6f", S.WallTime)
+        << ", \"user\": " << llvm::format("%.6f", S.UserTime)
+        << ", \"memory\": " << (int64_t)S.MemUsed << " }";
+  }
+  *OS << "\n  ]\n}\n";
+  FunctionStatsRecords.clear();
+}
+
 //===----------------------------------------------------------------------===//
 // AnalysisConsumer creation.
 //===----------------------------------------------------------------------===//
@@ -0,0 +1,24 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config function-stats-dir=- %s 2>&1 | FileCheck %s
+// RUN: rm -rf %t.dir && mkdir %t.dir
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config function-stats-dir=%t.dir %s
+// RUN: cat %t.dir/stats-*.json | FileCheck %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config function-stats-dir=- -analyzer-config max-nodes=20 %s 2>&1 | FileCheck -check-prefix=BUDGET %s
+
+int callee(int x) {
+  return x + 1;
+}
+
+int caller(int n) {
+  int sum = 0;
+  for (int i = 0; i < n; ++i)
+    sum += callee(i);
+  return sum;
+}
+
+// CHECK: "file": "{{.*}}function-stats.c",
+// CHECK-NEXT: "functions": [
+// CHECK-NEXT: { "name": "caller", "location": "{{.*}}function-stats.c:11:5", "mode": "regular", "blocks": {{[0-9]+}}, "visited-blocks": {{[0-9]+}}, "steps": {{[1-9][0-9]*}}, "nodes": {{[1-9][0-9]*}}, "max-steps-reached": false, "blocks-exhausted": true, "wall": {{[0-9.]+}}, "user": {{[0-9.]+}}, "memory": {{-?[0-9]+}} }
+// CHECK-NEXT: ]
+
+// BUDGET: "name": "caller"
+// BUDGET-SAME: "max-steps-reached": true
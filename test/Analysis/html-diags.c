@@ -8,6 +8,17 @@
 // RUN: %clang_cc1 -analyze -analyzer-output=html -analyzer-checker=core -o testrelative %s
 // RUN: ls %T/dir/testrelative | grep report
 
+// Reports that share a single highlighted copy of the source file.
+// RUN: rm -fR %T/shared
+// RUN: %clang_cc1 -analyze -analyzer-output=html -analyzer-checker=core -analyzer-config html-shared-source=true -o %T/shared %s
+// RUN: ls %T/shared | FileCheck -check-prefix=SHARED-FILES %s
+// RUN: cat %T/shared/report-*.html | FileCheck -check-prefix=SHARED-REPORT %s
+// SHARED-FILES: report-
+// SHARED-FILES: source-html-diags.c-{{[0-9a-f]+}}.html
+// SHARED-REPORT: <!-- BUGMETAEND -->
+// SHARED-REPORT: <a href="source-html-diags.c-{{[0-9a-f]+}}.html#LN{{[0-9]+}}">
+// SHARED-REPORT: id="EndPath"
+
 // Currently this test mainly checks that the HTML diagnostics doesn't crash
 // when handling macros will calls with macros.  We should actually validate
 // the output, but that requires being able to match against a specifically
@@ -0,0 +1,40 @@
+// REQUIRES: shell
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -verify %s
+// (sanity check)
+
+// RUN: rm -rf %t.dir
+// RUN: mkdir -p %t.dir/plist %t.dir/both
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-output=plist -o %t.dir/plist/index.plist %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-output=plist-html -o %t.dir/both/index.plist %s
+
+// With several consumers, the trimmed graph of each bug class is built for
+// the first consumer and reused for the others. Every consumer must still
+// get the same paths: the plist is the same as without the HTML consumer,
+// apart from the references to the HTML files, and every bug has a complete
+// HTML report.
+// RUN: grep -v -e 'array>' -e HTMLDiagnostics_files -e '\.html' %t.dir/plist/index.plist > %t.dir/plist.filtered
+// RUN: grep -v -e 'array>' -e HTMLDiagnostics_files -e '\.html' %t.dir/both/index.plist > %t.dir/both.filtered
+// RUN: diff %t.dir/plist.filtered %t.dir/both.filtered
+// RUN: ls %t.dir/both | grep \\.html | count 3
+// RUN: grep \\.html %t.dir/both/index.plist | count 3
+// RUN: grep -l "Assuming 'a' is null" %t.dir/both/*.html | count 1
+// RUN: grep -l "Assuming 'x' is 0" %t.dir/both/*.html | count 1
+// RUN: grep -l "declared without an initial value" %t.dir/both/*.html | count 1
+
+void null_deref(int *a) {
+  if (a)
+    return;
+  *a = 1; // expected-warning{{null}}
+}
+
+int div_zero(int x) {
+  int y = 0;
+  if (x)
+    y = 1;
+  return x / y; // expected-warning{{Division by zero}}
+}
+
+int garbage(void) {
+  int u;
+  return u + 1; // expected-warning{{garbage value}}
+}
@@ -0,0 +1,37 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=alpha.security.taint,core -analyzer-config alpha.security.taint.TaintPropagation:Config=%S/Inputs/taint-generic-config.txt -Wno-analyzer-taint-config -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=alpha.security.taint,core -analyzer-config alpha.security.taint.TaintPropagation:Config=%S/Inputs/taint-generic-config.txt %s 2>&1 | FileCheck %s
+
+// CHECK: warning: {{.*}}taint-generic-config.txt:7: ignoring malformed taint rule 'this line is not a rule'
+// CHECK: warning: {{.*}}taint-generic-config.txt:8: ignoring malformed taint rule 'propagate myTransform2  ret -> 0'
+// CHECK-NOT: ignoring malformed taint rule
+
+int mySource(void);
+void myReadInto(char *buf);
+int myTransform(int);
+void mySystem(const char *command);
+void myUseInt(int);
+void myReadInto2(char *buf);
+void myCopy(int);
+
+void testConfiguredSource() {
+  char cmd[16];
+  myReadInto(cmd);
+  mySystem(cmd); // expected-warning {{Untrusted data is passed to a system call}}
+}
+
+void testConfiguredPropagation() {
+  myUseInt(myTransform(mySource())); // expected-warning {{Untrusted data is passed to a system call}}
+}
+
+void testUntainted(char *cmd) {
+  myUseInt(myTransform(1)); // no-warning
+  mySystem(cmd); // no-warning
+}
+
+// Argument indexes past the end of the call are ignored rather than trusted.
+void testOutOfRangeIndexes() {
+  char cmd[16];
+  myReadInto2(cmd);
+  mySystem(cmd); // no-warning
+  myCopy(mySource()); // no-warning
+}
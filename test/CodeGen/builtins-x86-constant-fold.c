@@ -0,0 +1,64 @@
+// RUN: %clang_cc1 %s -triple x86_64-unknown-unknown -target-feature +avx2 -emit-llvm -o - | FileCheck %s
+
+typedef char v16qi __attribute__((vector_size(16)));
+typedef int v4si __attribute__((vector_size(16)));
+typedef char v32qi __attribute__((vector_size(32)));
+typedef int v8si __attribute__((vector_size(32)));
+
+// Integer SIMD builtins with constant operands are usable in constant
+// initializers and are folded instead of emitted as intrinsic calls.
+
+// CHECK: @adds = global <16 x i8> <i8 127, i8 -128, i8 3, i8 0,
+v16qi adds = __builtin_ia32_paddsb128((v16qi){100, -100, 1},
+                                      (v16qi){100, -100, 2});
+
+// CHECK: @addus = global <16 x i8> <i8 -1, i8 30, i8 0,
+v16qi addus = __builtin_ia32_paddusb128((v16qi){-56, 10}, (v16qi){100, 20});
+
+// CHECK: @subus = global <16 x i8> <i8 0, i8 40, i8 0,
+v16qi subus = __builtin_ia32_psubusb128((v16qi){10, 50}, (v16qi){20, 10});
+
+// CHECK: @avg = global <16 x i8> <i8 2, i8 -1, i8 0,
+v16qi avg = __builtin_ia32_pavgb128((v16qi){1, -1}, (v16qi){2, -1});
+
+// CHECK: @maxs = global <16 x i8> <i8 1, i8 5, i8 0,
+v16qi maxs = __builtin_ia32_pmaxsb128((v16qi){-1, 5}, (v16qi){1, 3});
+
+// CHECK: @maxu = global <16 x i8> <i8 -1, i8 5, i8 0,
+v16qi maxu = __builtin_ia32_pmaxub128((v16qi){-1, 5}, (v16qi){1, 3});
+
+// CHECK: @mullo = global <4 x i32> <i32 15, i32 -14, i32 0, i32 0>
+v4si mullo = __builtin_ia32_pmulld128((v4si){3, -2}, (v4si){5, 7});
+
+// CHECK: @abs = global <8 x i32> <i32 5, i32 7, i32 -2147483648, i32 0,
+v8si abs = __builtin_ia32_pabsd256((v8si){-5, 7, -2147483647 - 1});
+
+// CHECK: @shuf = global <16 x i8> <i8 15, i8 0, i8 0, i8 1, i8 0,
+v16qi shuf = __builtin_ia32_pshufb128(
+    (v16qi){0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+    (v16qi){15, 0, -128, 1});
+
+// pshufb256 shuffles within each 128-bit lane.
+// CHECK: @shuf256 = global <32 x i8> <i8 1, i8 0, {{.*}}, i8 17, i8 16, i8 16,
+v32qi shuf256 = __builtin_ia32_pshufb256(
+    (v32qi){0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+            16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31},
+    (v32qi){1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            1, 0});
+
+// CHECK-LABEL: define <16 x i8> @fold_in_function(
+// CHECK-NOT: call <16 x i8> @llvm.x86.sse2.padds.b
+// CHECK: store <16 x i8> <i8 127, i8 -128, i8 3,
+// CHECK-NOT: call <16 x i8> @llvm.x86.sse2.padds.b
+// CHECK: ret <16 x i8>
+v16qi fold_in_function(void) {
+  return __builtin_ia32_paddsb128((v16qi){100, -100, 1},
+                                  (v16qi){100, -100, 2});
+}
+
+// Operands which are not constant still produce the intrinsic call.
+// CHECK-LABEL: define <16 x i8> @no_fold(
+// CHECK: call <16 x i8> @llvm.x86.sse2.padds.b
+v16qi no_fold(v16qi a) {
+  return __builtin_ia32_paddsb128(a, (v16qi){1});
+}
@@ -0,0 +1,20 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm-only -verify %s \
+// RUN:   -fcodegen-partition=0/2
+
+static int counter; // expected-error {{cannot partition code generation of a translation unit with mutable variable 'counter' of internal linkage}}
+int first(void) { return ++counter; }
+
+static int next_id(void) {
+  static int id; // expected-error {{cannot partition code generation of a translation unit with mutable variable 'id' of internal linkage}}
+  return ++id;
+}
+int second(void) { return next_id(); }
+
+// Constant data and the static locals of externally visible functions are
+// never duplicated.
+static const int limits[] = { 1, 2 };
+int fourth(int i) {
+  static int calls;
+  ++calls;
+  return limits[i];
+}
@@ -0,0 +1,42 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-ast -o %t.ast %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -o - %t.ast \
+// RUN:   -fcodegen-partition=0/2 \
+// RUN:   | FileCheck --check-prefix=P0 --implicit-check-not="define i32 @third" %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -o - %t.ast \
+// RUN:   -fcodegen-partition=1/2 \
+// RUN:   | FileCheck --check-prefix=P1 --implicit-check-not="define i32 @first" \
+// RUN:     --implicit-check-not=@alias_of_first %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -o - %s \
+// RUN:   -fcodegen-partition=0/1 | FileCheck --check-prefix=ALL %s
+// RUN: not %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -o - %s \
+// RUN:   -fcodegen-partition=2/2 2>&1 | FileCheck --check-prefix=INVALID %s
+
+// INVALID: error: invalid value '2/2' in '-fcodegen-partition=2/2'
+
+// Functions with internal linkage are emitted by every partition using them.
+static int helper(int x) { return x * 2; }
+
+// P0-DAG: @global_a = external global i32
+// P0-DAG: @global_b = global i32 2
+// P1-DAG: @global_a = global i32 1
+// P1-DAG: @global_b = external global i32
+// ALL-DAG: @global_a = global i32 1
+// ALL-DAG: @global_b = global i32 2
+int global_a = 1;
+int global_b = 2;
+
+// P0-DAG: define i32 @first(
+// P0-DAG: define internal i32 @helper(
+// P1-DAG: declare i32 @first(
+// ALL-DAG: define i32 @first(
+int first(int x) { return helper(x) + global_a; }
+
+// P1-DAG: define i32 @third(
+// P1-DAG: define internal i32 @helper(
+// ALL-DAG: define i32 @third(
+int third(int x) { return helper(x) + first(x) + global_b; }
+
+// An alias is emitted along with its aliasee.
+// P0-DAG: @alias_of_first = alias
+// ALL-DAG: @alias_of_first = alias
+int alias_of_first(int) __attribute__((alias("first")));
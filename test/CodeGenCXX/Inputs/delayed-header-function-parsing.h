@@ -0,0 +1,10 @@
+template <typename T> T usedTemplate() { return 1; }
+template <typename T> T unusedTemplate() { return 2; }
+
+template <typename T> struct S {
+  T usedMember() { return 3; }
+  T unusedMember() { return 4; }
+  virtual T virtualMember() { return 5; }
+};
+
+template <typename T> T explicitlyInstantiated() { return 6; }
@@ -0,0 +1,27 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm-only -verify %s \
+// RUN:   -fcodegen-partition=0/2
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm-only -verify %s \
+// RUN:   -fcodegen-partition=1/2
+
+// Every partition would register its own initializers, losing the order of
+// dynamic initialization and destruction within the translation unit.
+
+int compute();
+struct Guard {
+  Guard();
+  ~Guard();
+};
+
+// Internal variables are emitted by every partition, so both diagnose them.
+static const int table_size = compute(); // expected-error {{cannot partition code generation of a translation unit with dynamically initialized or destroyed variable 'table_size'}}
+int size() { return table_size; }
+
+static const Guard guard; // expected-error {{cannot partition code generation of a translation unit with dynamically initialized or destroyed variable 'guard'}}
+const Guard *get_guard() { return &guard; }
+
+// Constant initialization and template instantiations, which are unordered,
+// are fine.
+int constant = 42;
+template <typename T> struct Holder { static int value; };
+template <typename T> int Holder<T>::value = compute();
+int held() { return Holder<int>::value; }
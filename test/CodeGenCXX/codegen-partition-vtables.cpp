@@ -0,0 +1,38 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-ast -o %t.ast %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -o - %t.ast \
+// RUN:   -fcodegen-partition=0/2 \
+// RUN:   | FileCheck --check-prefix=P0 --implicit-check-not=_ZTI1C \
+// RUN:     --implicit-check-not=_ZTT1C %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -o - %t.ast \
+// RUN:   -fcodegen-partition=1/2 | FileCheck --check-prefix=P1 %s
+
+// The v-table, VTT and type info of a dynamic class are emitted by the
+// partition of its key function, and only declared by the others.
+
+// P0-DAG: @_ZTV1A = {{(unnamed_addr )?}}constant
+// P0-DAG: @_ZTI1A = constant
+// P1-DAG: @_ZTV1A = external {{(unnamed_addr )?}}constant
+// P1-DAG: @_ZTI1A = external constant
+struct A {
+  virtual int g();
+};
+
+// P0-DAG: define i32 @_ZN1A1gEv(
+int A::g() { return 1; }
+
+// P0-DAG: @_ZTV1C = external {{(unnamed_addr )?}}constant
+// P1-DAG: @_ZTV1C = {{(unnamed_addr )?}}constant
+// P1-DAG: @_ZTT1C = {{(unnamed_addr )?}}constant
+// P1-DAG: @_ZTI1C = constant
+struct C : virtual A {
+  virtual int h();
+};
+
+// P1-DAG: define i32 @_ZN1C1hEv(
+int C::h() { return 2; }
+
+// P0-DAG: define {{.*}}@_Z6use_cv(
+C *use_c() { return new C; }
+
+// P1-DAG: define {{.*}}@_Z7createAv(
+A *createA() { return new A; }
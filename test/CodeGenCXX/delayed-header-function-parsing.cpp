@@ -0,0 +1,22 @@
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-llvm -fdelayed-header-function-parsing -I %S/Inputs %s -o - | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-llvm -fdelayed-header-function-parsing -I %S/Inputs %s -o - | FileCheck %s --check-prefix=UNUSED
+
+// The delayed bodies of the templates that are instantiated are emitted.
+
+#include "delayed-header-function-parsing.h"
+
+template int explicitlyInstantiated<int>();
+
+S<int> make() { return S<int>(); }
+
+int use(S<int> &s) {
+  return usedTemplate<int>() + s.usedMember();
+}
+
+// CHECK-DAG: define weak_odr i32 @_Z22explicitlyInstantiatedIiET_v()
+// CHECK-DAG: define linkonce_odr i32 @_Z12usedTemplateIiET_v()
+// CHECK-DAG: define linkonce_odr i32 @_ZN1SIiE10usedMemberEv(
+// CHECK-DAG: define linkonce_odr i32 @_ZN1SIiE13virtualMemberEv(
+
+// UNUSED-NOT: unusedTemplate
+// UNUSED-NOT: unusedMember
@@ -0,0 +1 @@
+int x = ; // expected-error {{expected expression}}
@@ -0,0 +1,11 @@
+// REQUIRES: shell
+// RUN: cd %S/Inputs/cc1batch && %clang -cc1batch < jobs.txt | FileCheck %s
+
+// Each job reports its exit code and the length of its output, followed by
+// its output.
+// CHECK: 0 0
+// CHECK-NEXT: 0 0
+// CHECK-NEXT: 1 {{[0-9]+}}
+// CHECK-NEXT: error.c:1:9: error: expected expression
+// CHECK: 1 {{[0-9]+}}
+// CHECK-NEXT: error: cannot change to directory 'does-not-exist'
@@ -0,0 +1,6 @@
+// RUN: %clang -### -c -fcompilation-cache-path=/tmp/cache -fcompilation-cache-size=100 %s 2>&1 | FileCheck %s
+// CHECK: "-cc1"
+// CHECK: "-fcompilation-cache-path=/tmp/cache" "-fcompilation-cache-size=100"
+
+// RUN: %clang -### -c %s 2>&1 | FileCheck -check-prefix=NOCACHE %s
+// NOCACHE-NOT: -fcompilation-cache
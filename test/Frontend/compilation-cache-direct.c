@@ -0,0 +1,53 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: echo 'int value(void) { return 1; }' > %t/value.h
+// RUN: touch -t 200001010000 %t/value.h
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -I %t -Rcompilation-cache -fcompilation-cache-path=%t/cache %s -o %t/a.ll 2>&1 | FileCheck -check-prefix=MISS %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -I %t -Rcompilation-cache -fcompilation-cache-path=%t/cache %s -o %t/b.ll 2>&1 | FileCheck -check-prefix=DIRECT %s
+// RUN: diff %t/a.ll %t/b.ll
+//
+// A header changing without changing size no longer matches the manifest.
+// RUN: echo 'int value(void) { return 2; }' > %t/value.h
+// RUN: touch -t 200001010000 %t/value.h
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -I %t -Rcompilation-cache -fcompilation-cache-path=%t/cache %s -o %t/c.ll 2>&1 | FileCheck -check-prefix=MISS %s
+// RUN: FileCheck -check-prefix=VALUE2 %s < %t/c.ll
+//
+// The manifest remembers both versions of the header.
+// RUN: echo 'int value(void) { return 1; }' > %t/value.h
+// RUN: touch -t 200001010000 %t/value.h
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -I %t -Rcompilation-cache -fcompilation-cache-path=%t/cache %s -o %t/d.ll 2>&1 | FileCheck -check-prefix=DIRECT %s
+// RUN: diff %t/a.ll %t/d.ll
+//
+// Without direct mode, the key is always computed by preprocessing.
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -I %t -Rcompilation-cache -fcompilation-cache-path=%t/cache -fno-compilation-cache-direct %s -o %t/e.ll 2>&1 | FileCheck -check-prefix=PREPROCESSED %s
+//
+// An entry found by preprocessing is added to the manifest.
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -I %t -Rcompilation-cache -fcompilation-cache-path=%t/cache2 -fno-compilation-cache-direct %s -o %t/h.ll 2>&1 | FileCheck -check-prefix=MISS %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -I %t -Rcompilation-cache -fcompilation-cache-path=%t/cache2 %s -o %t/i.ll 2>&1 | FileCheck -check-prefix=PREPROCESSED-HIT %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -I %t -Rcompilation-cache -fcompilation-cache-path=%t/cache2 %s -o %t/j.ll 2>&1 | FileCheck -check-prefix=DIRECT %s
+//
+// Compilations expanding __TIME__ are not cached.
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -I %t -Rcompilation-cache -fcompilation-cache-path=%t/cache -DUSE_TIME %s -o %t/f.ll 2>&1 | FileCheck -check-prefix=UNCACHED -allow-empty %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -I %t -Rcompilation-cache -fcompilation-cache-path=%t/cache -DUSE_TIME %s -o %t/g.ll 2>&1 | FileCheck -check-prefix=UNCACHED -allow-empty %s
+
+#include "value.h"
+
+int f(void) { return value(); }
+
+#ifdef USE_TIME
+const char *Time = __TIME__;
+#endif
+
+// MISS-NOT: through manifest
+// MISS: remark: caching the outputs of the compilation in '{{.*}}.entry'
+
+// DIRECT: remark: found the cached compilation through manifest '{{.*}}.manifest'
+// DIRECT-NEXT: remark: reusing the outputs of the compilation cached in '{{.*}}.entry'
+
+// VALUE2: ret i32 2
+
+// PREPROCESSED-NOT: through manifest
+
+// PREPROCESSED-HIT-NOT: through manifest
+// PREPROCESSED-HIT: remark: reusing the outputs of the compilation cached in '{{.*}}.entry'
+
+// UNCACHED-NOT: remark:
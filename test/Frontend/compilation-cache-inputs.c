@@ -0,0 +1,46 @@
+// RUN: rm -rf %t && mkdir -p %t/inc
+// RUN: echo 'fun:other' > %t/blacklist.txt
+// RUN: touch -t 200001010000 %t/blacklist.txt
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -I %t/inc -fsanitize=address -fsanitize-blacklist=%t/blacklist.txt -Rcompilation-cache -fcompilation-cache-path=%t/cache %s -o %t/a.ll 2>&1 | FileCheck -check-prefix=MISS %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -I %t/inc -fsanitize=address -fsanitize-blacklist=%t/blacklist.txt -Rcompilation-cache -fcompilation-cache-path=%t/cache %s -o %t/b.ll 2>&1 | FileCheck -check-prefix=DIRECT %s
+//
+// The contents of the files named by the arguments are part of the key.
+// RUN: echo 'fun:f' > %t/blacklist.txt
+// RUN: touch -t 200001010000 %t/blacklist.txt
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -I %t/inc -fsanitize=address -fsanitize-blacklist=%t/blacklist.txt -Rcompilation-cache -fcompilation-cache-path=%t/cache %s -o %t/c.ll 2>&1 | FileCheck -check-prefix=MISS %s
+// RUN: echo 'fun:other' > %t/blacklist.txt
+// RUN: touch -t 200001010000 %t/blacklist.txt
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -I %t/inc -fsanitize=address -fsanitize-blacklist=%t/blacklist.txt -Rcompilation-cache -fcompilation-cache-path=%t/cache -fno-compilation-cache-direct %s -o %t/d.ll 2>&1 | FileCheck -check-prefix=PREPROCESSED-HIT %s
+// RUN: diff %t/a.ll %t/d.ll
+//
+// A header appearing where __has_include found none changes the key, even
+// though it is never entered.
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -I %t/inc -Rcompilation-cache -fcompilation-cache-path=%t/cache2 %s -o %t/e.ll 2>&1 | FileCheck -check-prefix=MISS %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -I %t/inc -Rcompilation-cache -fcompilation-cache-path=%t/cache2 -fno-compilation-cache-direct %s -o %t/f.ll 2>&1 | FileCheck -check-prefix=PREPROCESSED-HIT %s
+// RUN: touch -t 200001010000 %t/inc/compilation-cache-probed.h
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -I %t/inc -Rcompilation-cache -fcompilation-cache-path=%t/cache2 %s -o %t/g.ll 2>&1 | FileCheck -check-prefix=MISS %s
+// RUN: FileCheck -check-prefix=PROBED %s < %t/g.ll
+// RUN: rm %t/inc/compilation-cache-probed.h
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -I %t/inc -Rcompilation-cache -fcompilation-cache-path=%t/cache2 -fno-compilation-cache-direct %s -o %t/h.ll 2>&1 | FileCheck -check-prefix=PREPROCESSED-HIT %s
+// RUN: touch -t 200001010000 %t/inc/compilation-cache-probed.h
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -I %t/inc -Rcompilation-cache -fcompilation-cache-path=%t/cache2 -fno-compilation-cache-direct %s -o %t/i.ll 2>&1 | FileCheck -check-prefix=PREPROCESSED-HIT %s
+// RUN: FileCheck -check-prefix=PROBED %s < %t/i.ll
+
+#if __has_include("compilation-cache-probed.h")
+#define PROBED 1
+#else
+#define PROBED 0
+#endif
+
+int f(void) { return PROBED; }
+
+// MISS-NOT: through manifest
+// MISS: remark: caching the outputs of the compilation in '{{.*}}.entry'
+
+// DIRECT: remark: found the cached compilation through manifest '{{.*}}.manifest'
+// DIRECT-NEXT: remark: reusing the outputs of the compilation cached in '{{.*}}.entry'
+
+// PREPROCESSED-HIT-NOT: through manifest
+// PREPROCESSED-HIT: remark: reusing the outputs of the compilation cached in '{{.*}}.entry'
+
+// PROBED: ret i32 1
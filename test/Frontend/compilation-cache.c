@@ -0,0 +1,43 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -Rcompilation-cache -fcompilation-cache-path=%t/cache -dependency-file %t/a.d -MT out.o %s -o %t/a.ll 2>&1 | FileCheck -check-prefix=MISS %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -Rcompilation-cache -fcompilation-cache-path=%t/cache -dependency-file %t/b.d -MT out.o %s -o %t/b.ll 2>&1 | FileCheck -check-prefix=HIT %s
+// RUN: diff %t/a.ll %t/b.ll
+// RUN: diff %t/a.d %t/b.d
+//
+// Paths that do not end up in the outputs and colors do not affect the key.
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -Rcompilation-cache -fcompilation-cache-path=%t/cache -dependency-file %t/d.d -MT out.o %s -o %t/d.ll -coverage-file %t/d.o -fdebug-compilation-dir %t -fcolor-diagnostics 2>&1 | FileCheck -check-prefix=COLOR %s
+// RUN: diff %t/a.ll %t/d.ll
+//
+// Changing the input misses the cache.
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -Rcompilation-cache -fcompilation-cache-path=%t/cache -dependency-file %t/c.d -MT out.o %s -o %t/c.ll -DVALUE=2 2>&1 | FileCheck -check-prefix=MISS %s
+// RUN: FileCheck -check-prefix=VALUE2 %s < %t/c.ll
+//
+// Compilations that do not produce an object file are not cached.
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -fsyntax-only -Rcompilation-cache -fcompilation-cache-path=%t/cache %s 2>&1 | FileCheck -check-prefix=UNCACHED %s
+
+#ifndef VALUE
+#define VALUE 1
+#endif
+
+int f(void) { return VALUE; }
+
+#warning cached warning
+
+// MISS: warning: cached warning
+// MISS: 1 warning generated.
+// MISS: remark: caching the outputs of the compilation in '{{.*}}.entry'
+
+// HIT: warning: cached warning
+// HIT: 1 warning generated.
+// HIT: remark: reusing the outputs of the compilation cached in '{{.*}}.entry'
+// HIT-NOT: caching the outputs
+
+// The replayed diagnostics have no colors.
+// COLOR: warning: cached warning
+// COLOR: 1 warning generated.
+// COLOR: reusing the outputs of the compilation cached in '{{.*}}.entry'
+
+// VALUE2: ret i32 2
+
+// UNCACHED: warning: cached warning
+// UNCACHED-NOT: remark:
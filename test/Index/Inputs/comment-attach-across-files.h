@@ -0,0 +1,6 @@
+/// Documentation of isDoxygenInHeader.
+void isDoxygenInHeader(void);
+
+int notdoxygenInHeader;
+
+/// Last comment of the header, not attached to anything.
@@ -0,0 +1,38 @@
+// With clang_attachCommentsToDecls(), comments are attached to all the
+// declarations of a file at once; make sure that comments in one file are not
+// attached to declarations in another one, and that the results match those
+// of the queries for single declarations.
+
+/// Comment before the include, not attached to anything.
+#include "Inputs/comment-attach-across-files.h"
+void notdoxygenAfterInclude(void);
+
+void isDoxygenInHeader(void);
+
+struct Record {
+  int isDoxygenTrailing; ///< Trailing comment of isDoxygenTrailing.
+  /// Documentation of isDoxygenField.
+  int isDoxygenField;
+  int notdoxygenField;
+};
+
+/// Documentation of isDoxygenVar.
+int isDoxygenVar;
+
+// RUN: c-index-test -test-load-source all %s > %t.single
+// RUN: env CINDEXTEST_ATTACH_COMMENTS=1 c-index-test -test-load-source all %s > %t.direct
+// RUN: env CINDEXTEST_ATTACH_COMMENTS=1 CINDEXTEST_EDITING=1 c-index-test -test-load-source-reparse 1 all %s > %t.reparse
+// RUN: FileCheck %s < %t.single
+// RUN: FileCheck %s < %t.direct
+// RUN: FileCheck %s < %t.reparse
+// RUN: FileCheck %s -check-prefix=WRONG < %t.direct
+// RUN: FileCheck %s -check-prefix=WRONG < %t.reparse
+// RUN: diff %t.single %t.direct
+
+// WRONG-NOT: notdoxygen{{.*}}Comment=
+
+// CHECK: comment-attach-across-files.h:2:6: FunctionDecl=isDoxygenInHeader:{{.*}} RawComment=[/// Documentation of isDoxygenInHeader.]{{.*}} BriefComment=[Documentation of isDoxygenInHeader.]
+// CHECK: comment-attach-across-files.c:9:6: FunctionDecl=isDoxygenInHeader:{{.*}} RawComment=[/// Documentation of isDoxygenInHeader.]{{.*}} BriefComment=[Documentation of isDoxygenInHeader.]
+// CHECK: comment-attach-across-files.c:12:7: FieldDecl=isDoxygenTrailing:{{.*}} RawComment=[///< Trailing comment of isDoxygenTrailing.]{{.*}} BriefComment=[Trailing comment of isDoxygenTrailing.]
+// CHECK: comment-attach-across-files.c:14:7: FieldDecl=isDoxygenField:{{.*}} RawComment=[/// Documentation of isDoxygenField.]{{.*}} BriefComment=[Documentation of isDoxygenField.]
+// CHECK: comment-attach-across-files.c:19:5: VarDecl=isDoxygenVar:{{.*}} RawComment=[/// Documentation of isDoxygenVar.]{{.*}} BriefComment=[Documentation of isDoxygenVar.]
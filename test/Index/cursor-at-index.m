@@ -0,0 +1,45 @@
+#define ADD(a, b) ((a) + (b))
+#define FIELD(name) int name;
+
+struct Outer {
+  struct Inner {
+    FIELD(x)
+    int y;
+  } inner;
+};
+
+__attribute__((objc_root_class))
+@interface Foo
+- (int)method:(int)a with:(int)b;
+@end
+
+@implementation Foo
+- (int)method:(int)a with:(int)b {
+  struct Outer o;
+  int r = [self method:a with:b];
+  return ADD(o.inner.y, r);
+}
+@end
+
+// The cursors found through the index match those found by walking the AST,
+// including in nested declarations, macro expansions and selector pieces.
+// RUN: c-index-test -cursor-at=%s:5:10 -cursor-at=%s:6:5 -cursor-at=%s:6:11 -cursor-at=%s:7:9 -cursor-at=%s:8:5 -cursor-at=%s:13:8 -cursor-at=%s:13:22 -cursor-at=%s:13:20 -cursor-at=%s:17:22 -cursor-at=%s:18:10 -cursor-at=%s:18:16 -cursor-at=%s:19:7 -cursor-at=%s:19:12 -cursor-at=%s:19:17 -cursor-at=%s:19:26 -cursor-at=%s:19:31 -cursor-at=%s:20:10 -cursor-at=%s:20:14 -cursor-at=%s:20:16 -cursor-at=%s:20:22 -cursor-at=%s:20:25 %s > %t.index
+// RUN: env LIBCLANG_DISABLE_CURSOR_INDEX=1 c-index-test -cursor-at=%s:5:10 -cursor-at=%s:6:5 -cursor-at=%s:6:11 -cursor-at=%s:7:9 -cursor-at=%s:8:5 -cursor-at=%s:13:8 -cursor-at=%s:13:22 -cursor-at=%s:13:20 -cursor-at=%s:17:22 -cursor-at=%s:18:10 -cursor-at=%s:18:16 -cursor-at=%s:19:7 -cursor-at=%s:19:12 -cursor-at=%s:19:17 -cursor-at=%s:19:26 -cursor-at=%s:19:31 -cursor-at=%s:20:10 -cursor-at=%s:20:14 -cursor-at=%s:20:16 -cursor-at=%s:20:22 -cursor-at=%s:20:25 %s > %t.walk
+// RUN: diff %t.index %t.walk
+// RUN: FileCheck %s < %t.index
+
+// CHECK: StructDecl=Inner:5:10 (Definition)
+// CHECK: MacroExpansion=FIELD:6:5
+// CHECK: FieldDecl=y:7:9 (Definition)
+// CHECK: FieldDecl=inner:8:5 (Definition)
+// CHECK: ObjCInstanceMethodDecl=method:with::13:8 {{.*}}Selector index=0
+// CHECK: ObjCInstanceMethodDecl=method:with::13:8 {{.*}}Selector index=1
+// CHECK: ParmDecl=a:13:20
+// CHECK: ObjCInstanceMethodDecl=method:with::17:8 (Definition) {{.*}}Selector index=1
+// CHECK: TypeRef=struct Outer:4:8
+// CHECK: VarDecl=o:18:16 (Definition)
+// CHECK: VarDecl=r:19:7 (Definition)
+// CHECK: ObjCMessageExpr=method:with:{{.*}}Selector index=0
+// CHECK: ObjCMessageExpr=method:with:{{.*}}Selector index=1
+// CHECK: DeclRefExpr=b:17:{{[0-9]+}}
+// CHECK: MacroExpansion=ADD:20:10
@@ -0,0 +1,41 @@
+namespace ns {
+struct Point { int x, y; };
+typedef Point P;
+}
+
+#define SQUARE(x) ((x) * (x))
+
+int length(ns::P p) {
+  int v = SQUARE(p.x);
+  return v + p.y;
+}
+
+// RUN: c-index-test -test-semantic-tokens=%s:1:1:12:1 %s | FileCheck %s
+// RUN: env CINDEXTEST_EDITING=1 c-index-test -test-semantic-tokens=%s:1:1:12:1 %s | FileCheck %s
+// CHECK: Namespace: [1:11 - 1:13] declaration
+// CHECK-NEXT: StructDecl: [2:8 - 2:13] declaration
+// CHECK-NEXT: FieldDecl: [2:20 - 2:21] declaration
+// CHECK-NEXT: FieldDecl: [2:23 - 2:24] declaration
+// CHECK-NEXT: StructDecl: [3:9 - 3:14]{{$}}
+// CHECK-NEXT: TypedefDecl: [3:15 - 3:16] declaration
+// CHECK-NEXT: macro definition: [6:9 - 6:15] declaration
+// CHECK-NEXT: FunctionDecl: [8:5 - 8:11] declaration
+// CHECK-NEXT: Namespace: [8:12 - 8:14]{{$}}
+// CHECK-NEXT: TypedefDecl: [8:16 - 8:17]{{$}}
+// CHECK-NEXT: ParmDecl: [8:18 - 8:19] declaration
+// CHECK-NEXT: VarDecl: [9:7 - 9:8] declaration
+// CHECK-NEXT: macro definition: [9:11 - 9:17]{{$}}
+// CHECK-NEXT: ParmDecl: [9:18 - 9:19]{{$}}
+// CHECK-NEXT: FieldDecl: [9:20 - 9:21]{{$}}
+// CHECK-NEXT: VarDecl: [10:10 - 10:11]{{$}}
+// CHECK-NEXT: ParmDecl: [10:14 - 10:15]{{$}}
+// CHECK-NEXT: FieldDecl: [10:16 - 10:17]{{$}}
+// CHECK-NOT: {{\[}}
+
+// RUN: c-index-test -test-semantic-tokens=%s:9:1:10:1 %s | FileCheck -check-prefix=CHECK-RANGE %s
+// CHECK-RANGE-NOT: [8:
+// CHECK-RANGE: VarDecl: [9:7 - 9:8] declaration
+// CHECK-RANGE-NEXT: macro definition: [9:11 - 9:17]
+// CHECK-RANGE-NEXT: ParmDecl: [9:18 - 9:19]
+// CHECK-RANGE-NEXT: FieldDecl: [9:20 - 9:21]
+// CHECK-RANGE-NOT: [10:
@@ -0,0 +1,2 @@
+int d(void);
+#warning "in module d"
@@ -0,0 +1 @@
+int quoted(void);
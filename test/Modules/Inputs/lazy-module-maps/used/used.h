@@ -0,0 +1 @@
+int used(void);
@@ -0,0 +1,37 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t \
+// RUN:   -I %S/Inputs/build-jobs -fmodules-build-jobs=4 -Rmodule-build \
+// RUN:   -fsyntax-only %s 2>&1 | FileCheck %s
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t \
+// RUN:   -I %S/Inputs/build-jobs -fmodules-build-jobs=4 -Rmodule-build \
+// RUN:   -fsyntax-only %s 2>&1 | FileCheck --check-prefix=CACHED \
+// RUN:   --allow-empty %s
+// RUN: %clang -### -fmodules -fmodules-build-jobs=4 -c %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=DRIVER %s
+
+// The modules imported by top.h and by this file are found by scanning
+// their headers, and are all built before the compilation continues. The
+// diagnostics of the builds are reported by the importing compilation.
+#include "top.h"
+#include "d.h"
+
+// CHECK-DAG: remark: building module 'top' as
+// CHECK-DAG: remark: building module 'a' as
+// CHECK-DAG: remark: building module 'b' as
+// CHECK-DAG: remark: building module 'c' as
+// CHECK-DAG: remark: building module 'd' as
+// CHECK: remark: building 5 modules with up to 4 concurrent jobs
+// CHECK-DAG: remark: finished building module 'top'
+// CHECK-DAG: remark: finished building module 'a'
+// CHECK-DAG: remark: finished building module 'b'
+// CHECK-DAG: remark: finished building module 'c'
+// CHECK-DAG: remark: finished building module 'd'
+// CHECK-DAG: build-jobs{{/|\\}}d.h:2:2: warning: "in module d"
+// CHECK-NOT: remark: building module
+
+// CACHED-NOT: remark: building module
+// CACHED-NOT: warning:
+
+// DRIVER: "-fmodules-build-jobs=4"
+
+int main(void) { return top() + a() + b() + c() + d(); }
@@ -0,0 +1,23 @@
+// RUN: rm -rf %t
+// Build the modules and the global module index.
+// RUN: %clang_cc1 -fmodules-cache-path=%t -fdisable-module-hash -fmodules -fimplicit-module-maps -I %S/Inputs %s -verify
+// RUN: ls %t | grep modules.idx
+// Use the global module index to find the module files with each selector.
+// RUN: %clang_cc1 -fmodules-cache-path=%t -fdisable-module-hash -fmodules -fimplicit-module-maps -I %S/Inputs %s -verify -print-stats 2>&1 | FileCheck %s
+
+// expected-no-diagnostics
+@import MethodPoolA;
+@import MethodPoolB;
+
+void testMethod1(id object) {
+  [object method1];
+}
+
+void testMethod1Again(id object) {
+  [object method1];
+}
+
+// CHECK: method pool lookups needed no module file search
+// CHECK: methods read from method pools
+// CHECK: *** Global Module Index Statistics:
+// CHECK: selector lookups succeeded
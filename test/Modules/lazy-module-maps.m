@@ -0,0 +1,39 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t \
+// RUN:   -fmodules-lazy-module-maps -I %S/Inputs/lazy-module-maps/broken \
+// RUN:   -I %S/Inputs/lazy-module-maps/used \
+// RUN:   -I %S/Inputs/lazy-module-maps/quoted -fsyntax-only -verify %s
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t \
+// RUN:   -fmodules-lazy-module-maps -I %S/Inputs/lazy-module-maps/broken \
+// RUN:   -I %S/Inputs/lazy-module-maps/used \
+// RUN:   -I %S/Inputs/lazy-module-maps/quoted -fsyntax-only -print-stats %s \
+// RUN:   2>&1 | FileCheck %s
+// RUN: not %clang_cc1 -fmodules -fimplicit-module-maps \
+// RUN:   -fmodules-cache-path=%t -I %S/Inputs/lazy-module-maps/broken \
+// RUN:   -I %S/Inputs/lazy-module-maps/used \
+// RUN:   -I %S/Inputs/lazy-module-maps/quoted -fsyntax-only %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=EAGER %s
+// RUN: %clang -### -fmodules -fmodules-lazy-module-maps -c %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=DRIVER %s
+
+// The module map in Inputs/lazy-module-maps/broken is found while looking
+// for 'used', but it does not describe that module, so it is never parsed.
+@import used;
+
+// The module map in Inputs/lazy-module-maps/quoted names its module with a
+// string literal.
+@import quoted;
+
+// expected-no-diagnostics
+
+// The second compilation reads the summaries from the index in the module
+// cache instead of lexing the module map files.
+// CHECK: 2 of 3 lazy module map files parsed.
+// CHECK: 3 module map summaries read from the index
+// CHECK: 0 module map files lexed
+
+// EAGER: error: expected umbrella, header, submodule, or module export
+
+// DRIVER: "-fmodules-lazy-module-maps"
+
+int test(void) { return used() + quoted(); }
@@ -0,0 +1,26 @@
+// RUN: %clang_cc1 -x c-header -emit-pch -o %t %s
+// RUN: %clang_cc1 -include-pch %t -fsyntax-only -verify %s
+// RUN: %clang_cc1 -include-pch %t -fsyntax-only -print-stats %s 2>&1 \
+// RUN:   | FileCheck %s
+
+#ifndef HEADER
+#define HEADER
+
+int f(int);
+int f(int);
+
+int unused(int);
+int unused(int);
+
+#else
+
+// expected-no-diagnostics
+
+// Only the chain of 'f' is completed, once, when it is redeclared; later
+// uses find its most recent declaration up to date.
+int f(int);
+int g(void) { return f(1) + f(2); }
+
+// CHECK: {{^ *}}1 redeclaration chains completed
+
+#endif
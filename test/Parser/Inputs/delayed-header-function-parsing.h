@@ -0,0 +1,14 @@
+template <typename T> T unusedTemplate() { return undeclared1; }
+template <typename T> T usedTemplate() { return T::undeclared2; } // expected-error {{type 'int' cannot be used prior to '::' because it has no members}}
+
+template <typename T> struct ClassTemplate {
+  T unusedMember() { return undeclared3; }
+  T usedMember() { return T::undeclared4; } // expected-error {{type 'int' cannot be used prior to '::' because it has no members}}
+};
+
+// Bodies that are not templates are parsed where they are defined, so they
+// only find the declarations before them.
+inline int nonTemplate() { return declaredLater(); } // expected-error {{use of undeclared identifier 'declaredLater'}}
+struct S {
+  int member() { return declaredLater(); } // expected-error {{use of undeclared identifier 'declaredLater'}}
+};
@@ -0,0 +1,25 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+// expected-no-diagnostics
+
+struct T {
+  T(int);
+};
+
+void f(int a) {
+  // The '(' after '(h)' is disambiguated while deciding that the statement is
+  // a declaration; parsing the declarator reuses the answer.
+  T (h)(int);
+  T (i)(T);
+
+  // Not a function declarator: 'j' is initialized from 'a'.
+  T (j)(a);
+
+  // 'k' is tentatively declared, so 'k(a)' is not a parameter.
+  T (k)(a), (l)(k);
+}
+
+// CHECK: *** Parser Stats:
+// CHECK: {{[0-9]+}} ambiguities resolved by tentative parsing
+// CHECK: {{[0-9]+}} function declarator disambiguations, {{[1-9][0-9]*}} reused from the cache
+// CHECK: {{[0-9]+}} tokens lexed again after backtracking
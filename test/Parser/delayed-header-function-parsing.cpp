@@ -0,0 +1,19 @@
+// RUN: %clang_cc1 -fsyntax-only -verify -std=c++11 -fdelayed-header-function-parsing -I %S/Inputs %s
+// RUN: not %clang_cc1 -fsyntax-only -std=c++11 -I %S/Inputs %s 2>&1 | FileCheck %s --check-prefix=EAGER
+
+// Without the option, the bodies of all the templates in the header are
+// parsed.
+// EAGER: use of undeclared identifier 'undeclared1'
+// EAGER: use of undeclared identifier 'undeclared3'
+
+#include "delayed-header-function-parsing.h"
+
+// Bodies in the main file are always parsed.
+template <typename T> T mainFileTemplate() { return undeclared5; } // expected-error {{use of undeclared identifier 'undeclared5'}}
+
+int declaredLater();
+
+int use(ClassTemplate<int> &c) {
+  return usedTemplate<int>() + // expected-note {{in instantiation of function template specialization 'usedTemplate<int>' requested here}}
+         c.usedMember(); // expected-note {{in instantiation of member function 'ClassTemplate<int>::usedMember' requested here}}
+}
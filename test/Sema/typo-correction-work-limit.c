@@ -0,0 +1,21 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -fsyntax-only -verify -DWORK_LIMIT -fspell-checking-work-limit 1 %s
+// RUN: not %clang_cc1 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+
+int foobar;
+int barbaz;
+
+#ifndef WORK_LIMIT
+// expected-note@-4 {{'foobar' declared here}}
+// expected-note@-4 {{'barbaz' declared here}}
+int a = goobar; // expected-error {{use of undeclared identifier 'goobar'; did you mean 'foobar'?}}
+int b = barbaq; // expected-error {{use of undeclared identifier 'barbaq'; did you mean 'barbaz'?}}
+#else
+// The first correction exhausts the budget; the second is not attempted.
+// expected-note@-10 {{'foobar' declared here}}
+int a = goobar; // expected-error {{use of undeclared identifier 'goobar'; did you mean 'foobar'?}}
+int b = barbaq; // expected-error-re {{use of undeclared identifier 'barbaq'{{$}}}}
+#endif
+
+// CHECK: 2 typo corrections attempted
+// CHECK: Typo correction index: 2 queries, 1 local builds, 1 local updates
@@ -0,0 +1,56 @@
+// RUN: %clang_cc1 -fsyntax-only -fcache-unqualified-lookup -verify %s
+// RUN: %clang_cc1 -fsyntax-only -fcache-unqualified-lookup -print-stats %s 2>&1 | FileCheck %s
+
+int x;
+struct S { int member; };
+
+namespace N {
+  S x;
+}
+
+void sink(int);
+void sink(S);
+
+int repeated(int a, int b) {
+  int sum = 0;
+  sum += a * b;
+  sum += a * b;
+  sum += a * b;
+  return sum;
+}
+
+void shadowing() {
+  x = 1;
+  x = 2;
+  S x;
+  int *p = &x; // expected-error {{cannot initialize a variable of type 'int *' with an rvalue of type 'S *'}}
+  x.member = 4;
+  {
+    int x;
+    x.member = 5; // expected-error {{member reference base type 'int' is not a structure or union}}
+  }
+  x.member = 6;
+}
+
+void using_directive() {
+  x = 1;
+  {
+    using namespace N;
+    x = 2; // expected-error {{reference to 'x' is ambiguous}}
+    // expected-note@4 {{candidate found by name lookup is 'x'}}
+    // expected-note@8 {{candidate found by name lookup is 'N::x'}}
+  }
+  x = 3;
+}
+
+void using_directive_same_scope() {
+  x = 1;
+  using namespace N;
+  x = 2; // expected-error {{reference to 'x' is ambiguous}}
+  // expected-note@4 {{candidate found by name lookup is 'x'}}
+  // expected-note@8 {{candidate found by name lookup is 'N::x'}}
+}
+
+// CHECK: C++ unqualified lookups, {{[1-9][0-9]*}} answered from cache
+// CHECK: Direct lookups by context kind:
+// CHECK: TranslationUnit lookups
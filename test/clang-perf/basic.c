@@ -0,0 +1,22 @@
+// RUN: clang-perf -n 2 -o - %s -- -DVALUE=42 | FileCheck %s
+// RUN: clang-perf -n 1 -phase=syntax -o - %s -- -DVALUE=42 | FileCheck -check-prefix=SYNTAX %s
+// RUN: not clang-perf -n 1 -phase=syntax -o - %s 2>&1 | FileCheck -check-prefix=ERROR %s
+
+// clang-perf-args: -ffreestanding
+
+#include <stdint.h>
+
+int64_t f(void) { return VALUE; }
+
+// CHECK: "iterations": 2,
+// CHECK: "name": "basic.c",
+// CHECK: "preprocess": { "success": true, "wall": {{[0-9.]+}}, "user": {{[0-9.]+}}, "system": {{[0-9.]+}}, "memory": {{-?[0-9]+}} }
+// CHECK: "syntax": { "success": true,
+// CHECK: "codegen": { "success": true,
+
+// SYNTAX-NOT: "preprocess"
+// SYNTAX: "syntax": { "success": true,
+// SYNTAX-NOT: "codegen"
+
+// ERROR: error: use of undeclared identifier 'VALUE'
+// ERROR: "syntax": { "success": false,
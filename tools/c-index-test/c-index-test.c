@@ -1458,6 +1458,9 @@ static int perform_test_load(CXIndex Idx, CXTranslationUnit TU,
   if (prefix)
     FileCheckPrefix = prefix;
 
+  if (getenv("CINDEXTEST_ATTACH_COMMENTS"))
+    clang_attachCommentsToDecls(TU);
+
   if (Visitor) {
     enum CXCursorKind K = CXCursor_NotImplemented;
     enum CXCursorKind *ck = &K;
@@ -2199,6 +2202,7 @@ static int inspect_cursor_at(int argc, const char **argv) {
   CursorSourceLocation *Locations = 0;
   unsigned NumLocations = 0, Loc;
   unsigned Repeats = 1;
+  unsigned RemapAfterTrial = 0;
   unsigned I;
   
   /* Count the number of locations. */
@@ -2223,9 +2227,12 @@ static int inspect_cursor_at(int argc, const char **argv) {
 
   if (getenv("CINDEXTEST_EDITING"))
     Repeats = 5;
+  if (getenv("CINDEXTEST_REMAP_AFTER_TRIAL"))
+    RemapAfterTrial = strtol(getenv("CINDEXTEST_REMAP_AFTER_TRIAL"), 0, 10);
 
   /* Parse the translation unit. When we're testing clang_getCursor() after
-     reparsing, don't remap unsaved files until the second parse. */
+     reparsing, don't remap unsaved files until the second parse, or until
+     the reparse given by CINDEXTEST_REMAP_AFTER_TRIAL. */
   CIdx = clang_createIndex(1, 1);
   Err = clang_parseTranslationUnit2(CIdx, argv[argc - 1],
                                    argv + num_unsaved_files + 1 + NumLocations,
@@ -2244,8 +2251,10 @@ static int inspect_cursor_at(int argc, const char **argv) {
 
   for (I = 0; I != Repeats; ++I) {
     if (Repeats > 1) {
-      Err = clang_reparseTranslationUnit(TU, num_unsaved_files, unsaved_files,
-                                         clang_defaultReparseOptions(TU));
+      Err = clang_reparseTranslationUnit(
+          TU, I >= RemapAfterTrial ? num_unsaved_files : 0,
+          I >= RemapAfterTrial ? unsaved_files : 0,
+          clang_defaultReparseOptions(TU));
       if (Err != CXError_Success) {
         describeLibclangFailure(Err);
         clang_disposeTranslationUnit(TU);
@@ -3518,6 +3527,119 @@ int perform_token_annotation(int argc, const char **argv) {
   return errorCode;
 }
 
+static int perform_semantic_tokens(int argc, const char **argv) {
+  const char *input = argv[1];
+  char *filename = 0;
+  unsigned line, second_line;
+  unsigned column, second_column;
+  unsigned begin_offset, end_offset;
+  CXIndex CIdx;
+  CXTranslationUnit TU = 0;
+  int errorCode;
+  struct CXUnsavedFile *unsaved_files = 0;
+  int num_unsaved_files = 0;
+  CXSemanticToken *tokens = 0;
+  unsigned num_tokens = 0;
+  CXFile file = 0;
+  enum CXErrorCode Err;
+  unsigned i;
+
+  input += strlen("-test-semantic-tokens=");
+  if ((errorCode = parse_file_line_column(input, &filename, &line, &column,
+                                          &second_line, &second_column)))
+    return errorCode;
+
+  if (parse_remapped_files(argc, argv, 2, &unsaved_files, &num_unsaved_files)) {
+    free(filename);
+    return -1;
+  }
+
+  CIdx = clang_createIndex(0, 1);
+  Err = clang_parseTranslationUnit2(CIdx, argv[argc - 1],
+                                    argv + num_unsaved_files + 2,
+                                    argc - num_unsaved_files - 3,
+                                    unsaved_files,
+                                    num_unsaved_files,
+                                    getDefaultParsingOptions(), &TU);
+  if (Err != CXError_Success) {
+    fprintf(stderr, "unable to parse input\n");
+    describeLibclangFailure(Err);
+    clang_disposeIndex(CIdx);
+    free(filename);
+    free_remapped_files(unsaved_files, num_unsaved_files);
+    return -1;
+  }
+  errorCode = 0;
+
+  if (getenv("CINDEXTEST_EDITING")) {
+    for (i = 0; i < 5; ++i) {
+      Err = clang_reparseTranslationUnit(TU, num_unsaved_files, unsaved_files,
+                                         clang_defaultReparseOptions(TU));
+      if (Err != CXError_Success) {
+        fprintf(stderr, "Unable to reparse translation unit!\n");
+        describeLibclangFailure(Err);
+        errorCode = -1;
+        goto teardown;
+      }
+    }
+  }
+
+  if (checkForErrors(TU) != 0) {
+    errorCode = -1;
+    goto teardown;
+  }
+
+  file = clang_getFile(TU, filename);
+  if (!file) {
+    fprintf(stderr, "file %s is not in this translation unit\n", filename);
+    errorCode = -1;
+    goto teardown;
+  }
+
+  clang_getFileLocation(clang_getLocation(TU, file, line, column), 0, 0, 0,
+                        &begin_offset);
+  clang_getFileLocation(clang_getLocation(TU, file, second_line,
+                                          second_column),
+                        0, 0, 0, &end_offset);
+
+  Err = clang_getSemanticTokens(TU, file, begin_offset, end_offset, &tokens,
+                                &num_tokens);
+  if (Err != CXError_Success) {
+    fprintf(stderr, "unable to get semantic tokens\n");
+    describeLibclangFailure(Err);
+    errorCode = -1;
+    goto teardown;
+  }
+
+  for (i = 0; i != num_tokens; ++i) {
+    CXString kind = clang_getCursorKindSpelling(tokens[i].kind);
+    unsigned start_line, start_column, end_line, end_column;
+
+    clang_getSpellingLocation(
+        clang_getLocationForOffset(TU, file, tokens[i].offset),
+        0, &start_line, &start_column, 0);
+    clang_getSpellingLocation(
+        clang_getLocationForOffset(TU, file,
+                                   tokens[i].offset + tokens[i].length),
+        0, &end_line, &end_column, 0);
+    printf("%s: ", clang_getCString(kind));
+    clang_disposeString(kind);
+    PrintExtent(stdout, start_line, start_column, end_line, end_column);
+    if (tokens[i].flags & CXSemanticToken_Declaration)
+      printf(" declaration");
+    printf("\n");
+  }
+  clang_disposeSemanticTokens(tokens);
+
+ teardown:
+  PrintDiagnostics(TU);
+  clang_disposeTranslationUnit(TU);
+  clang_disposeIndex(CIdx);
+  free(filename);
+  free_remapped_files(unsaved_files, num_unsaved_files);
+  return errorCode;
+}
+
 static int
 perform_test_compilation_db(const char *database, int argc, const char **argv) {
   CXCompilationDatabase db;
@@ -4046,6 +4168,7 @@ static void print_usage(void) {
     "       c-index-test -test-load-source-usrs-memory-usage "
           "<symbol filter> {<args>}*\n"
     "       c-index-test -test-annotate-tokens=<range> {<args>}*\n"
+    "       c-index-test -test-semantic-tokens=<range> {<args>}*\n"
     "       c-index-test -test-inclusion-stack-source {<args>}*\n"
     "       c-index-test -test-inclusion-stack-tu <AST file>\n");
   fprintf(stderr,
@@ -4128,6 +4251,8 @@ int cindextest_main(int argc, const char **argv) {
                              argc >= 5 ? argv[4] : 0);
   else if (argc > 2 && strstr(argv[1], "-test-annotate-tokens=") == argv[1])
     return perform_token_annotation(argc, argv);
+  else if (argc > 2 && strstr(argv[1], "-test-semantic-tokens=") == argv[1])
+    return perform_semantic_tokens(argc, argv);
   else if (argc > 2 && strcmp(argv[1], "-test-inclusion-stack-source") == 0)
     return perform_test_load_source(argc - 2, argv + 2, "all", NULL,
                                     PrintInclusionStack);
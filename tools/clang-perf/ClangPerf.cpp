@@ -0,0 +1,302 @@
+//===--- tools/clang-perf/ClangPerf.cpp - Compile-time benchmark driver ---===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements clang-perf, which runs benchmark inputs through an
+//  in-process CompilerInstance one phase at a time (preprocessing, parsing
+//  and semantic analysis, IR generation) and reports wall/user/system time
+//  and memory for each phase as JSON, so that runs can be compared across
+//  commits with utils/clang-perf-compare.py.
+//
+//  Benchmark inputs may carry directives in their leading comments:
+//
+//    clang-perf-args: <cc1 arguments>   extra arguments for every phase
+//    clang-perf-pch: <header>           build a PCH from <header> (relative
+//                                       to the input) and include it
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/CodeGen/ObjectFilePCHContainerOperations.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Frontend/TextDiagnosticBuffer.h"
+#include "clang/Frontend/Utils.h"
+#include "clang/FrontendTool/Utils.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/YAMLParser.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+using namespace llvm;
+
+static cl::list<std::string> Inputs(cl::Positional, cl::OneOrMore,
+                                    cl::desc("<benchmark inputs>"));
+
+static cl::opt<unsigned> Iterations("n", cl::init(3),
+    cl::desc("Number of timed runs per phase; the fastest is reported"));
+
+static cl::opt<std::string> OutputFile("o", cl::init("-"),
+    cl::desc("Write the JSON report to <file>"), cl::value_desc("file"));
+
+static cl::opt<std::string> ResourceDir("resource-dir",
+    cl::desc("Resource directory for builtin headers"));
+
+static cl::list<std::string> Phases("phase", cl::CommaSeparated,
+    cl::desc("Phases to run: preprocess, syntax, codegen (default: all)"));
+
+/// The cc1 arguments following '--' on the command line.
+static std::vector<std::string> ExtraArgs;
+
+namespace {
+
+struct PhaseInfo {
+  const char *Name;
+  const char *Action;
+};
+
+const PhaseInfo AllPhases[] = {
+  { "preprocess", "-Eonly" },
+  { "syntax", "-fsyntax-only" },
+  { "codegen", "-emit-llvm-only" },
+};
+
+/// The measurements for one phase of one benchmark.
+struct PhaseResult {
+  const char *Name;
+  bool Success;
+  double Wall, User, System;
+  int64_t Memory;
+};
+
+struct BenchmarkResult {
+  std::string Name;
+  std::vector<PhaseResult> Phases;
+};
+
+} // end anonymous namespace
+
+/// Collect the clang-perf directives from the leading comment lines.
+static void readDirectives(StringRef Path, std::vector<std::string> &Args,
+                           std::string &PCHHeader) {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> Buffer = MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return;
+
+  SmallVector<StringRef, 32> Lines;
+  (*Buffer)->getBuffer().split(Lines, "\n", 32);
+  for (StringRef Line : Lines) {
+    Line = Line.trim();
+    if (Line.empty())
+      continue;
+    if (!Line.startswith("//"))
+      break;
+    Line = Line.drop_front(2).trim();
+
+    if (Line.startswith("clang-perf-args:")) {
+      SmallVector<StringRef, 8> Words;
+      Line.drop_front(strlen("clang-perf-args:"))
+          .split(Words, " ", -1, /*KeepEmpty=*/false);
+      for (StringRef Word : Words)
+        Args.push_back(Word);
+    } else if (Line.startswith("clang-perf-pch:")) {
+      SmallString<128> Header = sys::path::parent_path(Path);
+      sys::path::append(Header,
+                        Line.drop_front(strlen("clang-perf-pch:")).trim());
+      PCHHeader = Header.str();
+    }
+  }
+}
+
+/// Run a single compilation in-process and time it.  Returns false if the
+/// compiler reported errors.
+static bool runCompilation(ArrayRef<std::string> Args, const char *Argv0,
+                           bool KeepMemory, TimeRecord &Time) {
+  std::vector<const char *> CArgs;
+  for (const std::string &Arg : Args)
+    CArgs.push_back(Arg.c_str());
+  // Freeing the AST would hide the memory used by the phase.
+  if (KeepMemory)
+    CArgs.push_back("-disable-free");
+
+  std::unique_ptr<CompilerInstance> Clang(new CompilerInstance());
+  auto PCHOps = Clang->getPCHContainerOperations();
+  PCHOps->registerWriter(llvm::make_unique<ObjectFilePCHContainerWriter>());
+  PCHOps->registerReader(llvm::make_unique<ObjectFilePCHContainerReader>());
+
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+  TextDiagnosticBuffer *DiagsBuffer = new TextDiagnosticBuffer;
+  DiagnosticsEngine Diags(DiagID, &*DiagOpts, DiagsBuffer);
+  bool Success = CompilerInvocation::CreateFromArgs(
+      Clang->getInvocation(), CArgs.data(), CArgs.data() + CArgs.size(),
+      Diags);
+
+  HeaderSearchOptions &HSOpts = Clang->getHeaderSearchOpts();
+  if (!ResourceDir.empty())
+    HSOpts.ResourceDir = ResourceDir;
+  else if (HSOpts.UseBuiltinIncludes && HSOpts.ResourceDir.empty())
+    HSOpts.ResourceDir = CompilerInvocation::GetResourcesPath(
+        Argv0, reinterpret_cast<void *>(&runCompilation));
+
+  Clang->createDiagnostics();
+  if (!Clang->hasDiagnostics())
+    return false;
+  DiagsBuffer->FlushDiagnostics(Clang->getDiagnostics());
+  if (!Success)
+    return false;
+
+  Time = TimeRecord::getCurrentTime(/*Start=*/true);
+  Success = ExecuteCompilerInvocation(Clang.get());
+  TimeRecord End = TimeRecord::getCurrentTime(/*Start=*/false);
+  End -= Time;
+  Time = End;
+
+  if (KeepMemory)
+    BuryPointer(std::move(Clang));
+  return Success;
+}
+
+static BenchmarkResult runBenchmark(StringRef Input, const char *Argv0) {
+  BenchmarkResult Result;
+  Result.Name = sys::path::filename(Input);
+
+  std::vector<std::string> BaseArgs;
+  std::string PCHHeader;
+  readDirectives(Input, BaseArgs, PCHHeader);
+  BaseArgs.insert(BaseArgs.end(), ExtraArgs.begin(), ExtraArgs.end());
+
+  // Building the precompiled header is measured as a phase of its own, and
+  // every other phase then measures loading it.
+  SmallString<128> PCHFile;
+  if (!PCHHeader.empty()) {
+    if (std::error_code EC =
+            sys::fs::createTemporaryFile("clang-perf", "pch", PCHFile)) {
+      errs() << "error: could not create temporary file: " << EC.message()
+             << '\n';
+    } else {
+      std::vector<std::string> Args(BaseArgs);
+      Args.push_back("-emit-pch");
+      Args.push_back("-o");
+      Args.push_back(PCHFile.str());
+      Args.push_back(PCHHeader);
+
+      PhaseResult Phase = { "pch-build", true, 0, 0, 0, 0 };
+      TimeRecord Time;
+      Phase.Success = runCompilation(Args, Argv0, /*KeepMemory=*/true, Time);
+      Phase.Wall = Time.getWallTime();
+      Phase.User = Time.getUserTime();
+      Phase.System = Time.getSystemTime();
+      Phase.Memory = Time.getMemUsed();
+      Result.Phases.push_back(Phase);
+
+      BaseArgs.push_back("-include-pch");
+      BaseArgs.push_back(PCHFile.str());
+    }
+  }
+
+  for (const PhaseInfo &Info : AllPhases) {
+    if (!Phases.empty() &&
+        std::find(Phases.begin(), Phases.end(), Info.Name) == Phases.end())
+      continue;
+
+    std::vector<std::string> Args(BaseArgs);
+    Args.push_back(Info.Action);
+    Args.push_back(Input);
+
+    PhaseResult Phase = { Info.Name, true, 0, 0, 0, 0 };
+    for (unsigned I = 0, E = std::max(1u, unsigned(Iterations)); I != E; ++I) {
+      // The first run keeps everything it allocates so that its memory can
+      // be measured; the remaining runs only contribute timings.
+      TimeRecord Time;
+      Phase.Success &= runCompilation(Args, Argv0, /*KeepMemory=*/I == 0, Time);
+      if (I == 0) {
+        Phase.Memory = Time.getMemUsed();
+        Phase.Wall = Time.getWallTime();
+        Phase.User = Time.getUserTime();
+        Phase.System = Time.getSystemTime();
+      } else if (Time.getWallTime() < Phase.Wall) {
+        Phase.Wall = Time.getWallTime();
+        Phase.User = Time.getUserTime();
+        Phase.System = Time.getSystemTime();
+      }
+    }
+    Result.Phases.push_back(Phase);
+  }
+
+  if (!PCHFile.empty())
+    sys::fs::remove(PCHFile.str());
+  return Result;
+}
+
+static void writeReport(raw_ostream &OS,
+                        ArrayRef<BenchmarkResult> Results) {
+  OS << "{\n  \"iterations\": " << Iterations << ",\n  \"benchmarks\": [";
+  for (unsigned I = 0, E = Results.size(); I != E; ++I) {
+    const BenchmarkResult &B = Results[I];
+    OS << (I ? ",\n" : "\n") << "    {\n      \"name\": \""
+       << yaml::escape(B.Name) << "\",\n      \"phases\": {";
+    for (unsigned J = 0, F = B.Phases.size(); J != F; ++J) {
+      const PhaseResult &P = B.Phases[J];
+      OS << (J ? ",\n" : "\n") << "        \"" << yaml::escape(P.Name)
+         << "\": { \"success\": " << (P.Success ? "true" : "false")
+         << ", \"wall\": " << format("%.6f", P.Wall)
+         << ", \"user\": " << format("%.6f", P.User)
+         << ", \"system\": " << format("%.6f", P.System)
+         << ", \"memory\": " << P.Memory << " }";
+    }
+    OS << "\n      }\n    }";
+  }
+  OS << "\n  ]\n}\n";
+}
+
+int main(int argc, const char **argv) {
+  sys::PrintStackTraceOnErrorSignal();
+  llvm_shutdown_obj Y;
+
+  InitializeAllTargets();
+  InitializeAllTargetMCs();
+  InitializeAllAsmPrinters();
+  InitializeAllAsmParsers();
+
+  // Everything after '--' is passed to each compilation.
+  for (int I = 1; I != argc; ++I) {
+    if (StringRef(argv[I]) == "--") {
+      ExtraArgs.assign(argv + I + 1, argv + argc);
+      argc = I;
+      break;
+    }
+  }
+  cl::ParseCommandLineOptions(argc, argv, "clang compile-time benchmarks\n");
+
+  std::vector<BenchmarkResult> Results;
+  bool Failed = false;
+  for (const std::string &Input : Inputs) {
+    Results.push_back(runBenchmark(Input, argv[0]));
+    for (const PhaseResult &P : Results.back().Phases)
+      Failed |= !P.Success;
+  }
+
+  std::error_code EC;
+  raw_fd_ostream OS(OutputFile, EC, sys::fs::F_Text);
+  if (EC) {
+    errs() << "error: could not open '" << OutputFile << "': "
+           << EC.message() << '\n';
+    return 1;
+  }
+  writeReport(OS, Results);
+  return Failed;
+}
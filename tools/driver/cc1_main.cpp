@@ -17,6 +17,7 @@
 #include "clang/CodeGen/ObjectFilePCHContainerOperations.h"
 #include "clang/Driver/DriverDiagnostic.h"
 #include "clang/Driver/Options.h"
+#include "clang/Frontend/CompilationCache.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/CompilerInvocation.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
@@ -64,7 +65,8 @@ void initializePollyPasses(llvm::PassRegistry &Registry);
 }
 #endif
 
-int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
+int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr,
+             bool InBatch) {
   std::unique_ptr<CompilerInstance> Clang(new CompilerInstance());
   IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
 
@@ -104,26 +106,35 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
     return 1;
 
   // Set an error handler, so that any LLVM backend diagnostics go through our
-  // error handler.
-  llvm::install_fatal_error_handler(LLVMErrorHandler,
-                                  static_cast<void*>(&Clang->getDiagnostics()));
+  // error handler. The handler depends on the Diagnostics object, so it is
+  // uninstalled on every return path, before Clang is destroyed, and later
+  // errors use the default handling behavior instead. This matters for
+  // -cc1batch, where the process outlives this compilation.
+  llvm::ScopedFatalErrorHandler FatalErrorHandler(
+      LLVMErrorHandler, static_cast<void *>(&Clang->getDiagnostics()));
 
   DiagsBuffer->FlushDiagnostics(Clang->getDiagnostics());
   if (!Success)
     return 1;
 
-  // Execute the frontend actions.
-  Success = ExecuteCompilerInvocation(Clang.get());
+  // Reuse the outputs of an identical compilation if they are cached.
+  std::unique_ptr<CompilationCache> Cache;
+  if (!Clang->getFrontendOpts().CompilationCachePath.empty())
+    Cache = CompilationCache::create(*Clang, Argv);
+
+  if (Cache && Cache->replay()) {
+    Success = true;
+  } else {
+    // Execute the frontend actions.
+    Success = ExecuteCompilerInvocation(Clang.get());
+    if (Cache && Success)
+      Cache->store();
+  }
 
   // If any timers were active but haven't been destroyed yet, print their
   // results now.  This happens in -disable-free mode.
   llvm::TimerGroup::printAll(llvm::errs());
 
-  // Our error handler depends on the Diagnostics object, which we're
-  // potentially about to delete. Uninstall the handler now so that any
-  // later errors use the default handling behavior instead.
-  llvm::remove_fatal_error_handler();
-
   // When running with -disable-free, don't do any destruction or shutdown.
   if (Clang->getFrontendOpts().DisableFree) {
     if (llvm::AreStatisticsEnabled() || Clang->getFrontendOpts().ShowStats)
@@ -133,8 +144,10 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
   }
 
   // Managed static deconstruction. Useful for making things like
-  // -time-passes usable.
-  llvm::llvm_shutdown();
+  // -time-passes usable. The jobs of a -cc1batch process share the managed
+  // statics, so they are left alone there.
+  if (!InBatch)
+    llvm::llvm_shutdown();
 
   return !Success;
 }
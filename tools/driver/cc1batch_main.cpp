@@ -0,0 +1,157 @@
+//===-- cc1batch_main.cpp - Clang CC1 Batch Job Runner --------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This is the entry point to the clang -cc1batch functionality, which runs a
+// sequence of -cc1 jobs read from its standard input in a single process. The
+// test suite uses it to avoid starting the compiler for each of its many
+// -fsyntax-only -verify tests.
+//
+// Each job is given as the directory to run it in, the number of -cc1
+// arguments, and the arguments, each on its own line. For each job, a line
+// "<exit code> <length>" is written to the standard output, followed by the
+// <length> bytes the job wrote to its standard output and standard error.
+// If a job crashes, the line "crash 0" is written instead and the process
+// exits, since its state can no longer be trusted.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/CrashRecoveryContext.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+#ifdef LLVM_ON_UNIX
+#include <unistd.h>
+#endif
+using namespace clang;
+
+extern int cc1_main(ArrayRef<const char *> Argv, const char *Argv0,
+                    void *MainAddr, bool InBatch);
+
+namespace {
+
+/// \brief A -cc1 job read from the standard input.
+struct BatchJob {
+  std::string WorkingDir;
+  std::vector<std::string> Args;
+};
+
+} // end anonymous namespace
+
+static bool ReadJob(std::istream &In, BatchJob &Job) {
+  std::string Count;
+  if (!std::getline(In, Job.WorkingDir) || !std::getline(In, Count))
+    return false;
+
+  unsigned NumArgs;
+  if (StringRef(Count).getAsInteger(10, NumArgs))
+    return false;
+
+  Job.Args.resize(NumArgs);
+  for (std::string &Arg : Job.Args)
+    if (!std::getline(In, Arg))
+      return false;
+  return true;
+}
+
+static void FlushStandardStreams() {
+  llvm::outs().flush();
+  llvm::errs().flush();
+  fflush(stdout);
+  fflush(stderr);
+}
+
+int cc1batch_main(ArrayRef<const char *> Argv, const char *Argv0,
+                  void *MainAddr) {
+#ifdef LLVM_ON_UNIX
+  if (!Argv.empty()) {
+    llvm::errs() << "error: -cc1batch takes no arguments\n";
+    return 1;
+  }
+
+  // The jobs write to the standard output and standard error, which are
+  // redirected to a file while each of them runs; the results are reported on
+  // a copy of the original standard output.
+  int ResultFD = ::dup(STDOUT_FILENO);
+  int ErrorFD = ::dup(STDERR_FILENO);
+  if (ResultFD < 0 || ErrorFD < 0) {
+    llvm::errs() << "error: cannot duplicate the standard streams\n";
+    return 1;
+  }
+  llvm::raw_fd_ostream Results(ResultFD, /*shouldClose=*/true);
+
+  llvm::CrashRecoveryContext::Enable();
+
+  BatchJob Job;
+  while (ReadJob(std::cin, Job)) {
+    int OutputFD;
+    SmallString<128> OutputPath;
+    if (llvm::sys::fs::createTemporaryFile("cc1batch", "out", OutputFD,
+                                           OutputPath)) {
+      llvm::errs() << "error: cannot create a temporary file\n";
+      return 1;
+    }
+
+    FlushStandardStreams();
+    ::dup2(OutputFD, STDOUT_FILENO);
+    ::dup2(OutputFD, STDERR_FILENO);
+    ::close(OutputFD);
+
+    SmallVector<const char *, 32> JobArgv;
+    for (const std::string &Arg : Job.Args)
+      JobArgv.push_back(Arg.c_str());
+
+    // Run the job on a separate thread, like module builds, so that it gets
+    // a stack large enough and a crash only takes down this job.
+    const unsigned ThreadStackSize = 8 << 20;
+    int Result = 1;
+    bool Crashed = false;
+    if (::chdir(Job.WorkingDir.c_str()) != 0) {
+      llvm::errs() << "error: cannot change to directory '" << Job.WorkingDir
+                   << "'\n";
+    } else {
+      llvm::CrashRecoveryContext CRC;
+      Crashed = !CRC.RunSafelyOnThread([&]() {
+        Result = cc1_main(JobArgv, Argv0, MainAddr, /*InBatch=*/true);
+      }, ThreadStackSize);
+    }
+
+    FlushStandardStreams();
+    ::dup2(ResultFD, STDOUT_FILENO);
+    ::dup2(ErrorFD, STDERR_FILENO);
+
+    if (Crashed) {
+      llvm::sys::fs::remove(OutputPath);
+      Results << "crash 0\n";
+      Results.flush();
+      return 1;
+    }
+
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Output =
+        llvm::MemoryBuffer::getFile(OutputPath);
+    StringRef OutputText = Output ? (*Output)->getBuffer() : StringRef();
+    Results << Result << ' ' << OutputText.size() << '\n' << OutputText;
+    Results.flush();
+    llvm::sys::fs::remove(OutputPath);
+  }
+
+  return 0;
+#else
+  llvm::errs() << "error: -cc1batch is not supported on this platform\n";
+  return 1;
+#endif
+}
@@ -197,9 +197,11 @@ static void ApplyQAOverride(SmallVectorImpl<const char*> &Args,
 }
 
 extern int cc1_main(ArrayRef<const char *> Argv, const char *Argv0,
-                    void *MainAddr);
+                    void *MainAddr, bool InBatch);
 extern int cc1as_main(ArrayRef<const char *> Argv, const char *Argv0,
                       void *MainAddr);
+extern int cc1batch_main(ArrayRef<const char *> Argv, const char *Argv0,
+                         void *MainAddr);
 
 struct DriverSuffix {
   const char *Suffix;
@@ -364,9 +366,12 @@ static void SetInstallDir(SmallVectorImpl<const char *> &argv,
 static int ExecuteCC1Tool(ArrayRef<const char *> argv, StringRef Tool) {
   void *GetExecutablePathVP = (void *)(intptr_t) GetExecutablePath;
   if (Tool == "")
-    return cc1_main(argv.slice(2), argv[0], GetExecutablePathVP);
+    return cc1_main(argv.slice(2), argv[0], GetExecutablePathVP,
+                    /*InBatch=*/false);
   if (Tool == "as")
     return cc1as_main(argv.slice(2), argv[0], GetExecutablePathVP);
+  if (Tool == "batch")
+    return cc1batch_main(argv.slice(2), argv[0], GetExecutablePathVP);
 
   // Reject unknown tools.
   llvm::errs() << "error: unknown integrated tool '" << Tool << "'\n";
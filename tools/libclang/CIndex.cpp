@@ -83,6 +83,9 @@ CXTranslationUnit cxtu::MakeCXTranslationUnit(CIndexer *CIdx, ASTUnit *AU) {
   D->Diagnostics = nullptr;
   D->OverridenCursorsPool = createOverridenCXCursorsPool();
   D->CommentToXML = nullptr;
+  D->SemanticTokens = nullptr;
+  D->CursorIndex = nullptr;
+  D->CommentsAttached = false;
   return D;
 }
 
@@ -3288,6 +3291,8 @@ void clang_disposeTranslationUnit(CXTranslationUnit CTUnit) {
     delete static_cast<CXDiagnosticSetImpl *>(CTUnit->Diagnostics);
     disposeOverridenCXCursorsPool(CTUnit->OverridenCursorsPool);
     delete CTUnit->CommentToXML;
+    disposeSemanticTokens(CTUnit);
+    disposeCursorIndex(CTUnit);
     delete CTUnit;
   }
 }
@@ -3320,6 +3325,9 @@ static void clang_reparseTranslationUnit_Impl(void *UserData) {
   // Reset the associated diagnostics.
   delete static_cast<CXDiagnosticSetImpl*>(TU->Diagnostics);
   TU->Diagnostics = nullptr;
+  disposeSemanticTokens(TU);
+  disposeCursorIndex(TU);
+  TU->CommentsAttached = false;
 
   CIndexer *CXXIdx = TU->CIdx;
   if (CXXIdx->isOptEnabled(CXGlobalOpt_ThreadBackgroundPriorityForEditing))
@@ -4755,6 +4763,241 @@ CXSourceLocation clang_getCursorLocation(CXCursor C) {
 
 } // end extern "C"
 
+namespace {
+
+/// \brief An index of the cursors in the main file of a translation unit,
+/// which lets clang_getCursor() find the cursor at a location without
+/// walking the AST.
+///
+/// The index records, in visitation order, the cursors that a walk of the
+/// whole main file visits, with their extents and parents. A query uses an
+/// interval tree to find the cursors whose extent may contain the location,
+/// keeps those that a walk restricted to the location would visit, i.e., those
+/// that overlap it and whose parent was kept, and replays them through
+/// GetCursorVisitor.
+class CursorLocationIndex {
+  struct Entry {
+    CXCursor Cursor;
+
+    /// \brief The extent that is compared with the region of interest to
+    /// decide whether the cursor is visited.
+    SourceRange Extent;
+
+    /// \brief The offsets in the main file of the expansion range of
+    /// \c Extent, which contains every location that \c Extent overlaps.
+    unsigned Begin, End;
+
+    /// \brief The index of the entry of the parent cursor, or ~0U for a
+    /// cursor visited at the top level.
+    unsigned Parent;
+
+    /// \brief Whether \c Begin and \c End are valid, i.e., whether the
+    /// extent lies in the main file.
+    bool InMainFile;
+  };
+
+  SourceManager &SM;
+  FileID MainFileID;
+  std::vector<Entry> Entries;
+
+  /// \brief The indices of the entries in the main file, sorted by \c Begin.
+  std::vector<unsigned> ByBegin;
+
+  /// \brief The maximum \c End of the entries under each node of a binary
+  /// tree over \c ByBegin; node 1 covers all of \c ByBegin and the children
+  /// of node N are nodes 2N and 2N+1.
+  std::vector<unsigned> MaxEnd;
+
+  /// \brief The entries whose children are being visited while the index is
+  /// built.
+  SmallVector<unsigned, 32> Parents;
+
+  static enum CXChildVisitResult visitCursor(CXCursor Cursor, CXCursor Parent,
+                                             CXClientData ClientData);
+  static bool visitCursorPostChildren(CXCursor Cursor,
+                                      CXClientData ClientData);
+
+  void addCursor(CXCursor Cursor);
+  unsigned buildMaxEnd(unsigned Node, unsigned Lo, unsigned Hi);
+  void findEntries(unsigned Node, unsigned Lo, unsigned Hi, unsigned Limit,
+                   unsigned Offset, SmallVectorImpl<unsigned> &Found) const;
+
+public:
+  explicit CursorLocationIndex(CXTranslationUnit TU);
+
+  /// \brief Find the cursor at the given location, as a walk of the cursors
+  /// around it with GetCursorVisitor would.
+  ///
+  /// \returns false if the location is not in the main file, in which case
+  /// the AST must be walked.
+  bool findCursor(SourceLocation Loc, GetCursorData &Data) const;
+};
+
+} // end anonymous namespace
+
+CursorLocationIndex::CursorLocationIndex(CXTranslationUnit TU)
+  : SM(cxtu::getASTUnit(TU)->getSourceManager()),
+    MainFileID(SM.getMainFileID()) {
+  SourceRange MainFile(SM.getLocForStartOfFile(MainFileID),
+                       SM.getLocForEndOfFile(MainFileID));
+  CursorVisitor Visitor(TU, visitCursor, this,
+                        /*VisitPreprocessorLast=*/true,
+                        /*VisitIncludedEntities=*/false,
+                        MainFile,
+                        /*VisitDeclsOnly=*/false,
+                        visitCursorPostChildren);
+  Visitor.visitFileRegion();
+
+  for (unsigned I = 0, N = Entries.size(); I != N; ++I)
+    if (Entries[I].InMainFile)
+      ByBegin.push_back(I);
+  std::stable_sort(ByBegin.begin(), ByBegin.end(),
+                   [this](unsigned LHS, unsigned RHS) {
+    return Entries[LHS].Begin < Entries[RHS].Begin;
+  });
+
+  if (!ByBegin.empty()) {
+    MaxEnd.resize(4 * ByBegin.size());
+    buildMaxEnd(1, 0, ByBegin.size());
+  }
+}
+
+enum CXChildVisitResult
+CursorLocationIndex::visitCursor(CXCursor Cursor, CXCursor Parent,
+                                 CXClientData ClientData) {
+  static_cast<CursorLocationIndex *>(ClientData)->addCursor(Cursor);
+  return CXChildVisit_Recurse;
+}
+
+bool CursorLocationIndex::visitCursorPostChildren(CXCursor Cursor,
+                                                  CXClientData ClientData) {
+  static_cast<CursorLocationIndex *>(ClientData)->Parents.pop_back();
+  return false;
+}
+
+void CursorLocationIndex::addCursor(CXCursor Cursor) {
+  Entry E;
+  E.Cursor = Cursor;
+  E.Extent = clang_isDeclaration(Cursor.kind)
+                 ? getFullCursorExtent(Cursor, SM)
+                 : getRawCursorExtent(Cursor);
+  E.Begin = E.End = 0;
+  E.Parent = Parents.empty() ? ~0U : Parents.back();
+  E.InMainFile = false;
+
+  if (E.Extent.isValid()) {
+    std::pair<FileID, unsigned> Begin =
+        SM.getDecomposedExpansionLoc(E.Extent.getBegin());
+    std::pair<FileID, unsigned> End =
+        SM.getDecomposedLoc(SM.getExpansionRange(E.Extent.getEnd()).second);
+    if (Begin.first == MainFileID && End.first == MainFileID &&
+        Begin.second <= End.second) {
+      E.Begin = Begin.second;
+      E.End = End.second;
+      E.InMainFile = true;
+    }
+  }
+
+  // The visitor calls visitCursorPostChildren() once the children of the
+  // cursor are visited.
+  Parents.push_back(Entries.size());
+  Entries.push_back(E);
+}
+
+unsigned CursorLocationIndex::buildMaxEnd(unsigned Node, unsigned Lo,
+                                          unsigned Hi) {
+  unsigned Max;
+  if (Hi - Lo == 1) {
+    Max = Entries[ByBegin[Lo]].End;
+  } else {
+    unsigned Mid = Lo + (Hi - Lo) / 2;
+    Max = std::max(buildMaxEnd(2 * Node, Lo, Mid),
+                   buildMaxEnd(2 * Node + 1, Mid, Hi));
+  }
+  MaxEnd[Node] = Max;
+  return Max;
+}
+
+void CursorLocationIndex::findEntries(unsigned Node, unsigned Lo, unsigned Hi,
+                                      unsigned Limit, unsigned Offset,
+                                      SmallVectorImpl<unsigned> &Found) const {
+  if (Lo >= Limit || MaxEnd[Node] < Offset)
+    return;
+  if (Hi - Lo == 1) {
+    Found.push_back(ByBegin[Lo]);
+    return;
+  }
+  unsigned Mid = Lo + (Hi - Lo) / 2;
+  findEntries(2 * Node, Lo, Mid, Limit, Offset, Found);
+  findEntries(2 * Node + 1, Mid, Hi, Limit, Offset, Found);
+}
+
+/// \brief Determine which selector identifier of an Objective-C method or
+/// message cursor is at the given location, as MakeCXCursor() does when it
+/// is given that location as the region of interest.
+static CXCursor setSelectorIdIndex(CXCursor C, SourceLocation Loc) {
+  SmallVector<SourceLocation, 16> SelLocs;
+  if (C.kind == CXCursor_ObjCInstanceMethodDecl ||
+      C.kind == CXCursor_ObjCClassMethodDecl)
+    cast<ObjCMethodDecl>(getCursorDecl(C))->getSelectorLocs(SelLocs);
+  else if (C.kind == CXCursor_ObjCMessageExpr)
+    cast<ObjCMessageExpr>(getCursorExpr(C))->getSelectorLocs(SelLocs);
+  else
+    return C;
+
+  SmallVectorImpl<SourceLocation>::iterator
+    I = std::find(SelLocs.begin(), SelLocs.end(), Loc);
+  C.xdata = I != SelLocs.end() ? I - SelLocs.begin() : -1;
+  return C;
+}
+
+bool CursorLocationIndex::findCursor(SourceLocation Loc,
+                                     GetCursorData &Data) const {
+  if (!Loc.isFileID())
+    return false;
+  std::pair<FileID, unsigned> LocInfo = SM.getDecomposedLoc(Loc);
+  if (LocInfo.first != MainFileID)
+    return false;
+  unsigned Offset = LocInfo.second;
+
+  // Only the entries that begin at or before the location can contain it.
+  unsigned Limit =
+      std::upper_bound(ByBegin.begin(), ByBegin.end(), Offset,
+                       [this](unsigned Value, unsigned I) {
+                         return Value < Entries[I].Begin;
+                       }) - ByBegin.begin();
+  SmallVector<unsigned, 32> Found;
+  if (Limit)
+    findEntries(1, 0, ByBegin.size(), Limit, Offset, Found);
+  std::sort(Found.begin(), Found.end());
+
+  // Replay the cursors that a walk restricted to the location would visit, in
+  // the order it would visit them.
+  SourceRange Region(Loc, Loc);
+  SmallVector<unsigned, 32> Visited;
+  for (unsigned I : Found) {
+    const Entry &E = Entries[I];
+    if (E.Parent != ~0U &&
+        !std::binary_search(Visited.begin(), Visited.end(), E.Parent))
+      continue;
+    if (RangeCompare(SM, E.Extent, Region) != RangeOverlap)
+      continue;
+
+    Visited.push_back(I);
+    CXCursor Parent = E.Parent == ~0U ? clang_getNullCursor()
+                                      : Entries[E.Parent].Cursor;
+    if (GetCursorVisitor(setSelectorIdIndex(E.Cursor, Loc), Parent, &Data) ==
+        CXChildVisit_Break)
+      break;
+  }
+  return true;
+}
+
+void cxtu::disposeCursorIndex(CXTranslationUnit TU) {
+  delete static_cast<CursorLocationIndex *>(TU->CursorIndex);
+  TU->CursorIndex = nullptr;
+}
+
 CXCursor cxcursor::getCursor(CXTranslationUnit TU, SourceLocation SLoc) {
   assert(TU);
 
@@ -4772,12 +5015,28 @@ CXCursor cxcursor::getCursor(CXTranslationUnit TU, SourceLocation SLoc) {
   
   CXCursor Result = MakeCXCursorInvalid(CXCursor_NoDeclFound);
   if (SLoc.isValid()) {
-    GetCursorData ResultData(CXXUnit->getSourceManager(), SLoc, Result);
-    CursorVisitor CursorVis(TU, GetCursorVisitor, &ResultData,
-                            /*VisitPreprocessorLast=*/true, 
-                            /*VisitIncludedEntities=*/false,
-                            SourceLocation(SLoc));
-    CursorVis.visitFileRegion();
+    SourceManager &SM = CXXUnit->getSourceManager();
+    GetCursorData ResultData(SM, SLoc, Result);
+
+    // Locations in the main file, where most queries are, are looked up in
+    // an index of its cursors, built by the first such query after each parse.
+    // LIBCLANG_DISABLE_CURSOR_INDEX always walks the AST instead, so that the
+    // two can be compared.
+    bool Found = false;
+    if (SLoc.isFileID() && SM.getFileID(SLoc) == SM.getMainFileID() &&
+        !getenv("LIBCLANG_DISABLE_CURSOR_INDEX")) {
+      if (!TU->CursorIndex)
+        TU->CursorIndex = new CursorLocationIndex(TU);
+      Found = static_cast<CursorLocationIndex *>(TU->CursorIndex)
+                  ->findCursor(SLoc, ResultData);
+    }
+    if (!Found) {
+      CursorVisitor CursorVis(TU, GetCursorVisitor, &ResultData,
+                              /*VisitPreprocessorLast=*/true, 
+                              /*VisitIncludedEntities=*/false,
+                              SourceLocation(SLoc));
+      CursorVis.visitFileRegion();
+    }
   }
 
   return Result;
@@ -12,11 +12,15 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang-c/Index.h"
+#include "CLog.h"
 #include "CXComment.h"
 #include "CXCursor.h"
 #include "CXString.h"
+#include "CXTranslationUnit.h"
 #include "clang-c/Documentation.h"
 #include "clang/AST/Decl.h"
+#include "clang/AST/DeclTemplate.h"
+#include "clang/Frontend/ASTUnit.h"
 #include "clang/Index/CommentToXML.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSwitch.h"
@@ -27,8 +31,52 @@ using namespace clang;
 using namespace clang::comments;
 using namespace clang::cxcomment;
 
+/// \brief Collect the declarations that can be documented in the given
+/// declaration, which are all but those local to a function.
+static void collectDocumentableDecls(const Decl *D,
+                                     SmallVectorImpl<const Decl *> &Decls) {
+  Decls.push_back(D);
+
+  if (const TemplateDecl *Template = dyn_cast<TemplateDecl>(D))
+    if (const Decl *Templated = Template->getTemplatedDecl())
+      D = Templated;
+
+  const DeclContext *DC = dyn_cast<DeclContext>(D);
+  if (!DC || DC->isFunctionOrMethod())
+    return;
+  for (const Decl *Child : DC->decls())
+    collectDocumentableDecls(Child, Decls);
+}
+
+void cxtu::attachCommentsToDecls(CXTranslationUnit TU) {
+  if (!TU || TU->CommentsAttached)
+    return;
+  TU->CommentsAttached = true;
+
+  // Declarations of an AST file are deserialized on demand, so only its
+  // queried declarations are looked at.
+  ASTUnit *CXXUnit = getASTUnit(TU);
+  if (!CXXUnit || CXXUnit->isMainFileAST())
+    return;
+
+  SmallVector<const Decl *, 256> Decls;
+  for (ASTUnit::top_level_iterator I = CXXUnit->top_level_begin(),
+                                   E = CXXUnit->top_level_end();
+       I != E; ++I)
+    collectDocumentableDecls(*I, Decls);
+  CXXUnit->getASTContext().attachCommentsToDecls(Decls);
+}
+
 extern "C" {
 
+void clang_attachCommentsToDecls(CXTranslationUnit TU) {
+  if (cxtu::isNotUsableTU(TU)) {
+    LOG_BAD_TU(TU);
+    return;
+  }
+  cxtu::attachCommentsToDecls(TU);
+}
+
 CXComment clang_Cursor_getParsedComment(CXCursor C) {
   using namespace clang::cxcursor;
 
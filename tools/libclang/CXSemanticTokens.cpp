@@ -0,0 +1,304 @@
+//===- CXSemanticTokens.cpp - Tokens for semantic highlighting ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements clang_getSemanticTokens(), which reports the tokens of
+// a file range that name declared entities. Rather than tokenizing the range
+// and finding the cursor of each token, as clang_annotateTokens() does, the
+// AST is walked once per parse to build a sorted index of these tokens, and
+// each query is a binary search in that index.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CLog.h"
+#include "CXTranslationUnit.h"
+#include "clang/AST/DeclObjC.h"
+#include "clang/AST/DeclTemplate.h"
+#include "clang/AST/ExprObjC.h"
+#include "clang/AST/RecursiveASTVisitor.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Lex/Lexer.h"
+#include "clang/Lex/PreprocessingRecord.h"
+#include "clang/Sema/CodeCompleteConsumer.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/Compiler.h"
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+using namespace clang;
+
+namespace {
+
+/// \brief The semantic tokens of a translation unit, sorted by offset in each
+/// file.
+typedef llvm::DenseMap<const FileEntry *, std::vector<CXSemanticToken> >
+    SemanticTokenIndex;
+
+/// \brief Collects the tokens that name declared entities in the AST.
+class SemanticTokenCollector
+    : public RecursiveASTVisitor<SemanticTokenCollector> {
+  typedef RecursiveASTVisitor<SemanticTokenCollector> base;
+
+  SourceManager &SM;
+  const LangOptions &LangOpts;
+  SemanticTokenIndex &Index;
+
+  /// \brief The file of the last token that was added, which is usually the
+  /// file of the next one.
+  FileID LastFID;
+  const FileEntry *LastFile;
+
+public:
+  SemanticTokenCollector(ASTUnit &Unit, SemanticTokenIndex &Index)
+    : SM(Unit.getSourceManager()), LangOpts(Unit.getLangOpts()),
+      Index(Index), LastFile(nullptr) { }
+
+  bool shouldVisitTemplateInstantiations() const { return false; }
+  bool shouldWalkTypesOfTypeLocs() const { return false; }
+
+  void addToken(SourceLocation Loc, CXCursorKind Kind, unsigned Flags);
+
+  void addDeclName(SourceLocation Loc, const NamedDecl *D, unsigned Flags) {
+    if (!D)
+      return;
+    // Only names that are spelled as a single identifier can be highlighted
+    // as a whole; operators, conversions and selectors are left out.
+    DeclarationName Name = D->getDeclName();
+    if (!Name.getAsIdentifierInfo() &&
+        Name.getNameKind() != DeclarationName::CXXConstructorName &&
+        Name.getNameKind() != DeclarationName::CXXDestructorName)
+      return;
+    addToken(Loc, getCursorKindForDecl(D), Flags);
+  }
+
+  bool VisitNamedDecl(NamedDecl *D) {
+    if (!D->isImplicit())
+      addDeclName(D->getLocation(), D, CXSemanticToken_Declaration);
+    return true;
+  }
+
+  bool VisitDeclRefExpr(DeclRefExpr *E) {
+    addDeclName(E->getLocation(), E->getDecl(), 0);
+    return true;
+  }
+
+  bool VisitMemberExpr(MemberExpr *E) {
+    addDeclName(E->getMemberLoc(), E->getMemberDecl(), 0);
+    return true;
+  }
+
+  bool VisitObjCIvarRefExpr(ObjCIvarRefExpr *E) {
+    addDeclName(E->getLocation(), E->getDecl(), 0);
+    return true;
+  }
+
+  bool VisitObjCPropertyRefExpr(ObjCPropertyRefExpr *E) {
+    if (E->isExplicitProperty())
+      addDeclName(E->getLocation(), E->getExplicitProperty(), 0);
+    return true;
+  }
+
+  bool VisitTypedefTypeLoc(TypedefTypeLoc TL) {
+    addDeclName(TL.getNameLoc(), TL.getTypedefNameDecl(), 0);
+    return true;
+  }
+
+  bool VisitTagTypeLoc(TagTypeLoc TL) {
+    addDeclName(TL.getNameLoc(), TL.getDecl(), 0);
+    return true;
+  }
+
+  bool VisitInjectedClassNameTypeLoc(InjectedClassNameTypeLoc TL) {
+    addDeclName(TL.getNameLoc(), TL.getDecl(), 0);
+    return true;
+  }
+
+  bool VisitTemplateTypeParmTypeLoc(TemplateTypeParmTypeLoc TL) {
+    addDeclName(TL.getNameLoc(), TL.getDecl(), 0);
+    return true;
+  }
+
+  bool VisitTemplateSpecializationTypeLoc(TemplateSpecializationTypeLoc TL) {
+    TemplateName Template = TL.getTypePtr()->getTemplateName();
+    addDeclName(TL.getTemplateNameLoc(), Template.getAsTemplateDecl(), 0);
+    return true;
+  }
+
+  bool VisitObjCInterfaceTypeLoc(ObjCInterfaceTypeLoc TL) {
+    addDeclName(TL.getNameLoc(), TL.getIFaceDecl(), 0);
+    return true;
+  }
+
+  bool TraverseNestedNameSpecifierLoc(NestedNameSpecifierLoc NNS) {
+    if (!NNS)
+      return true;
+    NestedNameSpecifier *Qualifier = NNS.getNestedNameSpecifier();
+    if (NamespaceDecl *NS = Qualifier->getAsNamespace())
+      addDeclName(NNS.getLocalBeginLoc(), NS, 0);
+    else if (NamespaceAliasDecl *Alias = Qualifier->getAsNamespaceAlias())
+      addDeclName(NNS.getLocalBeginLoc(), Alias, 0);
+    return base::TraverseNestedNameSpecifierLoc(NNS);
+  }
+};
+
+} // end anonymous namespace
+
+void SemanticTokenCollector::addToken(SourceLocation Loc, CXCursorKind Kind,
+                                      unsigned Flags) {
+  if (Loc.isInvalid())
+    return;
+
+  // A name that comes from a macro argument is highlighted where the argument
+  // is written; a name written in the macro body is not highlighted.
+  if (Loc.isMacroID()) {
+    if (!SM.isMacroArgExpansion(Loc))
+      return;
+    Loc = SM.getSpellingLoc(Loc);
+  }
+
+  std::pair<FileID, unsigned> LocInfo = SM.getDecomposedLoc(Loc);
+  if (LocInfo.first != LastFID) {
+    LastFID = LocInfo.first;
+    LastFile = SM.getFileEntryForID(LastFID);
+  }
+  if (!LastFile)
+    return;
+
+  unsigned Length = Lexer::MeasureTokenLength(Loc, SM, LangOpts);
+  if (!Length)
+    return;
+
+  CXSemanticToken Token = { LocInfo.second, Length, Kind, Flags };
+  Index[LastFile].push_back(Token);
+}
+
+static bool compareTokenOffsets(const CXSemanticToken &LHS,
+                                const CXSemanticToken &RHS) {
+  return LHS.offset < RHS.offset;
+}
+
+static SemanticTokenIndex *buildSemanticTokenIndex(ASTUnit &Unit) {
+  SemanticTokenIndex *Index = new SemanticTokenIndex();
+  SemanticTokenCollector Collector(Unit, *Index);
+
+  if (Unit.isMainFileAST()) {
+    Collector.TraverseDecl(Unit.getASTContext().getTranslationUnitDecl());
+  } else {
+    for (ASTUnit::top_level_iterator I = Unit.top_level_begin(),
+                                     E = Unit.top_level_end();
+         I != E; ++I)
+      Collector.TraverseDecl(*I);
+  }
+
+  if (PreprocessingRecord *PPRec = Unit.getPreprocessor()
+                                       .getPreprocessingRecord()) {
+    for (PreprocessingRecord::iterator I = PPRec->local_begin(),
+                                       E = PPRec->local_end();
+         I != E; ++I) {
+      if (MacroExpansion *ME = dyn_cast<MacroExpansion>(*I))
+        Collector.addToken(ME->getSourceRange().getBegin(),
+                           CXCursor_MacroDefinition, 0);
+      else if (MacroDefinitionRecord *MD = dyn_cast<MacroDefinitionRecord>(*I))
+        Collector.addToken(MD->getLocation(), CXCursor_MacroDefinition,
+                           CXSemanticToken_Declaration);
+    }
+  }
+
+  // Sort the tokens of each file, keeping a single token per offset. A name
+  // can be visited more than once, e.g., as the name of a declaration and as
+  // a reference to it in an implicit expression; the declaration wins.
+  for (SemanticTokenIndex::iterator I = Index->begin(), E = Index->end();
+       I != E; ++I) {
+    std::vector<CXSemanticToken> &Tokens = I->second;
+    std::stable_sort(Tokens.begin(), Tokens.end(), compareTokenOffsets);
+    std::vector<CXSemanticToken>::iterator Out = Tokens.begin();
+    for (std::vector<CXSemanticToken>::iterator T = Tokens.begin(),
+                                                TEnd = Tokens.end();
+         T != TEnd; ++T) {
+      if (Out != Tokens.begin() && (Out - 1)->offset == T->offset) {
+        if (T->flags & CXSemanticToken_Declaration)
+          *(Out - 1) = *T;
+        continue;
+      }
+      *Out++ = *T;
+    }
+    Tokens.erase(Out, Tokens.end());
+  }
+
+  return Index;
+}
+
+void cxtu::disposeSemanticTokens(CXTranslationUnit TU) {
+  delete static_cast<SemanticTokenIndex *>(TU->SemanticTokens);
+  TU->SemanticTokens = nullptr;
+}
+
+extern "C" {
+
+enum CXErrorCode clang_getSemanticTokens(CXTranslationUnit TU, CXFile File,
+                                         unsigned BeginOffset,
+                                         unsigned EndOffset,
+                                         CXSemanticToken **Tokens,
+                                         unsigned *NumTokens) {
+  LOG_FUNC_SECTION {
+    *Log << TU << ' ' << static_cast<const FileEntry *>(File) << " ["
+         << BeginOffset << ", " << EndOffset << ')';
+  }
+
+  if (Tokens)
+    *Tokens = nullptr;
+  if (NumTokens)
+    *NumTokens = 0;
+
+  if (cxtu::isNotUsableTU(TU)) {
+    LOG_BAD_TU(TU);
+    return CXError_InvalidArguments;
+  }
+
+  ASTUnit *CXXUnit = cxtu::getASTUnit(TU);
+  if (!CXXUnit || !File || !Tokens || !NumTokens || BeginOffset > EndOffset)
+    return CXError_InvalidArguments;
+
+  ASTUnit::ConcurrencyCheck Check(*CXXUnit);
+
+  if (!TU->SemanticTokens)
+    TU->SemanticTokens = buildSemanticTokenIndex(*CXXUnit);
+  SemanticTokenIndex &Index =
+      *static_cast<SemanticTokenIndex *>(TU->SemanticTokens);
+
+  SemanticTokenIndex::iterator Known =
+      Index.find(static_cast<const FileEntry *>(File));
+  if (Known == Index.end())
+    return CXError_Success;
+
+  CXSemanticToken Begin = { BeginOffset, 0, CXCursor_MacroDefinition, 0 };
+  CXSemanticToken End = { EndOffset, 0, CXCursor_MacroDefinition, 0 };
+  std::vector<CXSemanticToken> &FileTokens = Known->second;
+  std::vector<CXSemanticToken>::iterator
+      First = std::lower_bound(FileTokens.begin(), FileTokens.end(), Begin,
+                               compareTokenOffsets),
+      Last = std::lower_bound(First, FileTokens.end(), End,
+                              compareTokenOffsets);
+  if (First == Last)
+    return CXError_Success;
+
+  unsigned Count = Last - First;
+  CXSemanticToken *Result =
+      static_cast<CXSemanticToken *>(malloc(sizeof(CXSemanticToken) * Count));
+  std::copy(First, Last, Result);
+  *Tokens = Result;
+  *NumTokens = Count;
+  return CXError_Success;
+}
+
+void clang_disposeSemanticTokens(CXSemanticToken *Tokens) {
+  free(Tokens);
+}
+
+} // end extern "C"
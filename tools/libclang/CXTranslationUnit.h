@@ -33,6 +33,9 @@ struct CXTranslationUnitImpl {
   void *Diagnostics;
   void *OverridenCursorsPool;
   clang::index::CommentToXMLConverter *CommentToXML;
+  void *SemanticTokens;
+  void *CursorIndex;
+  bool CommentsAttached;
 };
 
 namespace clang {
@@ -46,6 +49,18 @@ static inline ASTUnit *getASTUnit(CXTranslationUnit TU) {
   return TU->TheASTUnit;
 }
 
+/// \brief Discard the semantic tokens computed for the translation unit, if
+/// any, e.g., because it was reparsed.
+void disposeSemanticTokens(CXTranslationUnit TU);
+
+/// \brief Discard the index that clang_getCursor() built to find the cursors
+/// of the translation unit, if any, e.g., because it was reparsed.
+void disposeCursorIndex(CXTranslationUnit TU);
+
+/// \brief Attach the documentation comments of the translation unit to its
+/// declarations in one pass, unless that was done since it was last parsed.
+void attachCommentsToDecls(CXTranslationUnit TU);
+
 /// \returns true if the ASTUnit has a diagnostic about the AST file being
 /// corrupted.
 bool isASTReadError(ASTUnit *AU);
@@ -14,9 +14,11 @@
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/ExternalASTSource.h"
+#include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/CompilerInvocation.h"
 #include "clang/Frontend/FrontendActions.h"
+#include "clang/Tooling/Tooling.h"
 #include "gtest/gtest.h"
 
 using namespace clang;
@@ -81,3 +83,68 @@ TEST(ExternalASTSourceTest, FailedLookupOccursOnce) {
   ASSERT_TRUE(testExternalASTSource(new TestSource(Calls), "int j, k = j;"));
   EXPECT_EQ(1u, Calls);
 }
+
+// Ensure that lexical declarations loaded after the lookup table of the
+// translation unit was built are added to it without rebuilding it.
+TEST(ExternalASTSourceTest, LexicalDeclsUpdateLookupTable) {
+  struct TestSource : ExternalASTSource {
+    ExternalLoadResult
+    FindExternalLexicalDecls(const DeclContext *DC,
+                             bool (*isKindWeWant)(Decl::Kind),
+                             SmallVectorImpl<Decl *> &Result) override {
+      Result.append(Pending.begin(), Pending.end());
+      Pending.clear();
+      return ELR_Success;
+    }
+
+    SmallVector<Decl *, 4> Pending;
+  };
+
+  std::unique_ptr<ASTUnit> AST =
+      tooling::buildASTFromCode("int local;", "input.c");
+  ASSERT_TRUE(AST.get());
+  ASTContext &Ctx = AST->getASTContext();
+  TranslationUnitDecl *TU = Ctx.getTranslationUnitDecl();
+
+  TestSource *Source = new TestSource;
+  Ctx.setExternalSource(Source);
+
+  auto LoadVar = [&](StringRef Name) {
+    VarDecl *VD = VarDecl::Create(Ctx, TU, SourceLocation(), SourceLocation(),
+                                  &Ctx.Idents.get(Name), Ctx.IntTy, nullptr,
+                                  SC_None);
+    Source->Pending.push_back(VD);
+    return VD;
+  };
+  auto Lookup = [&](StringRef Name) {
+    return TU->lookup(DeclarationName(&Ctx.Idents.get(Name)));
+  };
+
+  VarDecl *A = LoadVar("a");
+  TU->setHasExternalLexicalStorage(true);
+  TU->setMustBuildLookupTable();
+
+  unsigned Builds = ASTContext::NumLookupTableBuilds;
+  unsigned Updates = ASTContext::NumLookupTableUpdates;
+  ASSERT_EQ(1u, Lookup("a").size());
+  EXPECT_EQ(A, Lookup("a").front());
+  EXPECT_EQ(1u, Lookup("local").size());
+  EXPECT_EQ(Builds + 1, ASTContext::NumLookupTableBuilds);
+  EXPECT_EQ(Updates, ASTContext::NumLookupTableUpdates);
+
+  VarDecl *B = LoadVar("b");
+  VarDecl *C = LoadVar("c");
+  TU->setHasExternalLexicalStorage(true);
+  TU->setMustBuildLookupTable();
+
+  unsigned Walked = ASTContext::NumLookupTableDeclsWalked;
+  ASSERT_EQ(1u, Lookup("b").size());
+  EXPECT_EQ(B, Lookup("b").front());
+  ASSERT_EQ(1u, Lookup("c").size());
+  EXPECT_EQ(C, Lookup("c").front());
+  EXPECT_EQ(A, Lookup("a").front());
+  EXPECT_EQ(1u, Lookup("local").size());
+  EXPECT_EQ(Builds + 1, ASTContext::NumLookupTableBuilds);
+  EXPECT_EQ(Updates + 1, ASTContext::NumLookupTableUpdates);
+  EXPECT_EQ(Walked + 2, ASTContext::NumLookupTableDeclsWalked);
+}
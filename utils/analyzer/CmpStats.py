@@ -0,0 +1,175 @@
+#!/usr/bin/env python
+
+"""
+CmpStats - A tool for comparing the performance of two static analyzer runs.
+
+The analyzer writes one JSON file per translation unit when it is run with
+'-analyzer-config function-stats-dir=<dir>'. Each file lists the functions
+analyzed path-sensitively, with the number of steps taken by the engine, the
+basic blocks covered, whether the node budget was exhausted, and the time and
+memory used. This tool aggregates the files of two runs and reports the
+differences, so that changes to ExprEngine, the store or the constraint
+manager can be measured on real code bases.
+
+Usage:
+
+    # Summarize the statistics of both runs and compare them.
+    statsA = loadStats(dirA, rootA)
+    statsB = loadStats(dirB, rootB)
+    dumpStatsDiff(statsA, statsB, sys.stdout)
+
+"""
+
+import os
+import sys
+import json
+
+class FunctionStats:
+    def __init__(self, key, data):
+        self.key = key
+        self.steps = data['steps']
+        self.blocks = data['blocks']
+        self.visitedBlocks = data['visited-blocks']
+        self.reachedMaxSteps = data['max-steps-reached']
+        self.blocksExhausted = data['blocks-exhausted']
+        self.wall = data['wall']
+        self.user = data['user']
+        self.memory = data['memory']
+
+class RunStats:
+    def __init__(self):
+        self.functions = {}
+        self.numFunctions = 0
+        self.steps = 0
+        self.blocks = 0
+        self.visitedBlocks = 0
+        self.reachedMaxSteps = 0
+        self.blocksExhausted = 0
+        self.wall = 0.0
+        self.user = 0.0
+        self.maxMemory = 0
+
+    def add(self, stats):
+        # A function may be analyzed more than once (for example, in both
+        # inlining modes); keep the numbers of each analysis.
+        self.functions.setdefault(stats.key, []).append(stats)
+        self.numFunctions += 1
+        self.steps += stats.steps
+        self.blocks += stats.blocks
+        self.visitedBlocks += stats.visitedBlocks
+        self.reachedMaxSteps += stats.reachedMaxSteps
+        self.blocksExhausted += stats.blocksExhausted
+        self.wall += stats.wall
+        self.user += stats.user
+        self.maxMemory = max(self.maxMemory, stats.memory)
+
+    def stepsPerSecond(self):
+        if self.user == 0:
+            return 0.0
+        return self.steps / self.user
+
+    def coverage(self):
+        if self.blocks == 0:
+            return 0.0
+        return 100.0 * self.visitedBlocks / self.blocks
+
+    def budgetExhaustionRate(self):
+        if self.numFunctions == 0:
+            return 0.0
+        return 100.0 * self.reachedMaxSteps / self.numFunctions
+
+def stripRoot(path, root):
+    if root and path.startswith(root):
+        return path[len(root):].lstrip(os.sep)
+    return path
+
+# Load all the statistics files found (recursively) under the given directory.
+def loadStats(path, root = ""):
+    run = RunStats()
+    for (dirpath, dirnames, filenames) in os.walk(path):
+        for f in filenames:
+            if not (f.startswith('stats-') and f.endswith('.json')):
+                continue
+            data = json.load(open(os.path.join(dirpath, f)))
+            for function in data['functions']:
+                key = (stripRoot(function['location'], root),
+                       function['name'], function['mode'])
+                run.add(FunctionStats(key, function))
+    return run
+
+def relativeChange(old, new):
+    if old == 0:
+        return "n/a"
+    return "%+.1f%%" % (100.0 * (new - old) / old)
+
+# Print a summary of both runs and the functions whose analysis time grew
+# the most. Returns the relative change in total user time.
+def dumpStatsDiff(statsA, statsB, out, numFunctions = 10):
+    rows = [
+        ("functions analyzed", statsA.numFunctions, statsB.numFunctions),
+        ("steps", statsA.steps, statsB.steps),
+        ("user time (s)", statsA.user, statsB.user),
+        ("wall time (s)", statsA.wall, statsB.wall),
+        ("steps per second", statsA.stepsPerSecond(), statsB.stepsPerSecond()),
+        ("block coverage (%)", statsA.coverage(), statsB.coverage()),
+        ("max steps reached (%)", statsA.budgetExhaustionRate(),
+                                  statsB.budgetExhaustionRate()),
+        ("blocks exhausted", statsA.blocksExhausted, statsB.blocksExhausted),
+        ("max memory (bytes)", statsA.maxMemory, statsB.maxMemory),
+    ]
+    print >>out, "%-24s %16s %16s %10s" % ("", "reference", "new", "change")
+    for (name, a, b) in rows:
+        print >>out, "%-24s %16s %16s %10s" % (name, round(a, 3), round(b, 3),
+                                               relativeChange(a, b))
+
+    # Match the functions by location and name; functions that only appear in
+    # one of the runs do not contribute to the per-function comparison.
+    changes = []
+    for key, listA in statsA.functions.items():
+        listB = statsB.functions.get(key)
+        if listB is None:
+            continue
+        timeA = sum(s.user for s in listA)
+        timeB = sum(s.user for s in listB)
+        stepsA = sum(s.steps for s in listA)
+        stepsB = sum(s.steps for s in listB)
+        changes.append((timeB - timeA, key, timeA, timeB, stepsA, stepsB))
+    changes.sort(reverse=True)
+
+    if changes and numFunctions > 0:
+        print >>out
+        print >>out, "Largest increases in analysis time:"
+        for (delta, key, timeA, timeB, stepsA, stepsB) in \
+                changes[:numFunctions]:
+            print >>out, "  %s (%s): %.3fs -> %.3fs, %d -> %d steps" % \
+                (key[1], key[0], timeA, timeB, stepsA, stepsB)
+
+    if statsA.user == 0:
+        return 0.0
+    return (statsB.user - statsA.user) / statsA.user
+
+def main():
+    from optparse import OptionParser
+    parser = OptionParser("usage: %prog [options] [dir A] [dir B]")
+    parser.add_option("", "--rootA", dest="rootA",
+                      help="Prefix to ignore on source files for directory A",
+                      action="store", type=str, default="")
+    parser.add_option("", "--rootB", dest="rootB",
+                      help="Prefix to ignore on source files for directory B",
+                      action="store", type=str, default="")
+    parser.add_option("-n", "", dest="numFunctions",
+                      help="Number of functions with the largest time " \
+                           "changes to list [default=10]",
+                      action="store", type=int, default=10)
+    (opts, args) = parser.parse_args()
+
+    if len(args) != 2:
+        parser.error("invalid number of arguments")
+
+    dirA,dirB = args
+
+    dumpStatsDiff(loadStats(dirA, opts.rootA), loadStats(dirB, opts.rootB),
+                  sys.stdout, opts.numFunctions)
+
+if __name__ == '__main__':
+    main()
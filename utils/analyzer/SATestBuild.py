@@ -38,6 +38,7 @@ For more logging, set the  env variables:
    zaks:TI zaks$ export CCC_ANALYZER_VERBOSE=1
 """
 import CmpRuns
+import CmpStats
 
 import os
 import csv
@@ -164,6 +165,10 @@ NumOfFailuresInSummary = 10
 FailuresSummaryFileName = "failures.txt"
 # Summary of the result diffs.
 DiffsSummaryFileName = "diffs.txt"
+# The per-function performance statistics written by the analyzer, and the
+# summary of their differences.
+StatsFolderName = "Stats"
+StatsDiffsFileName = "stats-diffs.txt"
 
 # The scan-build result directory.
 SBOutputDirName = "ScanBuildResults"
@@ -210,6 +215,8 @@ def runScanBuild(Dir, SBOutputDir, PBuildLogFile):
     SBOptions += "-plist-html -o " + SBOutputDir + " "
     SBOptions += "-enable-checker " + Checkers + " "  
     SBOptions += "--keep-empty "
+    SBOptions += "-analyzer-config function-stats-dir=" + \
+                 os.path.join(SBOutputDir, StatsFolderName) + " "
     # Always use ccc-analyze to ensure that we can locate the failures 
     # directory.
     SBOptions += "--override-compiler "
@@ -263,6 +270,8 @@ def runAnalyzePreprocessed(Dir, SBOutputDir, Mode):
     
     if (Mode == 2) :
         CmdPrefix += "-std=c++11 " 
+    CmdPrefix += "-analyzer-config function-stats-dir=" + \
+                 os.path.join(SBOutputDir, StatsFolderName) + " "
     
     PlistPath = os.path.join(Dir, SBOutputDir, "date")
     FailPath = os.path.join(PlistPath, "failures");
@@ -323,6 +332,7 @@ def buildProject(Dir, SBOutputDir, ProjectBuildMode, IsReferenceBuild):
             check_call(RmCommand, shell=True)
     assert(not os.path.exists(SBOutputDir))
     os.makedirs(os.path.join(SBOutputDir, LogFolderName))
+    os.makedirs(os.path.join(SBOutputDir, StatsFolderName))
         
     # Open the log file.
     PBuildLogFile = open(BuildLogPath, "wb+")
@@ -419,6 +429,19 @@ class Discarder(object):
     def write(self, text):
         pass # do nothing
 
+# Compare the performance statistics of the reference and the new run and
+# write the summary of the differences to DiffsPath.
+def runCmpStats(Dir, RefStatsDir, NewStatsDir, DiffsPath):
+    RefStats = CmpStats.loadStats(RefStatsDir, Dir)
+    NewStats = CmpStats.loadStats(NewStatsDir, Dir)
+    DiffsFile = open(DiffsPath, "w+")
+    try:
+        TimeChange = CmpStats.dumpStatsDiff(RefStats, NewStats, DiffsFile)
+    finally:
+        DiffsFile.close()
+    print "Analysis time changed by %+.1f%% (%d steps -> %d steps). See %s" % \
+          (100.0 * TimeChange, RefStats.steps, NewStats.steps, DiffsPath)
+
 # Compare the warnings produced by scan-build.
 # Strictness defines the success criteria for the test:
 #   0 - success if there are no crashes or analyzer failure.
@@ -439,6 +462,17 @@ def runCmpResults(Dir, Strictness = 0):
     if RefLogDir in RefList:
         RefList.remove(RefLogDir)
     NewList.remove(os.path.join(NewDir, LogFolderName))
+    # Compare the performance statistics; older reference results might not
+    # have them.
+    RefStatsDir = os.path.join(RefDir, StatsFolderName)
+    NewStatsDir = os.path.join(NewDir, StatsFolderName)
+    if RefStatsDir in RefList:
+        RefList.remove(RefStatsDir)
+    if NewStatsDir in NewList:
+        NewList.remove(NewStatsDir)
+        if os.path.exists(RefStatsDir):
+            runCmpStats(Dir, RefStatsDir, NewStatsDir,
+                        os.path.join(NewDir, LogFolderName, StatsDiffsFileName))
     
     if len(RefList) == 0 or len(NewList) == 0:
         return False
@@ -0,0 +1,77 @@
+#!/usr/bin/env python
+
+"""
+clang-perf-compare - Compare two JSON reports produced by clang-perf.
+
+For every benchmark and phase present in both reports, prints the wall time
+and memory of each run and the relative change.  Phases whose wall time
+changed by more than the threshold are flagged, and the exit status is
+non-zero if any of them got slower, so the script can gate a buildbot.
+
+Usage:
+
+    clang-perf -o before.json INPUTS/*.c INPUTS/*.cpp
+    ... rebuild ...
+    clang-perf -o after.json INPUTS/*.c INPUTS/*.cpp
+    clang-perf-compare.py before.json after.json
+"""
+
+import json
+import sys
+from optparse import OptionParser
+
+def loadReport(path):
+    with open(path) as f:
+        report = json.load(f)
+    results = {}
+    for benchmark in report['benchmarks']:
+        for phase, data in benchmark['phases'].items():
+            results[(benchmark['name'], phase)] = data
+    return results
+
+def relativeChange(old, new):
+    if old == 0:
+        return 0.0
+    return (new - old) / float(old)
+
+def main():
+    parser = OptionParser("usage: %prog [options] <before.json> <after.json>")
+    parser.add_option("--threshold", dest="threshold", type="float",
+                      default=0.05,
+                      help="Relative wall time change to flag [default=%default]")
+    (opts, args) = parser.parse_args()
+    if len(args) != 2:
+        parser.error("invalid number of arguments")
+
+    before = loadReport(args[0])
+    after = loadReport(args[1])
+
+    regressions = 0
+    print "%-36s %-11s %10s %10s %8s %12s %12s %8s" % (
+        "benchmark", "phase", "wall(A)", "wall(B)", "delta",
+        "mem(A)", "mem(B)", "delta")
+    for key in sorted(set(before) & set(after)):
+        a = before[key]
+        b = after[key]
+        wallDelta = relativeChange(a['wall'], b['wall'])
+        memDelta = relativeChange(a['memory'], b['memory'])
+        flag = ""
+        if not a['success'] or not b['success']:
+            flag = "  (failed)"
+        elif wallDelta > opts.threshold:
+            flag = "  SLOWER"
+            regressions += 1
+        elif wallDelta < -opts.threshold:
+            flag = "  faster"
+        print "%-36s %-11s %10.4f %10.4f %+7.1f%% %12d %12d %+7.1f%%%s" % (
+            key[0], key[1], a['wall'], b['wall'], wallDelta * 100,
+            a['memory'], b['memory'], memDelta * 100, flag)
+
+    for key in sorted(set(before) ^ set(after)):
+        print "%-36s %-11s only in %s" % (
+            key[0], key[1], "A" if key in before else "B")
+
+    return 1 if regressions else 0
+
+if __name__ == '__main__':
+    sys.exit(main())